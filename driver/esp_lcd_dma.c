@@ -0,0 +1,268 @@
+/**
+ * @file esp_lcd_dma.c
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display DMA parallel bus source file
+ * @version 0.1
+ * @date 2022-08-15
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include "esp_idf_version.h"
+#include "esp_lcd.h"
+#include "esp_log.h"
+#include "soc/soc_caps.h"
+
+/* LCD tag */
+static const char *lcd_tag = "LCD tag"; /*! < LCD tag */
+
+#if SOC_LCD_I80_SUPPORTED && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_lcd_panel_io.h"
+
+#define LCD_DMA_SLEEP_US 1000 /*!< Waits of this length sleep instead of padding */
+
+/******************************************************************
+ * \struct lcd_dma_ctx_t esp_lcd_dma.c
+ * \brief DMA bus backend context
+ *******************************************************************/
+typedef struct
+{
+    esp_lcd_i80_bus_handle_t i80;   /*!< I80 bus */
+    esp_lcd_panel_io_handle_t io;   /*!< I80 panel IO */
+    SemaphoreHandle_t done;         /*!< Given when a transfer completes */
+    StaticSemaphore_t doneBuffer;   /*!< Semaphore storage */
+    lcd_wave_t wave;                /*!< Waveform shape */
+    uint32_t sampleNs;              /*!< Sample period */
+    uint8_t *buf;                   /*!< Waveform buffer, DMA capable */
+    size_t size;                    /*!< Waveform buffer size */
+    size_t len;                     /*!< Encoded samples */
+    bool busy;                      /*!< Transfer in flight */
+} lcd_dma_ctx_t;
+
+/**
+ * @brief Transfer done callback
+ *
+ * @param io        panel IO
+ * @param edata     event data
+ * @param ctx       DMA backend context
+ * @return          true if a higher priority task was woken
+ */
+static bool lcdDmaDone(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *ctx)
+{
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(((lcd_dma_ctx_t *)ctx)->done, &woken);
+    return woken == pdTRUE;
+}
+
+/**
+ * @brief Wait for the transfer in flight and reclaim the buffer
+ *
+ * @param ctx   DMA backend context
+ * @return None
+ */
+static void lcdDmaSync(lcd_dma_ctx_t *ctx)
+{
+    if (ctx->busy)
+    {
+        xSemaphoreTake(ctx->done, portMAX_DELAY);
+        ctx->busy = false;
+        ctx->len = 0;
+    }
+}
+
+/**
+ * @brief DMA bus, start transfer of the encoded waveform
+ *
+ * Returns as soon as the transfer is queued, the CPU is free while
+ * the peripheral clocks the samples out.
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdDmaFlush(lcd_t *const lcd)
+{
+    lcd_dma_ctx_t *ctx = (lcd_dma_ctx_t *)lcd->busHandle;
+    if (ctx->busy || ctx->len == 0)
+    {
+        return;
+    }
+    if (esp_lcd_panel_io_tx_color(ctx->io, -1, ctx->buf, ctx->len) == ESP_OK)
+    {
+        ctx->busy = true;
+    }
+    else
+    {
+        ctx->len = 0;
+    }
+}
+
+/**
+ * @brief DMA bus, encode nibble into the waveform buffer
+ *
+ * @param lcd   pointer to LCD object
+ * @param lines D4 - D7 and RS @see LCD_LINE_RS
+ * @param us    wait after the strobe in microseconds
+ * @return None
+ */
+static void lcdDmaWrite(lcd_t *const lcd, uint8_t lines, uint32_t us)
+{
+    lcd_dma_ctx_t *ctx = (lcd_dma_ctx_t *)lcd->busHandle;
+    uint32_t wait = (us * 1000 + ctx->sampleNs - 1) / ctx->sampleNs;
+    bool sleep = us >= LCD_DMA_SLEEP_US;
+    size_t n;
+
+    /* Pulse from the current timing */
+    ctx->wave.pulse = (lcd->timing.pulseNs + ctx->sampleNs - 1) / ctx->sampleNs;
+    ctx->wave.hold = ctx->wave.pulse;
+    wait = (sleep || wait < ctx->wave.hold) ? 0 : wait - ctx->wave.hold;
+
+    /* Buffer is owned by DMA until the transfer is done */
+    lcdDmaSync(ctx);
+    n = lcdWaveEncode(&ctx->wave, lines | LCD_LINE_BL, wait, ctx->buf + ctx->len, ctx->size - ctx->len);
+    if (n == 0)
+    {
+        /* Buffer full, send it and start over */
+        lcdDmaFlush(lcd);
+        lcdDmaSync(ctx);
+        n = lcdWaveEncode(&ctx->wave, lines | LCD_LINE_BL, wait, ctx->buf, ctx->size);
+    }
+    ctx->len += n;
+
+    /* Long waits sleep once the samples are out */
+    if (sleep)
+    {
+        lcdDmaFlush(lcd);
+        lcdDmaSync(ctx);
+        lcdBusWait(lcd, us);
+    }
+}
+
+/**
+ * @brief DMA bus, delete panel IO and bus
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdDmaRelease(lcd_t *const lcd)
+{
+    lcd_dma_ctx_t *ctx = (lcd_dma_ctx_t *)lcd->busHandle;
+    lcdDmaSync(ctx);
+    esp_lcd_panel_io_del(ctx->io);
+    esp_lcd_del_i80_bus(ctx->i80);
+    vSemaphoreDelete(ctx->done);
+    heap_caps_free(ctx->buf);
+    free(ctx);
+    lcd->busHandle = NULL;
+}
+
+/* DMA bus, waveforms clocked out by the I80 (I2S or LCD_CAM) peripheral */
+static const lcd_bus_t lcd_bus_dma = {
+    .write = lcdDmaWrite,
+    .read = NULL,
+    .flush = lcdDmaFlush,
+    .release = lcdDmaRelease,
+};
+
+/**
+ * @brief LCD constructor for the DMA parallel bus
+ *
+ * D4 - D7, RS, RW, EN and BL are driven as the 8 data lines of the I80
+ * bus in bus line order @see LCD_LINE_RS. A whole screen update is
+ * encoded into one waveform and sent by DMA. WR and DC are required by
+ * the peripheral but are not connected to the LCD.
+ * @param lcd       pointer to LCD object
+ * @param config    DMA bus configuration @see lcd_dma_config_t
+ * @note  The LCD cannot be read back on this bus.
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdCtorDMA(lcd_t *lcd, const lcd_dma_config_t *config)
+{
+    lcd_dma_ctx_t *ctx = calloc(1, sizeof(lcd_dma_ctx_t));
+    int i;
+
+    if (ctx == NULL)
+    {
+        return LCD_FAIL;
+    }
+
+    ctx->size = config->bufSize;
+    ctx->sampleNs = 1000000000UL / config->clockHz;
+    ctx->buf = heap_caps_malloc(ctx->size, MALLOC_CAP_DMA);
+    ctx->done = xSemaphoreCreateBinaryStatic(&ctx->doneBuffer);
+
+    /* Bus line i is I80 data line i */
+    for (i = 0; i < 8; i++)
+    {
+        ctx->wave.map[i] = i;
+    }
+    ctx->wave.setup = 1;
+
+    esp_lcd_i80_bus_config_t bus_config = {
+        .dc_gpio_num = config->dc,
+        .wr_gpio_num = config->wr,
+        .clk_src = LCD_CLK_SRC_DEFAULT,
+        .data_gpio_nums = {
+            config->data[0], config->data[1], config->data[2], config->data[3],
+            config->regSel, config->rw, config->en, config->bl,
+        },
+        .bus_width = 8,
+        .max_transfer_bytes = config->bufSize,
+    };
+    esp_lcd_panel_io_i80_config_t io_config = {
+        .cs_gpio_num = -1,
+        .pclk_hz = config->clockHz,
+        .trans_queue_depth = 1,
+        .on_color_trans_done = lcdDmaDone,
+        .user_ctx = ctx,
+        .lcd_cmd_bits = 8,
+        .lcd_param_bits = 8,
+    };
+
+    if (ctx->buf == NULL ||
+        esp_lcd_new_i80_bus(&bus_config, &ctx->i80) != ESP_OK ||
+        esp_lcd_new_panel_io_i80(ctx->i80, &io_config, &ctx->io) != ESP_OK)
+    {
+        ESP_LOGE(lcd_tag, "LCD DMA bus setup failed\n");
+        if (ctx->i80 != NULL)
+        {
+            esp_lcd_del_i80_bus(ctx->i80);
+        }
+        vSemaphoreDelete(ctx->done);
+        heap_caps_free(ctx->buf);
+        free(ctx);
+        return LCD_FAIL;
+    }
+
+    /* Attach bus backend */
+    lcdCtorBus(lcd, &lcd_bus_dma, ctx, false);
+    /* Pins narrow to lcd_pin_t, copy them one by one */
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+        lcd->data[i] = config->data[i];
+    }
+    lcd->en = config->en;
+    lcd->regSel = config->regSel;
+    return LCD_OK;
+}
+
+#else
+
+/**
+ * @brief LCD constructor for the DMA parallel bus
+ *
+ * @param lcd       pointer to LCD object
+ * @param config    DMA bus configuration @see lcd_dma_config_t
+ * @note  Needs an I80 capable target and ESP-IDF v5.1 or later.
+ * @return          LCD_FAIL
+ */
+lcd_err_t lcdCtorDMA(lcd_t *lcd, const lcd_dma_config_t *config)
+{
+    ESP_LOGE(lcd_tag, "LCD DMA bus is not supported\n");
+    return LCD_FAIL;
+}
+
+#endif
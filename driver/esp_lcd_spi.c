@@ -0,0 +1,216 @@
+/**
+ * @file esp_lcd_spi.c
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display SPI shift register bus source file
+ * @version 0.1
+ * @date 2022-08-15
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_idf_version.h"
+#include "esp_lcd.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/spi_master.h"
+
+#define LCD_SPI_QUEUE       64      /*!< Register states per flush */
+#define LCD_SPI_SLEEP_US    1000    /*!< Waits of this length sleep instead of padding */
+#define LCD_SPI_LATCH_NS    2000    /*!< Per transaction overhead, latch and interrupt */
+
+/* LCD tag */
+static const char *lcd_tag = "LCD tag"; /*! < LCD tag */
+
+/******************************************************************
+ * \struct lcd_spi_ctx_t esp_lcd_spi.c
+ * \brief SPI bus backend context
+ *******************************************************************/
+typedef struct
+{
+    spi_host_device_t host;                 /*!< SPI host */
+    spi_device_handle_t dev;                /*!< Shift register device */
+    lcd_wave_t wave;                        /*!< Register pin mapping */
+    uint32_t stateNs;                       /*!< Time to latch one register state */
+    uint8_t buf[LCD_SPI_QUEUE];             /*!< Register states */
+    spi_transaction_t trans[LCD_SPI_QUEUE]; /*!< One transaction per state */
+    size_t len;                             /*!< Encoded states */
+    size_t queued;                          /*!< Transactions in flight */
+    uint8_t rs;                             /*!< RS of the last write */
+} lcd_spi_ctx_t;
+
+/**
+ * @brief Wait for the transactions in flight
+ *
+ * @param ctx   SPI backend context
+ * @return None
+ */
+static void lcdSpiSync(lcd_spi_ctx_t *ctx)
+{
+    spi_transaction_t *done;
+    for (; ctx->queued > 0; ctx->queued--)
+    {
+        spi_device_get_trans_result(ctx->dev, &done, portMAX_DELAY);
+    }
+}
+
+/**
+ * @brief SPI bus, queue register states
+ *
+ * The register only updates its outputs when the latch rises, so each
+ * state is its own transaction with CS as the latch. All of them are
+ * queued at once and the driver chains them from its interrupt.
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdSpiFlush(lcd_t *const lcd)
+{
+    lcd_spi_ctx_t *ctx = (lcd_spi_ctx_t *)lcd->busHandle;
+    size_t i;
+
+    if (ctx->queued > 0 || ctx->len == 0)
+    {
+        return;
+    }
+    for (i = 0; i < ctx->len; i++)
+    {
+        ctx->trans[i].flags = SPI_TRANS_USE_TXDATA;
+        ctx->trans[i].length = 8;
+        ctx->trans[i].tx_data[0] = ctx->buf[i];
+        if (spi_device_queue_trans(ctx->dev, &ctx->trans[i], portMAX_DELAY) != ESP_OK)
+        {
+            ESP_LOGE(lcd_tag, "LCD SPI write failed\n");
+            break;
+        }
+        ctx->queued++;
+    }
+    ctx->len = 0;
+}
+
+/**
+ * @brief SPI bus, encode nibble as register states
+ *
+ * @param lcd   pointer to LCD object
+ * @param lines D4 - D7 and RS @see LCD_LINE_RS
+ * @param us    wait after the strobe in microseconds
+ * @return None
+ */
+static void lcdSpiWrite(lcd_t *const lcd, uint8_t lines, uint32_t us)
+{
+    lcd_spi_ctx_t *ctx = (lcd_spi_ctx_t *)lcd->busHandle;
+    bool sleep = us >= LCD_SPI_SLEEP_US;
+    uint32_t wait = (us * 1000 + ctx->stateNs - 1) / ctx->stateNs;
+    size_t n;
+
+    /* RS setup time before EN */
+    ctx->wave.setup = (lines & LCD_LINE_RS) != ctx->rs;
+    ctx->rs = lines & LCD_LINE_RS;
+    wait = (sleep || wait <= 1) ? 0 : wait - 1;
+
+    /* States are owned by the driver until the transactions are done */
+    lcdSpiSync(ctx);
+    n = lcdWaveEncode(&ctx->wave, lines | LCD_LINE_BL, wait, ctx->buf + ctx->len, sizeof(ctx->buf) - ctx->len);
+    if (n == 0)
+    {
+        lcdSpiFlush(lcd);
+        lcdSpiSync(ctx);
+        n = lcdWaveEncode(&ctx->wave, lines | LCD_LINE_BL, wait, ctx->buf, sizeof(ctx->buf));
+    }
+    ctx->len += n;
+
+    if (sleep)
+    {
+        lcdSpiFlush(lcd);
+        lcdSpiSync(ctx);
+        lcdBusWait(lcd, us);
+    }
+}
+
+/**
+ * @brief SPI bus, release device and bus
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdSpiRelease(lcd_t *const lcd)
+{
+    lcd_spi_ctx_t *ctx = (lcd_spi_ctx_t *)lcd->busHandle;
+    lcdSpiFlush(lcd);
+    lcdSpiSync(ctx);
+    spi_bus_remove_device(ctx->dev);
+    spi_bus_free(ctx->host);
+    free(ctx);
+    lcd->busHandle = NULL;
+}
+
+/* SPI bus, 74HC595 shift register */
+static const lcd_bus_t lcd_bus_spi = {
+    .write = lcdSpiWrite,
+    .read = NULL,
+    .flush = lcdSpiFlush,
+    .release = lcdSpiRelease,
+};
+
+/**
+ * @brief LCD constructor for a 74HC595 shift register
+ *
+ * MOSI goes to SER, SCLK to SRCLK and the latch (CS) to RCLK. A screen
+ * update is encoded as register states and queued in one go, the CPU
+ * does not toggle any pins.
+ * @param lcd       pointer to LCD object
+ * @param config    SPI bus configuration @see lcd_spi_config_t
+ * @note  The LCD cannot be read back on this bus.
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdCtorSPI(lcd_t *lcd, const lcd_spi_config_t *config)
+{
+    lcd_spi_ctx_t *ctx = calloc(1, sizeof(lcd_spi_ctx_t));
+
+    if (ctx == NULL)
+    {
+        return LCD_FAIL;
+    }
+
+    memcpy(ctx->wave.map, config->map, sizeof(ctx->wave.map));
+    ctx->wave.pulse = 1;
+    ctx->wave.hold = 1;
+    ctx->stateNs = 8000000000ULL / config->clockHz + LCD_SPI_LATCH_NS;
+    /* Force RS setup on the first write */
+    ctx->rs = 0xFF;
+    ctx->host = (spi_host_device_t)config->host;
+
+    spi_bus_config_t bus_config = {
+        .mosi_io_num = config->mosi,
+        .miso_io_num = -1,
+        .sclk_io_num = config->sclk,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+    };
+    spi_device_interface_config_t dev_config = {
+        .mode = 0,
+        .clock_speed_hz = config->clockHz,
+        .spics_io_num = config->latch,
+        .queue_size = LCD_SPI_QUEUE,
+    };
+
+    /* One byte per transaction, sent from tx_data without DMA */
+    if (spi_bus_initialize(ctx->host, &bus_config, 0) != ESP_OK)
+    {
+        ESP_LOGE(lcd_tag, "LCD SPI bus setup failed\n");
+        free(ctx);
+        return LCD_FAIL;
+    }
+    if (spi_bus_add_device(ctx->host, &dev_config, &ctx->dev) != ESP_OK)
+    {
+        ESP_LOGE(lcd_tag, "LCD SPI bus setup failed\n");
+        spi_bus_free(ctx->host);
+        free(ctx);
+        return LCD_FAIL;
+    }
+
+    /* Attach bus backend */
+    lcdCtorBus(lcd, &lcd_bus_spi, ctx, false);
+    return LCD_OK;
+}
@@ -0,0 +1,422 @@
+/**
+ * @file esp_lcd.hpp
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display C++ template header file
+ * @version 0.1
+ * @date 2022-08-15
+ * @copyright Copyright (c) 2022
+ *
+ * Header only driver where pins, geometry and timing are template
+ * parameters. Pin masks, row addresses and delays are compile time
+ * constants, so the whole write path inlines into a few register
+ * stores. Uses the same command set as esp_lcd.c, the C API stays
+ * available for runtime configured and non GPIO buses.
+ */
+#ifndef _ESP_LCD_HPP_
+#define _ESP_LCD_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_idf_version.h"
+#include "esp_rom_sys.h"
+#include "soc/soc.h"
+#include "soc/soc_caps.h"
+#include "soc/gpio_reg.h"
+#include "driver/gpio.h"
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include "esp_cpu.h"
+#else
+#include "hal/cpu_hal.h"
+#endif
+#include "esp_lcd.h"
+
+/* CPU clock for compile time cycle counts */
+#if defined(CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ)
+#define LCD_CPU_MHZ CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#elif defined(CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ)
+#define LCD_CPU_MHZ CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ
+#elif defined(CONFIG_ESP32S2_DEFAULT_CPU_FREQ_MHZ)
+#define LCD_CPU_MHZ CONFIG_ESP32S2_DEFAULT_CPU_FREQ_MHZ
+#elif defined(CONFIG_ESP32S3_DEFAULT_CPU_FREQ_MHZ)
+#define LCD_CPU_MHZ CONFIG_ESP32S3_DEFAULT_CPU_FREQ_MHZ
+#else
+#define LCD_CPU_MHZ 240 /*!< Fastest clock, delays only get longer */
+#endif
+
+namespace hd44780
+{
+
+/**
+ * @brief Read CPU cycle counter
+ *
+ * @return cycles
+ */
+static inline uint32_t cycles()
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    return (uint32_t)esp_cpu_get_cycle_count();
+#else
+    return (uint32_t)cpu_hal_get_cycle_count();
+#endif
+}
+
+/**
+ * @brief Busy wait CPU cycles
+ *
+ * @param n cycles
+ * @return None
+ */
+static inline void spin(uint32_t n)
+{
+    for (uint32_t start = cycles(); cycles() - start < n;)
+    {
+    }
+}
+
+/******************************************************************
+ * \struct Geometry esp_lcd.hpp
+ * \brief LCD geometry
+ *
+ * Rows 2 and 3 of 4 line panels continue DDRAM lines 0 and 1.
+ *******************************************************************/
+template <int Cols = LCD_COLS, int Rows = LCD_ROWS>
+struct Geometry
+{
+    static constexpr int cols = Cols; /*!< Visible columns */
+    static constexpr int rows = Rows; /*!< Visible rows */
+
+    /**
+     * @brief DDRAM address of a cell
+     *
+     * @param x column
+     * @param y row
+     * @return  DDRAM address
+     */
+    static constexpr uint8_t addr(int x, int y)
+    {
+        return (y & 1 ? 0x40 : 0x00) + (y >> 1) * Cols + x;
+    }
+};
+
+/******************************************************************
+ * \struct Timing esp_lcd.hpp
+ * \brief LCD bus timing, @see lcd_timing_t
+ *******************************************************************/
+template <uint16_t PulseNs = 500, uint16_t CmdUs = 50, uint16_t ClearUs = 2000, uint16_t SetupNs = 60>
+struct Timing
+{
+    static constexpr uint32_t pulseCycles = (PulseNs * LCD_CPU_MHZ + 999) / 1000; /*!< Enable pulse width */
+    static constexpr uint32_t setupCycles = (SetupNs * LCD_CPU_MHZ + 999) / 1000; /*!< RS set up before EN rises, tAS */
+    static constexpr uint32_t cmdUs = CmdUs;                                        /*!< Instruction execution time */
+    static constexpr uint32_t clearUs = ClearUs;                                    /*!< Clear and home execution time */
+};
+
+/******************************************************************
+ * \struct GpioBus esp_lcd.hpp
+ * \brief LCD GPIO bus, pins known at compile time
+ *
+ * Writes the data lines with one set and one clear register store
+ * per GPIO bank.
+ *******************************************************************/
+template <int D4, int D5, int D6, int D7, int RS, int EN>
+struct GpioBus
+{
+    /**
+     * @brief GPIO bank 0 mask of a pin
+     */
+    static constexpr uint32_t lo(int pin)
+    {
+        return (pin >= 0 && pin < 32) ? (1UL << pin) : 0;
+    }
+
+    /**
+     * @brief GPIO bank 1 mask of a pin
+     */
+    static constexpr uint32_t hi(int pin)
+    {
+        return pin >= 32 ? (1UL << (pin - 32)) : 0;
+    }
+
+    /**
+     * @brief GPIO bank 0 mask of the pins driven by lines
+     */
+    static constexpr uint32_t maskLo(uint8_t lines)
+    {
+        return ((lines & LCD_LINE_D4) ? lo(D4) : 0) | ((lines & LCD_LINE_D5) ? lo(D5) : 0) |
+               ((lines & LCD_LINE_D6) ? lo(D6) : 0) | ((lines & LCD_LINE_D7) ? lo(D7) : 0) |
+               ((lines & LCD_LINE_RS) ? lo(RS) : 0);
+    }
+
+    /**
+     * @brief GPIO bank 1 mask of the pins driven by lines
+     */
+    static constexpr uint32_t maskHi(uint8_t lines)
+    {
+        return ((lines & LCD_LINE_D4) ? hi(D4) : 0) | ((lines & LCD_LINE_D5) ? hi(D5) : 0) |
+               ((lines & LCD_LINE_D6) ? hi(D6) : 0) | ((lines & LCD_LINE_D7) ? hi(D7) : 0) |
+               ((lines & LCD_LINE_RS) ? hi(RS) : 0);
+    }
+
+    static constexpr uint32_t linesLo = maskLo(LCD_LINE_DATA | LCD_LINE_RS); /*!< Bank 0 data and RS */
+    static constexpr uint32_t linesHi = maskHi(LCD_LINE_DATA | LCD_LINE_RS); /*!< Bank 1 data and RS */
+
+    /**
+     * @brief Configure pins as outputs, driven low
+     *
+     * @return None
+     */
+    static void begin()
+    {
+        gpio_config_t config = {};
+        config.pin_bit_mask = (1ULL << D4) | (1ULL << D5) | (1ULL << D6) | (1ULL << D7) | (1ULL << RS) | (1ULL << EN);
+        config.mode = GPIO_MODE_OUTPUT;
+        gpio_config(&config);
+        REG_WRITE(GPIO_OUT_W1TC_REG, linesLo | lo(EN));
+#if SOC_GPIO_PIN_COUNT > 32
+        REG_WRITE(GPIO_OUT1_W1TC_REG, linesHi | hi(EN));
+#endif
+    }
+
+    /**
+     * @brief Drive D4 - D7 and RS
+     *
+     * @param lines D4 - D7 and RS @see LCD_LINE_RS
+     * @return None
+     */
+    static inline void write(uint8_t lines)
+    {
+        uint32_t setLo = maskLo(lines);
+        REG_WRITE(GPIO_OUT_W1TC_REG, linesLo & ~setLo);
+        REG_WRITE(GPIO_OUT_W1TS_REG, setLo);
+#if SOC_GPIO_PIN_COUNT > 32
+        if (linesHi != 0)
+        {
+            uint32_t setHi = maskHi(lines);
+            REG_WRITE(GPIO_OUT1_W1TC_REG, linesHi & ~setHi);
+            REG_WRITE(GPIO_OUT1_W1TS_REG, setHi);
+        }
+#endif
+    }
+
+    /**
+     * @brief Pulse EN, high then low
+     *
+     * @param width  pulse width and recovery in CPU cycles
+     * @return None
+     */
+    static inline void strobe(uint32_t width)
+    {
+        if (EN < 32)
+        {
+            REG_WRITE(GPIO_OUT_W1TS_REG, lo(EN));
+        }
+#if SOC_GPIO_PIN_COUNT > 32
+        else
+        {
+            REG_WRITE(GPIO_OUT1_W1TS_REG, hi(EN));
+        }
+#endif
+        spin(width);
+        if (EN < 32)
+        {
+            REG_WRITE(GPIO_OUT_W1TC_REG, lo(EN));
+        }
+#if SOC_GPIO_PIN_COUNT > 32
+        else
+        {
+            REG_WRITE(GPIO_OUT1_W1TC_REG, hi(EN));
+        }
+#endif
+        spin(width);
+    }
+};
+
+/******************************************************************
+ * \class Lcd esp_lcd.hpp
+ * \brief LCD driver specialized for bus, geometry and timing
+ *
+ * Holds no state, text is written straight to the LCD.
+ * typedef hd44780::Lcd<hd44780::GpioBus<19, 18, 17, 16, 23, 22>> lcd16x2;
+ *******************************************************************/
+template <class Bus, class Geom = Geometry<>, class Time = Timing<>>
+class Lcd
+{
+public:
+    /**
+     * @brief Configure pins and initialize LCD, @see lcdInit
+     *
+     * @return None
+     */
+    void init()
+    {
+        Bus::begin();
+        vTaskDelay(100 / portTICK_PERIOD_MS);
+
+        /* Send 0x03 3 times at 10ms, then 0x02 for 4-bit mode */
+        nibble(0x03, 10000);
+        nibble(0x03, 10000);
+        nibble(0x03, 10000);
+        nibble(0x02, 10000);
+
+        cmd(Geom::rows > 1 ? 0x28 : 0x20); // 4-bit, 2 line, 5x8
+        cmd(0x08);                         // Instruction Flow
+        cmd(0x01);                         // Clear LCD
+        cmd(0x06);                         // Auto-Increment
+        cmd(0x0C);                         // Display On, No blink
+    }
+
+    /**
+     * @brief Clear LCD, @see lcdClear
+     *
+     * @return lcd error status @see lcd_err_t
+     */
+    lcd_err_t clear()
+    {
+        cmd(0x01);
+        return LCD_OK;
+    }
+
+    /**
+     * @brief Write characters, @see lcdWrite
+     *
+     * @param buf   characters, not NUL terminated
+     * @param len   number of characters
+     * @param x     location at x-axis
+     * @param y     location at y-axis
+     * @return      lcd error status @see lcd_err_t
+     */
+    lcd_err_t write(const char *buf, size_t len, int x, int y)
+    {
+        if (x < 0 || x >= Geom::cols || y < 0 || y >= Geom::rows)
+        {
+            return LCD_FAIL;
+        }
+        if (len > (size_t)(Geom::cols - x))
+        {
+            len = Geom::cols - x;
+        }
+        cmd(0x80 | Geom::addr(x, y));
+        while (len-- > 0)
+        {
+            data(*buf++);
+        }
+        return LCD_OK;
+    }
+
+    /**
+     * @brief Set text, @see lcdSetText
+     *
+     * @param text  string text
+     * @param x     location at x-axis
+     * @param y     location at y-axis
+     * @return      lcd error status @see lcd_err_t
+     */
+    lcd_err_t setText(const char *text, int x, int y)
+    {
+        size_t len = 0;
+        while (text[len] != '\0' && len < (size_t)Geom::cols)
+        {
+            len++;
+        }
+        return write(text, len, x, y);
+    }
+
+    /**
+     * @brief Set integer, @see lcdSetInt
+     *
+     * @param val   integer value
+     * @param x     location at x-axis
+     * @param y     location at y-axis
+     * @return      lcd error status @see lcd_err_t
+     */
+    lcd_err_t setInt(int val, int x, int y)
+    {
+        char buf[12];
+        char *p = buf + sizeof(buf);
+        unsigned int u = val < 0 ? 0U - (unsigned int)val : (unsigned int)val;
+        do
+        {
+            *--p = '0' + u % 10;
+            u /= 10;
+        } while (u != 0);
+        if (val < 0)
+        {
+            *--p = '-';
+        }
+        return write(p, buf + sizeof(buf) - p, x, y);
+    }
+
+    /**
+     * @brief Load custom glyph, @see lcdSetGlyph
+     *
+     * @param slot      glyph slot, 0 - 7
+     * @param bitmap    5x8 rows, top first
+     * @return          lcd error status @see lcd_err_t
+     */
+    lcd_err_t setGlyph(int slot, const uint8_t bitmap[LCD_GLYPH_ROWS])
+    {
+        if (slot < 0 || slot >= LCD_GLYPHS)
+        {
+            return LCD_FAIL;
+        }
+        cmd(0x40 | (slot << 3));
+        for (int i = 0; i < LCD_GLYPH_ROWS; i++)
+        {
+            data(bitmap[i] & 0x1F);
+        }
+        return LCD_OK;
+    }
+
+private:
+    /**
+     * @brief Wait for the LCD, sleeping when it takes a tick or more
+     */
+    static inline void wait(uint32_t us)
+    {
+        if (us >= portTICK_PERIOD_MS * 1000)
+        {
+            /* Round up, a short sleep would cut the LCD's execution time */
+            vTaskDelay((us + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000));
+        }
+        else if (us > 0)
+        {
+            esp_rom_delay_us(us);
+        }
+    }
+
+    /**
+     * @brief Latch nibble and wait
+     */
+    static inline void nibble(uint8_t lines, uint32_t us)
+    {
+        Bus::write(lines);
+        spin(Time::setupCycles);
+        Bus::strobe(Time::pulseCycles);
+        wait(us);
+    }
+
+    /**
+     * @brief Write command
+     */
+    static inline void cmd(uint8_t val)
+    {
+        nibble(val >> 4, 0);
+        nibble(val & 0x0F, val <= 0x03 ? Time::clearUs : Time::cmdUs);
+    }
+
+    /**
+     * @brief Write data
+     */
+    static inline void data(uint8_t val)
+    {
+        nibble(LCD_LINE_RS | (val >> 4), 0);
+        nibble(LCD_LINE_RS | (val & 0x0F), Time::cmdUs);
+    }
+};
+
+} // namespace hd44780
+
+#endif
@@ -0,0 +1,266 @@
+/**
+ * @file esp_lcd_anim.c
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display glyph animation source file
+ * @version 0.1
+ * @date 2022-08-15
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <string.h>
+#include "esp_lcd.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#define LCD_ANIM_GLYPH_BYTES (2 + LCD_GLYPH_ROWS) /*!< Bus writes per glyph, CGRAM address, rows, DDRAM address */
+
+/**
+ * @brief Next slot to animate, the most overdue first
+ *
+ * @param anim  animations
+ * @param now   time in microseconds
+ * @return      glyph slot, -1 when none is due
+ */
+static int lcdAnimDue(const lcd_anim_t *anim, int64_t now)
+{
+    int i, slot = -1;
+
+    for (i = 0; i < LCD_GLYPHS; i++)
+    {
+        if ((anim->active & (1 << i)) && anim->sprites[i].due <= now &&
+            (slot < 0 || anim->sprites[i].due < anim->sprites[slot].due))
+        {
+            slot = i;
+        }
+    }
+    return slot;
+}
+
+/**
+ * @brief Animation tick, writes the glyphs whose next frame is due
+ *
+ * Runs in the esp_timer task. A busy bus skips the tick, frames stay
+ * due for the next one. Frames over the bus budget wait for the next
+ * tick too, the most overdue go first so no glyph starves.
+ * @param arg   animations
+ * @return None
+ */
+static void lcdAnimTick(void *arg)
+{
+    lcd_anim_t *anim = arg;
+    lcd_t *lcd = anim->lcd;
+    lcd_sprite_t *sprite;
+    int64_t now, start;
+    uint32_t spent = 0;
+    int slot, i;
+
+    if (xSemaphoreTakeRecursive(lcd->lock, 0) != pdTRUE)
+    {
+        return;
+    }
+    now = esp_timer_get_time();
+    while (lcd->anim == anim && (slot = lcdAnimDue(anim, now)) >= 0)
+    {
+        if (anim->budgetUs > 0 && spent > 0 && spent + anim->costUs > anim->budgetUs)
+        {
+            /* Count what the budget held back */
+            for (i = 0; i < LCD_GLYPHS; i++)
+            {
+                if ((anim->active & (1 << i)) && anim->sprites[i].due <= now)
+                {
+                    anim->deferred++;
+                }
+            }
+            break;
+        }
+
+        sprite = &anim->sprites[slot];
+        sprite->frame = (sprite->frame + 1) % sprite->count;
+        /* Late frames are dropped, not written in a burst */
+        sprite->due += sprite->frameUs;
+        if (sprite->due <= now)
+        {
+            sprite->due = now + sprite->frameUs;
+        }
+
+        /* Repeated frames, e.g. a blink holding its on state, cost nothing */
+        if (memcmp(lcd->cgram[slot], sprite->frames[sprite->frame], LCD_GLYPH_ROWS) != 0)
+        {
+            start = esp_timer_get_time();
+            lcdSetGlyph(lcd, slot, sprite->frames[sprite->frame]);
+            anim->costUs = esp_timer_get_time() - start;
+            spent += anim->costUs;
+            anim->frames++;
+        }
+    }
+    xSemaphoreGiveRecursive(lcd->lock);
+}
+
+/**
+ * @brief Animate glyphs from a timer
+ *
+ * An animated glyph cycles through its frames by rewriting the 8 CGRAM
+ * bytes of its slot, every cell showing the glyph changes with it and
+ * no text is rewritten. Each tick writes the glyphs whose next frame is
+ * due, at most budgetUs of bus time per tick.
+ * @param lcd       pointer to LCD object
+ * @param anim      animation state, owned by the caller until lcdAnimClose
+ * @param tickMs    tick period, 0 for LCD_ANIM_TICK_MS, limits the frame rate
+ * @param budgetUs  bus time per tick, 0 unlimited, one glyph is written
+ *                  per tick whatever the budget
+ * @note  Frames are not updates, they do not wake a dimmed backlight.
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdAnimOpen(lcd_t *const lcd, lcd_anim_t *anim, uint32_t tickMs, uint32_t budgetUs)
+{
+    esp_timer_create_args_t args = {
+        .callback = lcdAnimTick,
+        .arg = anim,
+        .name = "LCD anim",
+    };
+
+    if (lcd->state != LCD_ACTIVE || lcd->lock == NULL || lcd->anim != NULL)
+    {
+        return LCD_FAIL;
+    }
+
+    memset(anim, 0, sizeof(lcd_anim_t));
+    anim->lcd = lcd;
+    anim->tickUs = (tickMs > 0 ? tickMs : LCD_ANIM_TICK_MS) * 1000;
+    anim->budgetUs = budgetUs;
+    /* Estimate until the first write is measured */
+    anim->costUs = LCD_ANIM_GLYPH_BYTES * (lcd->timing.cmdUs + (4 * lcd->timing.pulseNs + 999) / 1000);
+    if (esp_timer_create(&args, &anim->tick) != ESP_OK)
+    {
+        return LCD_FAIL;
+    }
+
+    /* Own the bus */
+    xSemaphoreTakeRecursive(lcd->lock, portMAX_DELAY);
+    lcd->anim = anim;
+    xSemaphoreGiveRecursive(lcd->lock);
+    return LCD_OK;
+}
+
+/**
+ * @brief Start or replace the animation of a glyph slot
+ *
+ * The first frame is written at once. Show the glyph like any custom
+ * glyph, with character code slot or slot + 8.
+ * @param lcd       pointer to LCD object
+ * @param slot      glyph slot, 0 - 7
+ * @param frames    frame bitmaps, kept by reference
+ * @param count     number of frames, 1 - 255
+ * @param frameMs   time per frame, each frame lands on the next tick,
+ *                  shorter than a tick or 0 is one tick, at most
+ *                  UINT32_MAX / 1000
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdAnimStart(lcd_t *const lcd, int slot, const uint8_t (*frames)[LCD_GLYPH_ROWS], int count, uint32_t frameMs)
+{
+    lcd_anim_t *anim;
+    lcd_sprite_t *sprite;
+
+    if (lcd->lock == NULL || slot < 0 || slot >= LCD_GLYPHS || count < 1 || count > UINT8_MAX ||
+        frameMs > UINT32_MAX / 1000)
+    {
+        return LCD_FAIL;
+    }
+
+    /* Own the bus, the tick skips while held */
+    xSemaphoreTakeRecursive(lcd->lock, portMAX_DELAY);
+
+    if ((anim = lcd->anim) == NULL || lcdSetGlyph(lcd, slot, frames[0]) != LCD_OK)
+    {
+        xSemaphoreGiveRecursive(lcd->lock);
+        return LCD_FAIL;
+    }
+    sprite = &anim->sprites[slot];
+    sprite->frames = frames;
+    sprite->count = count;
+    sprite->frame = 0;
+    /* A frame per tick at most, a due frame always moves past the tick */
+    sprite->frameUs = frameMs * 1000 > anim->tickUs ? frameMs * 1000 : anim->tickUs;
+    sprite->due = esp_timer_get_time() + sprite->frameUs;
+    if (anim->active == 0)
+    {
+        esp_timer_start_periodic(anim->tick, anim->tickUs);
+    }
+    anim->active |= 1 << slot;
+
+    xSemaphoreGiveRecursive(lcd->lock);
+    return LCD_OK;
+}
+
+/**
+ * @brief Stop the animation of a glyph slot
+ *
+ * @param lcd   pointer to LCD object
+ * @param slot  glyph slot, 0 - 7
+ * @note  The glyph keeps the frame shown.
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdAnimStop(lcd_t *const lcd, int slot)
+{
+    lcd_anim_t *anim;
+
+    if (lcd->lock == NULL || slot < 0 || slot >= LCD_GLYPHS)
+    {
+        return LCD_FAIL;
+    }
+
+    /* Own the bus */
+    xSemaphoreTakeRecursive(lcd->lock, portMAX_DELAY);
+
+    if ((anim = lcd->anim) == NULL || !(anim->active & (1 << slot)))
+    {
+        xSemaphoreGiveRecursive(lcd->lock);
+        return LCD_FAIL;
+    }
+    anim->active &= ~(1 << slot);
+    if (anim->active == 0)
+    {
+        /* Nothing to tick for */
+        esp_timer_stop(anim->tick);
+    }
+
+    xSemaphoreGiveRecursive(lcd->lock);
+    return LCD_OK;
+}
+
+/**
+ * @brief Stop all glyph animations
+ *
+ * @param lcd   pointer to LCD object
+ * @note  Glyphs keep the frames shown.
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdAnimClose(lcd_t *const lcd)
+{
+    lcd_anim_t *anim;
+
+    if (lcd->lock == NULL)
+    {
+        return LCD_FAIL;
+    }
+
+    /* Own the bus, the tick skips while held */
+    xSemaphoreTakeRecursive(lcd->lock, portMAX_DELAY);
+
+    if ((anim = lcd->anim) == NULL)
+    {
+        xSemaphoreGiveRecursive(lcd->lock);
+        return LCD_FAIL;
+    }
+    lcd->anim = NULL;
+    esp_timer_stop(anim->tick);
+    esp_timer_delete(anim->tick);
+    anim->tick = NULL;
+    anim->active = 0;
+
+    xSemaphoreGiveRecursive(lcd->lock);
+    return LCD_OK;
+}
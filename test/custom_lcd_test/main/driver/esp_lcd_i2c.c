@@ -0,0 +1,295 @@
+/**
+ * @file esp_lcd_i2c.c
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display I2C expander bus source file
+ * @version 0.1
+ * @date 2022-08-15
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_idf_version.h"
+#include "esp_lcd.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+#include "driver/i2c_master.h"
+#else
+#include "driver/i2c.h"
+#endif
+
+#define LCD_I2C_BUF_SIZE    64      /*!< Expander writes per I2C transaction */
+#define LCD_I2C_SLEEP_US    1000    /*!< Waits of this length sleep instead of padding */
+#define LCD_I2C_TIMEOUT_MS  100     /*!< I2C transaction timeout */
+
+/* LCD tag */
+static const char *lcd_tag = "LCD tag"; /*! < LCD tag */
+
+/******************************************************************
+ * \struct lcd_i2c_ctx_t esp_lcd_i2c.c
+ * \brief I2C bus backend context
+ *******************************************************************/
+typedef struct
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+    i2c_master_bus_handle_t i2c;        /*!< I2C master bus */
+    i2c_master_dev_handle_t dev;        /*!< Expander device */
+#else
+    i2c_port_t port;                    /*!< I2C port */
+    uint8_t addr;                       /*!< Expander address */
+#endif
+    lcd_wave_t wave;                    /*!< Expander pin mapping */
+    uint32_t byteNs;                    /*!< Time to send one expander byte */
+    uint8_t buf[LCD_I2C_BUF_SIZE];      /*!< Queued expander writes */
+    size_t len;                         /*!< Queued bytes */
+    uint8_t rs;                         /*!< RS of the last write */
+} lcd_i2c_ctx_t;
+
+/**
+ * @brief Send bytes to the expander in one transaction
+ *
+ * @param ctx   I2C backend context
+ * @param buf   expander bytes
+ * @param len   number of bytes
+ * @return      true on success
+ */
+static bool lcdI2CSend(lcd_i2c_ctx_t *ctx, const uint8_t *buf, size_t len)
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+    return i2c_master_transmit(ctx->dev, buf, len, LCD_I2C_TIMEOUT_MS) == ESP_OK;
+#else
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (ctx->addr << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write(cmd, (uint8_t *)buf, len, true);
+    i2c_master_stop(cmd);
+    esp_err_t err = i2c_master_cmd_begin(ctx->port, cmd, pdMS_TO_TICKS(LCD_I2C_TIMEOUT_MS));
+    i2c_cmd_link_delete(cmd);
+    return err == ESP_OK;
+#endif
+}
+
+/**
+ * @brief Receive one byte from the expander
+ *
+ * @param ctx   I2C backend context
+ * @return      expander pins, -1 on error
+ */
+static int lcdI2CReceive(lcd_i2c_ctx_t *ctx)
+{
+    uint8_t val = 0;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+    esp_err_t err = i2c_master_receive(ctx->dev, &val, 1, LCD_I2C_TIMEOUT_MS);
+#else
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (ctx->addr << 1) | I2C_MASTER_READ, true);
+    i2c_master_read_byte(cmd, &val, I2C_MASTER_NACK);
+    i2c_master_stop(cmd);
+    esp_err_t err = i2c_master_cmd_begin(ctx->port, cmd, pdMS_TO_TICKS(LCD_I2C_TIMEOUT_MS));
+    i2c_cmd_link_delete(cmd);
+#endif
+    return err == ESP_OK ? val : -1;
+}
+
+/**
+ * @brief I2C bus, send queued expander writes
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdI2CFlush(lcd_t *const lcd)
+{
+    lcd_i2c_ctx_t *ctx = (lcd_i2c_ctx_t *)lcd->busHandle;
+    if (ctx->len > 0 && !lcdI2CSend(ctx, ctx->buf, ctx->len))
+    {
+        ESP_LOGE(lcd_tag, "LCD I2C write failed\n");
+    }
+    ctx->len = 0;
+}
+
+/**
+ * @brief I2C bus, queue nibble as expander writes
+ *
+ * A nibble is two expander writes, EN high then EN low, plus one more
+ * before them when RS changes. Short waits are covered by the time the
+ * following bytes take on the wire.
+ * @param lcd   pointer to LCD object
+ * @param lines D4 - D7 and RS @see LCD_LINE_RS
+ * @param us    wait after the strobe in microseconds
+ * @return None
+ */
+static void lcdI2CWrite(lcd_t *const lcd, uint8_t lines, uint32_t us)
+{
+    lcd_i2c_ctx_t *ctx = (lcd_i2c_ctx_t *)lcd->busHandle;
+    bool sleep = us >= LCD_I2C_SLEEP_US;
+    uint32_t wait = (us * 1000 + ctx->byteNs - 1) / ctx->byteNs;
+    size_t n;
+
+    /* RS setup time before EN */
+    ctx->wave.setup = (lines & LCD_LINE_RS) != ctx->rs;
+    ctx->rs = lines & LCD_LINE_RS;
+    wait = (sleep || wait <= 1) ? 0 : wait - 1;
+
+    n = lcdWaveEncode(&ctx->wave, lines | LCD_LINE_BL, wait, ctx->buf + ctx->len, sizeof(ctx->buf) - ctx->len);
+    if (n == 0)
+    {
+        lcdI2CFlush(lcd);
+        n = lcdWaveEncode(&ctx->wave, lines | LCD_LINE_BL, wait, ctx->buf, sizeof(ctx->buf));
+    }
+    ctx->len += n;
+
+    if (sleep)
+    {
+        lcdI2CFlush(lcd);
+        lcdBusWait(lcd, us);
+    }
+}
+
+/**
+ * @brief I2C bus, read byte in two nibbles
+ *
+ * The expander pins are quasi-bidirectional, writing D4 - D7 high
+ * lets the LCD drive them.
+ * @param lcd   pointer to LCD object
+ * @param lines RS @see LCD_LINE_RS
+ * @return      byte read, -1 on error
+ */
+static int lcdI2CRead(lcd_t *const lcd, uint8_t lines)
+{
+    lcd_i2c_ctx_t *ctx = (lcd_i2c_ctx_t *)lcd->busHandle;
+    uint8_t base = lcdWaveMap(&ctx->wave, (lines & LCD_LINE_RS) | LCD_LINE_RW | LCD_LINE_DATA | LCD_LINE_BL);
+    uint8_t strobe = lcdWaveMap(&ctx->wave, (lines & LCD_LINE_RS) | LCD_LINE_RW | LCD_LINE_DATA | LCD_LINE_BL | LCD_LINE_EN);
+    uint8_t seq[2] = { base, strobe };
+    int val = 0, pins, half, i;
+
+    lcdI2CFlush(lcd);
+    /* R/W stays high, the next write sets up RS and R/W before EN */
+    ctx->rs = 0xFF;
+    for (half = 0; half < 2; half++)
+    {
+        if (!lcdI2CSend(ctx, seq, sizeof(seq)) || (pins = lcdI2CReceive(ctx)) < 0)
+        {
+            return -1;
+        }
+        lcdI2CSend(ctx, &base, 1);
+
+        /* Expander pins to D4 - D7 */
+        val <<= 4;
+        for (i = 0; i < LCD_DATA_LINE; i++)
+        {
+            val |= ((pins >> ctx->wave.map[i]) & 1) << i;
+        }
+    }
+    return val;
+}
+
+/**
+ * @brief I2C bus, release expander and bus
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdI2CRelease(lcd_t *const lcd)
+{
+    lcd_i2c_ctx_t *ctx = (lcd_i2c_ctx_t *)lcd->busHandle;
+    lcdI2CFlush(lcd);
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+    i2c_master_bus_rm_device(ctx->dev);
+    i2c_del_master_bus(ctx->i2c);
+#else
+    i2c_driver_delete(ctx->port);
+#endif
+    free(ctx);
+    lcd->busHandle = NULL;
+}
+
+/* I2C bus, PCF8574 style expander */
+static const lcd_bus_t lcd_bus_i2c = {
+    .write = lcdI2CWrite,
+    .read = lcdI2CRead,
+    .flush = lcdI2CFlush,
+    .release = lcdI2CRelease,
+};
+
+/**
+ * @brief LCD constructor for an I2C expander backpack
+ *
+ * Installs the I2C master on the given port. Writes between flushes are
+ * sent as one I2C transaction, a whole screen update takes a handful of
+ * transactions instead of one per pin change.
+ * @param lcd       pointer to LCD object
+ * @param config    I2C bus configuration @see lcd_i2c_config_t
+ * @note  Reading back needs R/W wired to the expander.
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdCtorI2C(lcd_t *lcd, const lcd_i2c_config_t *config)
+{
+    lcd_i2c_ctx_t *ctx = calloc(1, sizeof(lcd_i2c_ctx_t));
+    bool ok;
+
+    if (ctx == NULL)
+    {
+        return LCD_FAIL;
+    }
+
+    memcpy(ctx->wave.map, config->map, sizeof(ctx->wave.map));
+    ctx->wave.pulse = 1;
+    ctx->wave.hold = 1;
+    /* Start, address and data bytes are 9 clocks each */
+    ctx->byteNs = 9000000000ULL / config->clockHz;
+    /* Force RS setup on the first write */
+    ctx->rs = 0xFF;
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+    i2c_master_bus_config_t bus_config = {
+        .i2c_port = config->port,
+        .sda_io_num = config->sda,
+        .scl_io_num = config->scl,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .flags.enable_internal_pullup = true,
+    };
+    i2c_device_config_t dev_config = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = config->addr,
+        .scl_speed_hz = config->clockHz,
+    };
+    ok = i2c_new_master_bus(&bus_config, &ctx->i2c) == ESP_OK;
+    if (ok && i2c_master_bus_add_device(ctx->i2c, &dev_config, &ctx->dev) != ESP_OK)
+    {
+        i2c_del_master_bus(ctx->i2c);
+        ok = false;
+    }
+#else
+    i2c_config_t i2c_config = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = config->sda,
+        .scl_io_num = config->scl,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = config->clockHz,
+    };
+    ctx->port = config->port;
+    ctx->addr = config->addr;
+    ok = i2c_param_config(ctx->port, &i2c_config) == ESP_OK &&
+         i2c_driver_install(ctx->port, I2C_MODE_MASTER, 0, 0, 0) == ESP_OK;
+#endif
+
+    if (!ok)
+    {
+        ESP_LOGE(lcd_tag, "LCD I2C bus setup failed\n");
+        free(ctx);
+        return LCD_FAIL;
+    }
+
+    /* Attach bus backend */
+    lcdCtorBus(lcd, &lcd_bus_i2c, ctx, config->map[5] < 8);
+    /* A read costs several I2C transactions, probe sync now and then */
+    lcd->lazyProbe = true;
+    lcd->calKey = LCD_CAL_KEY_I2C | config->port << 8 | config->addr;
+    return LCD_OK;
+}
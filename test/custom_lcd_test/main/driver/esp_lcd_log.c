@@ -0,0 +1,258 @@
+/**
+ * @file esp_lcd_log.c
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display log sink source file
+ * @version 0.1
+ * @date 2022-08-15
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_lcd.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define LCD_LOG_LINE        96      /*!< Formatted log line kept for parsing */
+#define LCD_LOG_STACK       2560    /*!< Log task stack in bytes */
+#define LCD_LOG_PRIORITY    1       /*!< Log task priority, just above idle */
+
+/******************************************************************
+ * \struct lcd_log_ctx_t esp_lcd_log.c
+ * \brief Log sink state, esp_log has a single output hook
+ *******************************************************************/
+typedef struct
+{
+    lcd_t *lcd;                             /*!< LCD object, NULL when closed */
+    lcd_log_config_t config;                /*!< Filter and layout */
+    vprintf_like_t prev;                    /*!< Previous log output, still called */
+    TaskHandle_t task;                      /*!< Log task, parked while closed */
+    volatile bool busy;                     /*!< Log task is writing the LCD */
+    portMUX_TYPE mux;                       /*!< Guards the line ring */
+    char lines[LCD_ROWS][LCD_COLS];         /*!< Newest log lines */
+    uint32_t count;                         /*!< Lines taken, ring position */
+} lcd_log_ctx_t;
+
+static lcd_log_ctx_t lcd_log = {
+    .mux = portMUX_INITIALIZER_UNLOCKED,
+};
+
+/**
+ * @brief Split formatted log line into level, tag and message
+ *
+ * Lines look like "W (1234) tag: message", optionally wrapped in colour
+ * sequences. Lines in another format are kept whole at info level.
+ * @param line  formatted line, modified
+ * @param level level of the line
+ * @param tag   tag, NULL when there is none
+ * @return      message
+ */
+static char *lcdLogParse(char *line, esp_log_level_t *level, const char **tag)
+{
+    static const char letters[] = "EWIDV";
+    char *p = line, *end;
+
+    /* Colour sequence */
+    if (*p == '\033' && (end = strchr(p, 'm')) != NULL)
+    {
+        p = line = end + 1;
+    }
+    /* Newline and colour reset */
+    end = p + strcspn(p, "\033\r\n");
+    *end = '\0';
+
+    *level = ESP_LOG_INFO;
+    *tag = NULL;
+    if (*p == '\0' || strchr(letters, *p) == NULL || strncmp(p + 1, " (", 2) != 0)
+    {
+        return line;
+    }
+    *level = (esp_log_level_t)(ESP_LOG_ERROR + (strchr(letters, *p) - letters));
+
+    /* Skip timestamp, tag ends at ": " */
+    if ((p = strstr(p, ") ")) == NULL || (end = strstr(p + 2, ": ")) == NULL)
+    {
+        return line;
+    }
+    *end = '\0';
+    *tag = p + 2;
+    return end + 2;
+}
+
+/**
+ * @brief Log output hook
+ *
+ * Keeps the previous output and queues matching lines for the log task.
+ * Never touches the LCD, so logging from inside the driver or a burst
+ * of messages cannot block the caller on the bus.
+ * @param format    printf format
+ * @param args      arguments
+ * @return          characters written by the previous output
+ */
+static int lcdLogVprintf(const char *format, va_list args)
+{
+    char line[LCD_LOG_LINE];
+    const char *tag, *msg;
+    esp_log_level_t level;
+    char *slot;
+    va_list copy;
+    bool queued = false;
+    int ret = 0, i;
+
+    va_copy(copy, args);
+    if (lcd_log.prev != NULL)
+    {
+        ret = lcd_log.prev(format, args);
+    }
+    vsnprintf(line, sizeof(line), format, copy);
+    va_end(copy);
+
+    msg = lcdLogParse(line, &level, &tag);
+    if (level > lcd_log.config.level || *msg == '\0' ||
+        (lcd_log.config.tag != NULL && (tag == NULL || strcmp(tag, lcd_log.config.tag) != 0)))
+    {
+        return ret;
+    }
+
+    portENTER_CRITICAL(&lcd_log.mux);
+    if (lcd_log.lcd != NULL)
+    {
+        /* Printable ASCII, padded so old text is overwritten */
+        slot = lcd_log.lines[lcd_log.count++ % LCD_ROWS];
+        for (i = 0; i < LCD_COLS; i++)
+        {
+            uint8_t ch = *msg != '\0' ? (uint8_t)*msg++ : ' ';
+            slot[i] = (ch < 0x20 || ch > 0x7E) ? '?' : ch;
+        }
+        queued = true;
+    }
+    portEXIT_CRITICAL(&lcd_log.mux);
+
+    if (queued)
+    {
+        xTaskNotifyGive(lcd_log.task);
+    }
+    return ret;
+}
+
+/**
+ * @brief Log task, shows the newest lines at most once per interval
+ *
+ * @param arg   unused
+ * @return None
+ */
+static void lcdLogTask(void *arg)
+{
+    char text[LCD_ROWS][LCD_COLS];
+    lcd_span_t spans[LCD_ROWS];
+    lcd_t *lcd;
+    uint32_t count;
+    int i, n;
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        /* Newest line on the bottom row */
+        n = lcd_log.config.rows;
+        portENTER_CRITICAL(&lcd_log.mux);
+        lcd = lcd_log.lcd;
+        lcd_log.busy = lcd != NULL;
+        count = lcd_log.count;
+        for (i = 0; i < n; i++)
+        {
+            if (count + i >= (uint32_t)n)
+            {
+                memcpy(text[i], lcd_log.lines[(count + i - n) % LCD_ROWS], LCD_COLS);
+            }
+            else
+            {
+                memset(text[i], ' ', LCD_COLS);
+            }
+        }
+        portEXIT_CRITICAL(&lcd_log.mux);
+        if (lcd == NULL)
+        {
+            continue;
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            spans[i].buf = text[i];
+            spans[i].len = LCD_COLS;
+            spans[i].x = 0;
+            spans[i].y = lcd_log.config.row + i;
+        }
+        lcdWriteSpans(lcd, spans, n);
+        lcd_log.busy = false;
+
+        /* Lines logged meanwhile are shown together */
+        vTaskDelay(pdMS_TO_TICKS(lcd_log.config.intervalMs));
+    }
+}
+
+/**
+ * @brief Mirror log output to the LCD
+ *
+ * The newest matching log lines are shown on the configured rows, at
+ * most once per interval. A burst of messages costs the caller one
+ * line copy each, the LCD is written by a low priority task and only
+ * the changed cells go out.
+ * @param lcd       pointer to LCD object
+ * @param config    filter and layout @see lcd_log_config_t
+ * @note  One sink at a time, log output keeps going to the console.
+ *        The log task is created on first use and parked after close.
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdLogOpen(lcd_t *const lcd, const lcd_log_config_t *config)
+{
+    if (lcd_log.lcd != NULL || lcd->state != LCD_ACTIVE || config->rows == 0 ||
+        config->row + config->rows > LCD_ROWS)
+    {
+        return LCD_FAIL;
+    }
+    if (lcd_log.task == NULL &&
+        xTaskCreate(lcdLogTask, "LCD log", LCD_LOG_STACK, NULL, LCD_LOG_PRIORITY, &lcd_log.task) != pdPASS)
+    {
+        lcd_log.task = NULL;
+        return LCD_FAIL;
+    }
+
+    lcd_log.config = *config;
+    lcd_log.count = 0;
+    portENTER_CRITICAL(&lcd_log.mux);
+    lcd_log.lcd = lcd;
+    portEXIT_CRITICAL(&lcd_log.mux);
+    lcd_log.prev = esp_log_set_vprintf(lcdLogVprintf);
+    return LCD_OK;
+}
+
+/**
+ * @brief Stop mirroring log output
+ *
+ * @param lcd   pointer to LCD object
+ * @note  The rows keep the last lines shown.
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdLogClose(lcd_t *const lcd)
+{
+    if (lcd_log.lcd != lcd)
+    {
+        return LCD_FAIL;
+    }
+    esp_log_set_vprintf(lcd_log.prev);
+    portENTER_CRITICAL(&lcd_log.mux);
+    lcd_log.lcd = NULL;
+    portEXIT_CRITICAL(&lcd_log.mux);
+
+    /* Wait for an update in progress, the LCD may be freed next */
+    while (lcd_log.busy)
+    {
+        vTaskDelay(1);
+    }
+    return LCD_OK;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file esp_lcd_trace.c
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display bus trace export source file
+ * @version 0.1
+ * @date 2022-08-15
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdio.h>
+#include "esp_lcd.h"
+
+#define LCD_TRACE_LINES 8 /*!< Bus lines in a sample */
+
+/* Bus line names, in bit order @see LCD_LINE_RS */
+static const char *const lcd_trace_names[LCD_TRACE_LINES] = {
+    "D4", "D5", "D6", "D7", "RS", "RW", "EN", "BL",
+};
+
+/**
+ * @brief Write bus trace as a VCD file
+ *
+ * The file opens in GTKWave and similar viewers, one wire per bus line
+ * with nanosecond timestamps. Works on the device, e.g. to stdout or a
+ * file on flash, and on a host build of the driver.
+ * @param trace bus trace @see lcdTraceStart
+ * @param out   output stream
+ * @note  When the ring has wrapped, lines start out unknown until the
+ *        first kept transition.
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdTraceVcd(const lcd_trace_t *trace, FILE *out)
+{
+    uint32_t first = trace->count > LCD_TRACE_SIZE ? trace->count - LCD_TRACE_SIZE : 0;
+    uint32_t i, prev = 0;
+    uint64_t cycles = 0;
+    uint8_t lines = 0, changed;
+    int bit;
+
+    if (trace->cpuMhz == 0)
+    {
+        return LCD_FAIL;
+    }
+
+    /* Header, one wire per bus line */
+    fprintf(out, "$version esp_lcd bus trace $end\n$timescale 1ns $end\n$scope module lcd $end\n");
+    for (bit = 0; bit < LCD_TRACE_LINES; bit++)
+    {
+        fprintf(out, "$var wire 1 %c %s $end\n", '!' + bit, lcd_trace_names[bit]);
+    }
+    fprintf(out, "$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+    for (bit = 0; bit < LCD_TRACE_LINES; bit++)
+    {
+        fprintf(out, "%c%c\n", first > 0 ? 'x' : '0', '!' + bit);
+    }
+    fprintf(out, "$end\n");
+
+    for (i = first; i < trace->count; i++)
+    {
+        const lcd_trace_sample_t *sample = &trace->samples[i % LCD_TRACE_SIZE];
+
+        /* Cycle counter wraps, samples are in order */
+        cycles += (uint32_t)(sample->cycles - prev);
+        prev = sample->cycles;
+        changed = (i == first && first > 0) ? 0xFF : (sample->lines ^ lines);
+        lines = sample->lines;
+
+        fprintf(out, "#%llu\n", (unsigned long long)(cycles * 1000 / trace->cpuMhz));
+        for (bit = 0; bit < LCD_TRACE_LINES; bit++)
+        {
+            if (changed & (1 << bit))
+            {
+                fprintf(out, "%c%c\n", (lines >> bit) & 1 ? '1' : '0', '!' + bit);
+            }
+        }
+    }
+    return ferror(out) ? LCD_FAIL : LCD_OK;
+}
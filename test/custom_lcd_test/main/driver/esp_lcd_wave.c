@@ -0,0 +1,78 @@
+/**
+ * @file esp_lcd_wave.c
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display bus waveform encoder source file
+ * @version 0.1
+ * @date 2022-08-15
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stddef.h>
+#include "esp_lcd.h"
+
+/**
+ * @brief Map bus lines to an output sample
+ *
+ * @param wave  waveform shape @see lcd_wave_t
+ * @param lines bus lines @see LCD_LINE_RS
+ * @return      output sample
+ */
+uint8_t lcdWaveMap(const lcd_wave_t *wave, uint8_t lines)
+{
+    uint8_t out = wave->idle;
+    int i;
+    for (i = 0; i < 8; i++)
+    {
+        if (wave->map[i] < 8)
+        {
+            out &= ~(1 << wave->map[i]);
+            out |= ((lines >> i) & 1) << wave->map[i];
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Encode one nibble write as output samples
+ *
+ * Emits setup samples with EN low, pulse samples with EN high, then
+ * hold and wait samples with EN low. The encoder has no side effects,
+ * bus backends stream its output through DMA, I2C or SPI.
+ * @param wave  waveform shape @see lcd_wave_t
+ * @param lines D4 - D7, RS and BL @see LCD_LINE_RS
+ * @param wait  extra samples after the hold time
+ * @param buf   output buffer
+ * @param size  output buffer size in samples
+ * @return      samples written, 0 if the nibble does not fit
+ */
+size_t lcdWaveEncode(const lcd_wave_t *wave, uint8_t lines, uint32_t wait, uint8_t *buf, size_t size)
+{
+    size_t total = (size_t)wave->setup + wave->pulse + wave->hold + wait;
+    uint8_t low, high;
+    size_t i = 0, n;
+
+    if (total > size)
+    {
+        return 0;
+    }
+
+    lines &= ~(LCD_LINE_EN | LCD_LINE_RW);
+    low = lcdWaveMap(wave, lines);
+    high = lcdWaveMap(wave, lines | LCD_LINE_EN);
+
+    for (n = 0; n < wave->setup; n++)
+    {
+        buf[i++] = low;
+    }
+    for (n = 0; n < wave->pulse; n++)
+    {
+        buf[i++] = high;
+    }
+    for (n = 0; n < wave->hold + wait; n++)
+    {
+        buf[i++] = low;
+    }
+    return i;
+}
@@ -0,0 +1,347 @@
+/**
+ * @file esp_lcd_backlight.c
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display backlight source file
+ * @version 0.1
+ * @date 2022-08-15
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <string.h>
+#include "esp_idf_version.h"
+#include "esp_lcd.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/ledc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#define LCD_BL_MODE LEDC_LOW_SPEED_MODE /*!< LEDC speed mode, available on every target */
+
+/* LCD tag */
+static const char *lcd_tag = "LCD tag"; /*! < LCD tag */
+
+/**
+ * @brief LEDC backend, set up timer, channel and hardware fades
+ *
+ * @param bl    backlight
+ * @return      true on success
+ */
+static bool lcdLedcInit(lcd_backlight_t *bl)
+{
+    esp_err_t err;
+    ledc_timer_config_t timer = {
+        .speed_mode = LCD_BL_MODE,
+        .duty_resolution = LEDC_TIMER_10_BIT,
+        .timer_num = (ledc_timer_t)bl->config.timer,
+        .freq_hz = bl->config.freqHz,
+        .clk_cfg = LEDC_AUTO_CLK,
+    };
+    ledc_channel_config_t channel = {
+        .gpio_num = bl->config.pin,
+        .speed_mode = LCD_BL_MODE,
+        .channel = (ledc_channel_t)bl->config.channel,
+        .timer_sel = (ledc_timer_t)bl->config.timer,
+        .duty = 0,
+        .hpoint = 0,
+    };
+
+    if (ledc_timer_config(&timer) != ESP_OK || ledc_channel_config(&channel) != ESP_OK)
+    {
+        return false;
+    }
+    /* Shared by all channels, may be installed already */
+    err = ledc_fade_func_install(0);
+    return err == ESP_OK || err == ESP_ERR_INVALID_STATE;
+}
+
+/**
+ * @brief LEDC backend, fade in hardware
+ *
+ * Before ESP-IDF v5.1 a fade cannot be stopped, the next duty change
+ * waits for it to finish with the bus lock held. Levels switch at once
+ * there.
+ * @param bl    backlight
+ * @param duty  target duty, 0 - LCD_BL_DUTY_MAX
+ * @param ms    fade time, 0 switches at once
+ * @return None
+ */
+static void lcdLedcFade(lcd_backlight_t *bl, uint32_t duty, uint32_t ms)
+{
+    ledc_channel_t channel = (ledc_channel_t)bl->config.channel;
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+    /* A new level replaces a fade in progress instead of waiting for it */
+    ledc_fade_stop(LCD_BL_MODE, channel);
+#else
+    ms = 0;
+#endif
+    if (ms == 0)
+    {
+        ledc_set_duty(LCD_BL_MODE, channel, duty);
+        ledc_update_duty(LCD_BL_MODE, channel);
+        return;
+    }
+    ledc_set_fade_with_time(LCD_BL_MODE, channel, duty, ms);
+    ledc_fade_start(LCD_BL_MODE, channel, LEDC_FADE_NO_WAIT);
+}
+
+/**
+ * @brief LEDC backend, output low
+ *
+ * @param bl    backlight
+ * @return None
+ */
+static void lcdLedcRelease(lcd_backlight_t *bl)
+{
+    ledc_stop(LCD_BL_MODE, (ledc_channel_t)bl->config.channel, 0);
+}
+
+/* LEDC backend, PWM and fades run without the CPU */
+static const lcd_pwm_t lcd_pwm_ledc = {
+    .init = lcdLedcInit,
+    .fade = lcdLedcFade,
+    .release = lcdLedcRelease,
+};
+
+/**
+ * @brief Brightness to duty, squared so steps look even to the eye
+ *
+ * @param level brightness, 0 - 255
+ * @return      duty, 0 - LCD_BL_DUTY_MAX
+ */
+static uint32_t lcdBacklightDuty(uint8_t level)
+{
+    return ((uint32_t)level * level * LCD_BL_DUTY_MAX + 255 * 255 / 2) / (255 * 255);
+}
+
+/**
+ * @brief Fade to brightness unless already there
+ *
+ * @param bl    backlight
+ * @param level brightness, 0 - 255
+ * @return None
+ */
+static void lcdBacklightFade(lcd_backlight_t *bl, uint8_t level)
+{
+    uint32_t duty = lcdBacklightDuty(level);
+    if (duty != bl->duty)
+    {
+        bl->duty = duty;
+        bl->pwm->fade(bl, duty, bl->config.fadeMs);
+    }
+}
+
+/**
+ * @brief Periodic idle check, dims after the idle timeout
+ *
+ * Runs in the esp_timer task. A busy bus means an update is going on,
+ * the check is skipped and the update wakes the backlight anyway.
+ * @param arg   backlight
+ * @return None
+ */
+static void lcdBacklightIdle(void *arg)
+{
+    lcd_backlight_t *bl = arg;
+    lcd_t *lcd = bl->lcd;
+
+    if (xSemaphoreTakeRecursive(lcd->lock, 0) != pdTRUE)
+    {
+        return;
+    }
+    if (lcd->backlight == bl && !bl->dimmed &&
+        esp_timer_get_time() - bl->last >= (int64_t)bl->config.idleMs * 1000)
+    {
+        bl->dimmed = true;
+        lcdBacklightFade(bl, bl->config.dim);
+        /* Nothing to check until the next wake */
+        esp_timer_stop(bl->idle);
+    }
+    xSemaphoreGiveRecursive(lcd->lock);
+}
+
+/**
+ * @brief Drive the backlight with LEDC
+ *
+ * The backlight fades to the on level. With an idle timeout it fades
+ * to the dim level once no update has been written for that long, and
+ * back on with the next update. @see lcdBacklightWake
+ * @param lcd       pointer to LCD object
+ * @param bl        backlight state, owned by the caller until lcdBacklightClose
+ * @param config    pin, LEDC timer and channel, levels and timing
+ * @note  LEDC fade functions are installed if not already. Fades need
+ *        ESP-IDF v5.1 or later, levels switch at once before.
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdBacklightOpen(lcd_t *const lcd, lcd_backlight_t *bl, const lcd_backlight_config_t *config)
+{
+    return lcdBacklightOpenPwm(lcd, bl, config, &lcd_pwm_ledc);
+}
+
+/**
+ * @brief Drive the backlight with a PWM backend
+ *
+ * @param lcd       pointer to LCD object
+ * @param bl        backlight state, owned by the caller until lcdBacklightClose
+ * @param config    levels and timing, pin, timer and channel for the backend
+ * @param pwm       PWM backend @see lcd_pwm_t
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdBacklightOpenPwm(lcd_t *const lcd, lcd_backlight_t *bl, const lcd_backlight_config_t *config, const lcd_pwm_t *pwm)
+{
+    esp_timer_create_args_t args = {
+        .callback = lcdBacklightIdle,
+        .arg = bl,
+        .name = "LCD backlight",
+    };
+
+    if (lcd->state != LCD_ACTIVE || lcd->lock == NULL || lcd->backlight != NULL)
+    {
+        return LCD_FAIL;
+    }
+    memset(bl, 0, sizeof(lcd_backlight_t));
+    bl->lcd = lcd;
+    bl->config = *config;
+    bl->pwm = pwm;
+
+    if (!pwm->init(bl))
+    {
+        ESP_LOGE(lcd_tag, "LCD backlight setup failed\n");
+        return LCD_FAIL;
+    }
+    if (config->idleMs > 0 && esp_timer_create(&args, &bl->idle) != ESP_OK)
+    {
+        if (pwm->release != NULL)
+        {
+            pwm->release(bl);
+        }
+        return LCD_FAIL;
+    }
+
+    /* Own the bus, updates wake the backlight from now on */
+    xSemaphoreTakeRecursive(lcd->lock, portMAX_DELAY);
+    bl->last = esp_timer_get_time();
+    lcdBacklightFade(bl, config->on);
+    if (bl->idle != NULL)
+    {
+        esp_timer_start_periodic(bl->idle, (uint64_t)config->idleMs * 1000 / LCD_BL_CHECKS);
+    }
+    lcd->backlight = bl;
+    xSemaphoreGiveRecursive(lcd->lock);
+    return LCD_OK;
+}
+
+/**
+ * @brief Set backlight brightness while active
+ *
+ * @param lcd   pointer to LCD object
+ * @param level brightness, 0 - 255
+ * @note  Counts as an update, a dimmed backlight wakes at the new level.
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdBacklightSet(lcd_t *const lcd, uint8_t level)
+{
+    lcd_backlight_t *bl;
+
+    if (lcd->lock == NULL)
+    {
+        return LCD_FAIL;
+    }
+
+    /* Own the bus */
+    xSemaphoreTakeRecursive(lcd->lock, portMAX_DELAY);
+
+    if ((bl = lcd->backlight) == NULL)
+    {
+        xSemaphoreGiveRecursive(lcd->lock);
+        return LCD_FAIL;
+    }
+    bl->config.on = level;
+    if (!bl->dimmed)
+    {
+        lcdBacklightFade(bl, level);
+    }
+    lcdBacklightWake(lcd);
+
+    xSemaphoreGiveRecursive(lcd->lock);
+    return LCD_OK;
+}
+
+/**
+ * @brief Restart the idle timeout, a dimmed backlight fades back on
+ *
+ * The driver calls this for every update. Call it on user input too,
+ * e.g. a button press on a screen that did not change.
+ * @param lcd   pointer to LCD object
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdBacklightWake(lcd_t *const lcd)
+{
+    lcd_backlight_t *bl;
+
+    if (lcd->lock == NULL)
+    {
+        return LCD_FAIL;
+    }
+
+    /* Own the bus, taken already when called by the driver */
+    xSemaphoreTakeRecursive(lcd->lock, portMAX_DELAY);
+
+    if ((bl = lcd->backlight) == NULL)
+    {
+        xSemaphoreGiveRecursive(lcd->lock);
+        return LCD_FAIL;
+    }
+    bl->last = esp_timer_get_time();
+    if (bl->dimmed)
+    {
+        bl->dimmed = false;
+        lcdBacklightFade(bl, bl->config.on);
+        esp_timer_start_periodic(bl->idle, (uint64_t)bl->config.idleMs * 1000 / LCD_BL_CHECKS);
+    }
+
+    xSemaphoreGiveRecursive(lcd->lock);
+    return LCD_OK;
+}
+
+/**
+ * @brief Stop driving the backlight
+ *
+ * @param lcd   pointer to LCD object
+ * @note  The backlight is switched off.
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdBacklightClose(lcd_t *const lcd)
+{
+    lcd_backlight_t *bl;
+
+    if (lcd->lock == NULL)
+    {
+        return LCD_FAIL;
+    }
+
+    /* Own the bus, the idle check skips while held */
+    xSemaphoreTakeRecursive(lcd->lock, portMAX_DELAY);
+
+    if ((bl = lcd->backlight) == NULL)
+    {
+        xSemaphoreGiveRecursive(lcd->lock);
+        return LCD_FAIL;
+    }
+    lcd->backlight = NULL;
+    if (bl->idle != NULL)
+    {
+        esp_timer_stop(bl->idle);
+        esp_timer_delete(bl->idle);
+        bl->idle = NULL;
+    }
+    if (bl->pwm->release != NULL)
+    {
+        bl->pwm->release(bl);
+    }
+
+    xSemaphoreGiveRecursive(lcd->lock);
+    return LCD_OK;
+}
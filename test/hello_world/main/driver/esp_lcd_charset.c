@@ -0,0 +1,363 @@
+/**
+ * @file esp_lcd_charset.c
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display character set source file
+ * @version 0.1
+ * @date 2022-08-15
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stddef.h>
+#include "esp_lcd.h"
+
+/******************************************************************
+ * Character ROM tables
+ *
+ * Code points are looked up through 256 entry pages indexed by the
+ * high byte, so mapping a character costs two table reads. A zero
+ * entry means the ROM has no matching glyph.
+ *******************************************************************/
+
+/* A00 (Japanese) Latin-1 page */
+static const uint8_t lcd_a00_page00[256] = {
+    [0xA2] = 0xEC, /* ¢ */
+    [0xA5] = 0x5C, /* ¥ */
+    [0xB0] = 0xDF, /* ° */
+    [0xB5] = 0xE4, /* µ */
+    [0xB7] = 0xA5, /* · */
+    [0xDF] = 0xE2, /* ß */
+    [0xE4] = 0xE1, /* ä */
+    [0xF1] = 0xEE, /* ñ */
+    [0xF6] = 0xEF, /* ö */
+    [0xF7] = 0xFD, /* ÷ */
+    [0xFC] = 0xF5, /* ü */
+};
+
+/* A00 (Japanese) Greek page */
+static const uint8_t lcd_a00_page03[256] = {
+    [0xA3] = 0xF6, /* Σ */
+    [0xA9] = 0xF4, /* Ω */
+    [0xB1] = 0xE0, /* α */
+    [0xB2] = 0xE2, /* β */
+    [0xB5] = 0xE3, /* ε */
+    [0xB8] = 0xF2, /* θ */
+    [0xBC] = 0xE4, /* μ */
+    [0xC0] = 0xF7, /* π */
+    [0xC1] = 0xE6, /* ρ */
+    [0xC3] = 0xE5, /* σ */
+};
+
+/* A00 (Japanese) letterlike symbols and arrows page */
+static const uint8_t lcd_a00_page21[256] = {
+    [0x26] = 0xF4, /* Ω */
+    [0x90] = 0x7F, /* ← */
+    [0x92] = 0x7E, /* → */
+};
+
+/* A00 (Japanese) mathematical operators page */
+static const uint8_t lcd_a00_page22[256] = {
+    [0x1A] = 0xE8, /* √ */
+    [0x1E] = 0xF3, /* ∞ */
+};
+
+/* A00 (Japanese) block elements page */
+static const uint8_t lcd_a00_page25[256] = {
+    [0x88] = 0xFF, /* █ */
+};
+
+/* A00 (Japanese) CJK punctuation page */
+static const uint8_t lcd_a00_page30[256] = {
+    [0x01] = 0xA4, /* 、 */
+    [0x02] = 0xA1, /* 。 */
+    [0x0C] = 0xA2, /* 「 */
+    [0x0D] = 0xA3, /* 」 */
+    [0xFB] = 0xA5, /* ・ */
+};
+
+/* A00 (Japanese) halfwidth katakana page, U+FF61 - U+FF9F */
+static const uint8_t lcd_a00_pageFF[256] = {
+    [0x61] = 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+    0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+    0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7,
+    0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+    0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+    0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+    0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7,
+    0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+};
+
+/* A02 (European) Latin-1 page, the upper half follows ISO 8859-1 */
+static const uint8_t lcd_a02_page00[256] = {
+    [0xA0] = 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+    0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+    0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7,
+    0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+    0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+    0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+    0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7,
+    0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+    0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7,
+    0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
+    0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7,
+    0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF,
+};
+
+/* A02 (European) Greek page */
+static const uint8_t lcd_a02_page03[256] = {
+    [0x93] = 0x92, /* Γ */
+    [0x98] = 0x99, /* Θ */
+    [0xA3] = 0x94, /* Σ */
+    [0xA9] = 0x9A, /* Ω */
+    [0xB1] = 0x90, /* α */
+    [0xB4] = 0x9B, /* δ */
+    [0xB5] = 0x9E, /* ε */
+    [0xC0] = 0x93, /* π */
+    [0xC3] = 0x95, /* σ */
+    [0xC4] = 0x97, /* τ */
+};
+
+/* A02 (European) Cyrillic capitals page */
+static const uint8_t lcd_a02_page04[256] = {
+    [0x10] = 'A',  0x80, 'B',  0x92, 0x81, 'E',  0x82, 0x83, /* А - З */
+    0x84, 0x85, 'K',  0x86, 'M',  'H',  'O',  0x87,          /* И - П */
+    'P',  'C',  'T',  0x88, 0x00, 'X',  0x89, 0x8A,          /* Р - Ч */
+    0x8B, 0x8C, 0x8D, 0x8E, 0x00, 0x8F,                      /* Ш - Э */
+};
+
+/* A02 (European) quotation marks page */
+static const uint8_t lcd_a02_page20[256] = {
+    [0x1C] = 0x12, /* “ */
+    [0x1D] = 0x13, /* ” */
+};
+
+/* A02 (European) letterlike symbols and arrows page */
+static const uint8_t lcd_a02_page21[256] = {
+    [0x26] = 0x9A, /* Ω */
+    [0x90] = 0x1B, /* ← */
+    [0x91] = 0x18, /* ↑ */
+    [0x92] = 0x1A, /* → */
+    [0x93] = 0x19, /* ↓ */
+    [0xB5] = 0x17, /* ↵ */
+};
+
+/* A02 (European) mathematical operators page */
+static const uint8_t lcd_a02_page22[256] = {
+    [0x1E] = 0x9C, /* ∞ */
+    [0x29] = 0x9F, /* ∩ */
+    [0x64] = 0x1C, /* ≤ */
+    [0x65] = 0x1D, /* ≥ */
+};
+
+/* A02 (European) geometric shapes page */
+static const uint8_t lcd_a02_page25[256] = {
+    [0xB2] = 0x1E, /* ▲ */
+    [0xB6] = 0x10, /* ▶ */
+    [0xBC] = 0x1F, /* ▼ */
+    [0xC0] = 0x11, /* ◀ */
+    [0xCF] = 0x16, /* ● */
+};
+
+/* A02 (European) miscellaneous symbols page */
+static const uint8_t lcd_a02_page26[256] = {
+    [0x65] = 0x9D, /* ♥ */
+    [0x6A] = 0x91, /* ♪ */
+};
+
+/* A00 (Japanese) pages, indexed by code point high byte */
+static const uint8_t *const lcd_a00_pages[256] = {
+    [0x00] = lcd_a00_page00,
+    [0x03] = lcd_a00_page03,
+    [0x21] = lcd_a00_page21,
+    [0x22] = lcd_a00_page22,
+    [0x25] = lcd_a00_page25,
+    [0x30] = lcd_a00_page30,
+    [0xFF] = lcd_a00_pageFF,
+};
+
+/* A02 (European) pages, indexed by code point high byte */
+static const uint8_t *const lcd_a02_pages[256] = {
+    [0x00] = lcd_a02_page00,
+    [0x03] = lcd_a02_page03,
+    [0x04] = lcd_a02_page04,
+    [0x20] = lcd_a02_page20,
+    [0x21] = lcd_a02_page21,
+    [0x22] = lcd_a02_page22,
+    [0x25] = lcd_a02_page25,
+    [0x26] = lcd_a02_page26,
+};
+
+/******************************************************************
+ * Fallback glyphs
+ *
+ * 5x8 bitmaps loaded into CGRAM for characters missing from the ROM,
+ * sorted by code point.
+ *******************************************************************/
+typedef struct
+{
+    uint16_t code;                      /*!< Code point */
+    uint8_t bitmap[LCD_GLYPH_ROWS];     /*!< Glyph rows */
+} lcd_fallback_t;
+
+static const lcd_fallback_t lcd_fallback[] = {
+    {0x005C, {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00}}, /* \ */
+    {0x007E, {0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00, 0x00}}, /* ~ */
+    {0x00A1, {0x04, 0x00, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00}}, /* ¡ */
+    {0x00A3, {0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x1F, 0x00}}, /* £ */
+    {0x00A7, {0x0E, 0x10, 0x0E, 0x11, 0x0E, 0x01, 0x0E, 0x00}}, /* § */
+    {0x00B1, {0x04, 0x04, 0x1F, 0x04, 0x04, 0x00, 0x1F, 0x00}}, /* ± */
+    {0x00B2, {0x0C, 0x02, 0x04, 0x08, 0x0E, 0x00, 0x00, 0x00}}, /* ² */
+    {0x00B3, {0x0C, 0x02, 0x0C, 0x02, 0x0C, 0x00, 0x00, 0x00}}, /* ³ */
+    {0x00BF, {0x04, 0x00, 0x04, 0x08, 0x10, 0x11, 0x0E, 0x00}}, /* ¿ */
+    {0x00C4, {0x0A, 0x00, 0x0E, 0x11, 0x1F, 0x11, 0x11, 0x00}}, /* Ä */
+    {0x00C5, {0x04, 0x0A, 0x04, 0x0E, 0x11, 0x1F, 0x11, 0x00}}, /* Å */
+    {0x00C9, {0x02, 0x04, 0x1F, 0x10, 0x1E, 0x10, 0x1F, 0x00}}, /* É */
+    {0x00D6, {0x0A, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00}}, /* Ö */
+    {0x00DC, {0x0A, 0x00, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00}}, /* Ü */
+    {0x00E0, {0x08, 0x04, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00}}, /* à */
+    {0x00E1, {0x02, 0x04, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00}}, /* á */
+    {0x00E2, {0x04, 0x0A, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00}}, /* â */
+    {0x00E5, {0x04, 0x0A, 0x04, 0x0E, 0x01, 0x0F, 0x11, 0x0F}}, /* å */
+    {0x00E7, {0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E, 0x04, 0x08}}, /* ç */
+    {0x00E8, {0x08, 0x04, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00}}, /* è */
+    {0x00E9, {0x02, 0x04, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00}}, /* é */
+    {0x00EA, {0x04, 0x0A, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00}}, /* ê */
+    {0x00EB, {0x0A, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00}}, /* ë */
+    {0x00ED, {0x02, 0x04, 0x0C, 0x04, 0x04, 0x04, 0x0E, 0x00}}, /* í */
+    {0x00EE, {0x04, 0x0A, 0x0C, 0x04, 0x04, 0x04, 0x0E, 0x00}}, /* î */
+    {0x00F3, {0x02, 0x04, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00}}, /* ó */
+    {0x00F4, {0x04, 0x0A, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00}}, /* ô */
+    {0x00F8, {0x00, 0x01, 0x0E, 0x13, 0x15, 0x19, 0x0E, 0x10}}, /* ø */
+    {0x00F9, {0x08, 0x04, 0x11, 0x11, 0x11, 0x13, 0x0D, 0x00}}, /* ù */
+    {0x00FA, {0x02, 0x04, 0x11, 0x11, 0x11, 0x13, 0x0D, 0x00}}, /* ú */
+    {0x20AC, {0x07, 0x08, 0x1E, 0x08, 0x1E, 0x08, 0x07, 0x00}}, /* € */
+    {0x2191, {0x04, 0x0E, 0x15, 0x04, 0x04, 0x04, 0x04, 0x00}}, /* ↑ */
+    {0x2193, {0x04, 0x04, 0x04, 0x04, 0x15, 0x0E, 0x04, 0x00}}, /* ↓ */
+};
+
+/**
+ * @brief Decode next UTF-8 character
+ *
+ * @param text  pointer to text, advanced past the character
+ * @param end   end of text, NULL if text is NUL terminated
+ * @return      code point, LCD_UTF8_INVALID for malformed input
+ */
+uint32_t lcdUtf8Decode(const char **text, const char *end)
+{
+    const uint8_t *p = (const uint8_t *)*text;
+    size_t avail = end != NULL ? (size_t)(end - *text) : 4;
+    uint32_t code;
+    size_t i, extra;
+
+    /* Lead byte */
+    if (p[0] < 0x80)
+    {
+        *text += 1;
+        return p[0];
+    }
+    else if ((p[0] & 0xE0) == 0xC0)
+    {
+        code = p[0] & 0x1F;
+        extra = 1;
+    }
+    else if ((p[0] & 0xF0) == 0xE0)
+    {
+        code = p[0] & 0x0F;
+        extra = 2;
+    }
+    else if ((p[0] & 0xF8) == 0xF0)
+    {
+        code = p[0] & 0x07;
+        extra = 3;
+    }
+    else
+    {
+        *text += 1;
+        return LCD_UTF8_INVALID;
+    }
+
+    /* Continuation bytes, a NUL terminator is never one */
+    for (i = 1; i <= extra; i++)
+    {
+        if (i >= avail || (p[i] & 0xC0) != 0x80)
+        {
+            *text += i;
+            return LCD_UTF8_INVALID;
+        }
+        code = (code << 6) | (p[i] & 0x3F);
+    }
+
+    *text += extra + 1;
+    return code;
+}
+
+/**
+ * @brief Map code point to character ROM
+ *
+ * @param charset   character ROM @see lcd_charset_t
+ * @param code      code point
+ * @return          character code, 0 if the ROM has no glyph for it
+ */
+uint8_t lcdCharsetMap(lcd_charset_t charset, uint32_t code)
+{
+    const uint8_t *const *pages;
+
+    /* ASCII and CGRAM codes, A00 has ¥ and → in place of \ and ~ */
+    if (code < 0x80)
+    {
+        if (charset == LCD_CHARSET_A00 && (code == '\\' || code == '~'))
+        {
+            return 0;
+        }
+        return code;
+    }
+
+    switch (charset)
+    {
+    case LCD_CHARSET_A00:
+        pages = lcd_a00_pages;
+        break;
+    case LCD_CHARSET_A02:
+        pages = lcd_a02_pages;
+        break;
+    default:
+        return code < 0x100 ? code : 0;
+    }
+
+    if (code > 0xFFFF || pages[code >> 8] == NULL)
+    {
+        return 0;
+    }
+    return pages[code >> 8][code & 0xFF];
+}
+
+/**
+ * @brief Get fallback glyph for a code point missing from the ROM
+ *
+ * @param code  code point
+ * @return      glyph rows, NULL if there is no fallback glyph
+ */
+const uint8_t *lcdCharsetGlyph(uint32_t code)
+{
+    int lo = 0, hi = sizeof(lcd_fallback) / sizeof(lcd_fallback[0]) - 1;
+
+    /* Binary search, only reached for characters missing from the ROM */
+    while (lo <= hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (lcd_fallback[mid].code == code)
+        {
+            return lcd_fallback[mid].bitmap;
+        }
+        if (lcd_fallback[mid].code < code)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,524 @@
+/**
+ * @file esp_lcd_ui.c
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display widget source file
+ * @version 0.1
+ * @date 2022-08-15
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_lcd.h"
+
+#define LCD_UI_ROW (LCD_COLS * 4) /*!< Widget row in bytes, UTF-8 takes up to 4 per cell */
+
+/**
+ * @brief Bytes of text fitting in a number of cells
+ *
+ * @param lcd   pointer to LCD object
+ * @param text  NUL terminated text
+ * @param cells cells available, set to cells used
+ * @return      bytes
+ */
+static size_t lcdUiFit(const lcd_t *lcd, const char *text, int *cells)
+{
+    const char *p = text;
+    int used = 0;
+
+    /* One cell per byte, else per UTF-8 character */
+    while (*p != '\0' && used < *cells)
+    {
+        if (lcd->charset == LCD_CHARSET_RAW)
+        {
+            p++;
+        }
+        else
+        {
+            lcdUtf8Decode(&p, NULL);
+        }
+        used++;
+    }
+    *cells = used;
+    return (size_t)(p - text);
+}
+
+/**
+ * @brief Number text, right aligned so digits stay in place
+ *
+ * @param lcd   pointer to LCD object
+ * @param w     number widget
+ * @param buf   row, LCD_UI_ROW bytes
+ * @return      bytes
+ */
+static size_t lcdUiNumberRow(const lcd_t *lcd, const lcd_widget_t *w, char *buf)
+{
+    const char *unit = w->text != NULL ? w->text : "";
+    char num[12];
+    int digits = snprintf(num, sizeof(num), "%ld", (long)w->value);
+    int cells = w->width - digits;
+    int pad;
+    size_t len;
+
+    len = cells >= 0 ? lcdUiFit(lcd, unit, &cells) : 0;
+    if (cells < 0 || unit[len] != '\0')
+    {
+        /* Clipped digits would show a wrong value */
+        memset(buf, LCD_UI_OVERFLOW, w->width);
+        return w->width;
+    }
+    pad = w->width - digits - cells;
+    memset(buf, ' ', pad);
+    memcpy(buf + pad, num, digits);
+    memcpy(buf + pad + digits, unit, len);
+    return pad + digits + len;
+}
+
+/**
+ * @brief List row, selection cursor, item and scroll indicator
+ *
+ * @param lcd   pointer to LCD object
+ * @param w     list widget
+ * @param row   row in the widget
+ * @param buf   row, LCD_UI_ROW bytes
+ * @return      bytes
+ */
+static size_t lcdUiListRow(const lcd_t *lcd, const lcd_widget_t *w, int row, char *buf)
+{
+    int item = w->top + row;
+    int cells = w->width - 2;
+    char mark = ' ';
+    size_t len = 0;
+
+    buf[0] = (item < w->count && item == w->value) ? LCD_UI_CURSOR : ' ';
+    if (item < w->count && w->items[item] != NULL)
+    {
+        len = lcdUiFit(lcd, w->items[item], &cells);
+        memcpy(buf + 1, w->items[item], len);
+    }
+    else
+    {
+        cells = 0;
+    }
+    memset(buf + 1 + len, ' ', w->width - 2 - cells);
+    len += w->width - 2 - cells;
+
+    if (row == 0 && w->top > 0)
+    {
+        mark = LCD_UI_MORE_UP;
+    }
+    if (row == w->rows - 1 && w->top + w->rows < w->count)
+    {
+        mark = LCD_UI_MORE_DOWN;
+    }
+    buf[1 + len] = mark;
+    return len + 2;
+}
+
+/**
+ * @brief Write widget to the shadow screen
+ *
+ * @param ui    screen
+ * @param w     widget
+ * @return None
+ */
+static void lcdUiDraw(lcd_ui_t *ui, lcd_widget_t *w)
+{
+    char buf[LCD_UI_ROW];
+    const char *text;
+    size_t len;
+    int row, cells;
+
+    for (row = 0; row < w->rows; row++)
+    {
+        switch (w->kind)
+        {
+        case LCD_UI_NUMBER:
+            len = lcdUiNumberRow(ui->lcd, w, buf);
+            break;
+        case LCD_UI_LIST:
+            len = lcdUiListRow(ui->lcd, w, row, buf);
+            break;
+        default:
+            /* Label, padded so old text is overwritten */
+            text = w->text != NULL ? w->text : "";
+            cells = w->width;
+            len = lcdUiFit(ui->lcd, text, &cells);
+            memcpy(buf, text, len);
+            memset(buf + len, ' ', w->width - cells);
+            len += w->width - cells;
+            break;
+        }
+        lcdWrite(ui->lcd, buf, len, w->x, w->y + row);
+    }
+    w->dirty = false;
+}
+
+/**
+ * @brief Keep the list selection in view
+ *
+ * @param w     list widget
+ * @return None
+ */
+static void lcdUiScroll(lcd_widget_t *w)
+{
+    if (w->value < w->top)
+    {
+        w->top = w->value;
+    }
+    else if (w->value >= w->top + w->rows)
+    {
+        w->top = w->value - w->rows + 1;
+    }
+}
+
+/**
+ * @brief Set widget value within its range
+ *
+ * @param w     widget
+ * @param value number value or list item
+ * @return None
+ */
+static void lcdUiClamp(lcd_widget_t *w, int32_t value)
+{
+    if (value > w->max)
+    {
+        value = w->max;
+    }
+    if (value < w->min)
+    {
+        value = w->min;
+    }
+    if (value != w->value)
+    {
+        w->value = value;
+        w->dirty = true;
+    }
+    if (w->kind == LCD_UI_LIST)
+    {
+        lcdUiScroll(w);
+    }
+}
+
+/**
+ * @brief Add widget to the screen
+ *
+ * @param ui    screen
+ * @param w     widget, cleared
+ * @param kind  widget kind
+ * @param x     left column
+ * @param y     top row
+ * @param width width in cells
+ * @param rows  height in rows
+ * @return      lcd error status @see lcd_err_t
+ */
+static lcd_err_t lcdUiAdd(lcd_ui_t *ui, lcd_widget_t *w, lcd_ui_kind_t kind, int x, int y, int width, int rows)
+{
+    lcd_widget_t **link = &ui->first;
+
+    if (ui->lcd == NULL || x < 0 || y < 0 || width < 1 || rows < 1 ||
+        x + width > LCD_COLS || y + rows > LCD_ROWS)
+    {
+        return LCD_FAIL;
+    }
+    memset(w, 0, sizeof(lcd_widget_t));
+    w->kind = kind;
+    w->x = x;
+    w->y = y;
+    w->width = width;
+    w->rows = rows;
+    w->dirty = true;
+
+    while (*link != NULL)
+    {
+        link = &(*link)->next;
+    }
+    *link = w;
+    return LCD_OK;
+}
+
+/**
+ * @brief Start an empty screen of widgets
+ *
+ * Widgets keep their text, redraws only write the widgets that changed
+ * and of those only the cells that changed, in one transaction. Replaces
+ * lcdClear and lcdSetText for every key press, which flickers and
+ * rewrites the whole display.
+ * @param ui    screen, owned by the caller
+ * @param lcd   pointer to LCD object
+ * @note  A screen is used by one task, widgets must not overlap.
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdUiInit(lcd_ui_t *ui, lcd_t *const lcd)
+{
+    if (lcd == NULL)
+    {
+        return LCD_FAIL;
+    }
+    memset(ui, 0, sizeof(lcd_ui_t));
+    ui->lcd = lcd;
+    return LCD_OK;
+}
+
+/**
+ * @brief Add label
+ *
+ * @param ui    screen
+ * @param w     widget, owned by the caller
+ * @param x     left column
+ * @param y     row
+ * @param width width in cells, longer text is cut
+ * @param text  text, kept by reference, NULL blank
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdUiLabel(lcd_ui_t *ui, lcd_widget_t *w, int x, int y, int width, const char *text)
+{
+    if (lcdUiAdd(ui, w, LCD_UI_LABEL, x, y, width, 1) != LCD_OK)
+    {
+        return LCD_FAIL;
+    }
+    w->text = text;
+    return LCD_OK;
+}
+
+/**
+ * @brief Add numeric field
+ *
+ * Up and down keys step the value within range, starting at min with
+ * a step of 1. The value is right aligned and followed by the unit, a
+ * value too wide for the field shows as LCD_UI_OVERFLOW.
+ * @param ui    screen
+ * @param w     widget, owned by the caller
+ * @param x     left column
+ * @param y     row
+ * @param width width in cells
+ * @param min   lowest value
+ * @param max   highest value
+ * @param unit  unit after the value, kept by reference, NULL none
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdUiNumber(lcd_ui_t *ui, lcd_widget_t *w, int x, int y, int width, int32_t min, int32_t max, const char *unit)
+{
+    if (min > max || lcdUiAdd(ui, w, LCD_UI_NUMBER, x, y, width, 1) != LCD_OK)
+    {
+        return LCD_FAIL;
+    }
+    w->text = unit;
+    w->value = min;
+    w->min = min;
+    w->max = max;
+    w->step = 1;
+    return LCD_OK;
+}
+
+/**
+ * @brief Add list with selection cursor
+ *
+ * The first column shows LCD_UI_CURSOR on the selected item, the last
+ * one LCD_UI_MORE_UP and LCD_UI_MORE_DOWN when items are scrolled out
+ * of view. Up and down keys move the selection, the list scrolls along.
+ * @param ui    screen
+ * @param w     widget, owned by the caller
+ * @param x     left column
+ * @param y     top row
+ * @param width width in cells, at least 3
+ * @param rows  rows shown
+ * @param items item text, kept by reference
+ * @param count number of items, up to 255
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdUiList(lcd_ui_t *ui, lcd_widget_t *w, int x, int y, int width, int rows, const char *const *items, int count)
+{
+    if (width < 3 || count < 0 || count > UINT8_MAX || lcdUiAdd(ui, w, LCD_UI_LIST, x, y, width, rows) != LCD_OK)
+    {
+        return LCD_FAIL;
+    }
+    w->items = items;
+    w->count = count;
+    w->max = count > 0 ? count - 1 : 0;
+    w->step = 1;
+    return LCD_OK;
+}
+
+/**
+ * @brief Change label text or number unit
+ *
+ * @param ui    screen
+ * @param w     label or number widget
+ * @param text  text, kept by reference, NULL blank
+ * @note  Call after changing text in place too, the widget is redrawn.
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdUiSetText(lcd_ui_t *ui, lcd_widget_t *w, const char *text)
+{
+    if (w->kind == LCD_UI_LIST)
+    {
+        return LCD_FAIL;
+    }
+    w->text = text;
+    w->dirty = true;
+    return LCD_OK;
+}
+
+/**
+ * @brief Change number value or list selection
+ *
+ * @param ui    screen
+ * @param w     number or list widget
+ * @param value value, limited to the range, or item index
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdUiSetValue(lcd_ui_t *ui, lcd_widget_t *w, int32_t value)
+{
+    if (w->kind == LCD_UI_LABEL)
+    {
+        return LCD_FAIL;
+    }
+    lcdUiClamp(w, value);
+    return LCD_OK;
+}
+
+/**
+ * @brief Set key hook of a widget
+ *
+ * @param ui    screen
+ * @param w     widget
+ * @param hook  called after the focused widget handled a key, NULL none
+ * @param arg   hook argument
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdUiSetHook(lcd_ui_t *ui, lcd_widget_t *w, lcd_ui_hook_t hook, void *arg)
+{
+    w->hook = hook;
+    w->arg = arg;
+    return LCD_OK;
+}
+
+/**
+ * @brief Send keys to a widget
+ *
+ * @param ui    screen
+ * @param w     widget, NULL none
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdUiFocus(lcd_ui_t *ui, lcd_widget_t *w)
+{
+    ui->focus = w;
+    return LCD_OK;
+}
+
+/**
+ * @brief Handle key on the focused widget and redraw
+ *
+ * Numbers step up and down, lists move the selection. The hook runs
+ * next and may change any widget or the focus, e.g. open a sub menu on
+ * LCD_UI_KEY_OK, then the changed widgets are redrawn together.
+ * @param ui    screen
+ * @param key   key pressed @see lcd_ui_key_t
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdUiInput(lcd_ui_t *ui, lcd_ui_key_t key)
+{
+    lcd_widget_t *w = ui->focus;
+    int32_t step;
+
+    if (w == NULL)
+    {
+        return LCD_FAIL;
+    }
+    if (w->kind != LCD_UI_LABEL && (key == LCD_UI_KEY_UP || key == LCD_UI_KEY_DOWN))
+    {
+        /* Up raises a number, moves a list toward its first item */
+        step = (key == LCD_UI_KEY_UP) == (w->kind == LCD_UI_NUMBER) ? w->step : -w->step;
+        lcdUiSetValue(ui, w, w->value + step);
+    }
+    if (w->hook != NULL)
+    {
+        w->hook(w, key, w->arg);
+    }
+    return lcdUiRender(ui);
+}
+
+/**
+ * @brief Handle encoder rotation on the focused widget and redraw
+ *
+ * @param ui    screen
+ * @param steps detents, positive clockwise raises a number and moves
+ *              down a list
+ * @note  The hook runs once per detent.
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdUiRotate(lcd_ui_t *ui, int steps)
+{
+    lcd_widget_t *w = ui->focus;
+    lcd_ui_key_t key;
+
+    if (w == NULL)
+    {
+        return LCD_FAIL;
+    }
+    if ((steps > 0) == (w->kind == LCD_UI_NUMBER))
+    {
+        key = LCD_UI_KEY_UP;
+    }
+    else
+    {
+        key = LCD_UI_KEY_DOWN;
+    }
+    /* Keys move the widget, one redraw for all detents */
+    lcdBegin(ui->lcd);
+    for (; steps != 0; steps += steps > 0 ? -1 : 1)
+    {
+        lcdUiInput(ui, key);
+        if (ui->focus != w)
+        {
+            break;
+        }
+    }
+    return lcdCommit(ui->lcd);
+}
+
+/**
+ * @brief Redraw changed widgets
+ *
+ * @param ui    screen
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdUiRender(lcd_ui_t *ui)
+{
+    lcd_widget_t *w;
+
+    lcdBegin(ui->lcd);
+    for (w = ui->first; w != NULL; w = w->next)
+    {
+        if (w->dirty)
+        {
+            lcdUiDraw(ui, w);
+        }
+    }
+    return lcdCommit(ui->lcd);
+}
+
+/**
+ * @brief Show the screen, replacing whatever the display showed
+ *
+ * Switching menus clears and draws in one transaction, the commit only
+ * clears the display when that beats rewriting the changed cells.
+ * @param ui    screen
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdUiShow(lcd_ui_t *ui)
+{
+    lcd_widget_t *w;
+
+    lcdBegin(ui->lcd);
+    lcdClear(ui->lcd);
+    for (w = ui->first; w != NULL; w = w->next)
+    {
+        w->dirty = true;
+    }
+    lcdUiRender(ui);
+    return lcdCommit(ui->lcd);
+}
@@ -0,0 +1,165 @@
+/**
+ * @file dedic.c
+ * @brief Dedicated GPIO bundles
+ *
+ * A bundle drives its pins from the core that created it, writes from
+ * the other core are lost. Pins stay routed to the bundle until
+ * gpio_set_direction or gpio_reset_pin hands them back to GPIO, a
+ * bundle out signal connected to a pin takes it back.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "driver/dedic_gpio.h"
+#include "esp_rom_gpio.h"
+#include "soc/dedic_gpio_periph.h"
+#include "sim.h"
+#include "sim_dedic.h"
+
+struct dedic_gpio_bundle_t
+{
+    int pins[8];
+    int count;
+    int core;
+    int offset;
+    uint32_t out;
+};
+
+/* Out signal of channel c on core n is SIM_DEDIC_SIG + n * 8 + c */
+#define SIM_DEDIC_SIG 1000
+#define SIM_DEDIC_SIGS(n) { SIM_DEDIC_SIG + (n) * 8, SIM_DEDIC_SIG + (n) * 8 + 1, SIM_DEDIC_SIG + (n) * 8 + 2, \
+    SIM_DEDIC_SIG + (n) * 8 + 3, SIM_DEDIC_SIG + (n) * 8 + 4, SIM_DEDIC_SIG + (n) * 8 + 5, \
+    SIM_DEDIC_SIG + (n) * 8 + 6, SIM_DEDIC_SIG + (n) * 8 + 7 }
+
+const dedic_gpio_signal_conn_t dedic_gpio_sig_info = {
+    .cores = {
+        { .out_sig_per_channel = SIM_DEDIC_SIGS(0) },
+        { .out_sig_per_channel = SIM_DEDIC_SIGS(1) },
+    },
+};
+
+sim_dedic_t simDedic;
+
+/* Live bundles, channels in use per core */
+static struct dedic_gpio_bundle_t *live[SOC_CPU_CORES_NUM * SOC_DEDIC_GPIO_OUT_CHANNELS_NUM + 1];
+static uint32_t used[SOC_CPU_CORES_NUM];
+
+void simDedicReset(void)
+{
+    memset(&simDedic, 0, sizeof(simDedic));
+    memset(live, 0, sizeof(live));
+    memset(used, 0, sizeof(used));
+}
+
+esp_err_t dedic_gpio_new_bundle(const dedic_gpio_bundle_config_t *config, dedic_gpio_bundle_handle_t *out)
+{
+    struct dedic_gpio_bundle_t *bundle;
+    uint32_t mask = (1u << config->array_size) - 1;
+    int offset;
+    size_t i;
+
+    /* Contiguous channels on the calling core */
+    for (offset = 0; offset + config->array_size <= SOC_DEDIC_GPIO_OUT_CHANNELS_NUM; offset++)
+    {
+        if (!(used[simCore] & (mask << offset)))
+        {
+            break;
+        }
+    }
+    if (simDedic.full || offset + config->array_size > SOC_DEDIC_GPIO_OUT_CHANNELS_NUM)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    bundle = calloc(1, sizeof(*bundle));
+    bundle->count = config->array_size;
+    bundle->core = simCore;
+    bundle->offset = offset;
+    used[simCore] |= mask << offset;
+    for (i = 0; live[i] != NULL; i++)
+    {
+    }
+    live[i] = bundle;
+    for (i = 0; i < config->array_size; i++)
+    {
+        bundle->pins[i] = config->gpio_array[i];
+        simRoute(bundle->pins[i], bundle);
+    }
+    simDedic.bundles++;
+    simDedic.created++;
+    simDedic.lastCore = simCore;
+    *out = bundle;
+    return ESP_OK;
+}
+
+esp_err_t dedic_gpio_del_bundle(dedic_gpio_bundle_handle_t bundle)
+{
+    int i;
+    /* Channels are freed, pads keep their routing */
+    for (i = 0; i < bundle->count; i++)
+    {
+        if (simRouted(bundle->pins[i]) == bundle)
+        {
+            simRoute(bundle->pins[i], &simDedic);
+        }
+    }
+    for (i = 0; live[i] != bundle; i++)
+    {
+    }
+    for (; live[i] != NULL; i++)
+    {
+        live[i] = live[i + 1];
+    }
+    used[bundle->core] &= ~(((1u << bundle->count) - 1) << bundle->offset);
+    free(bundle);
+    simDedic.bundles--;
+    return ESP_OK;
+}
+
+esp_err_t dedic_gpio_get_out_mask(dedic_gpio_bundle_handle_t bundle, uint32_t *mask)
+{
+    *mask = ((1u << bundle->count) - 1) << bundle->offset;
+    return ESP_OK;
+}
+
+void esp_rom_gpio_connect_out_signal(uint32_t gpio_num, uint32_t signal_idx, bool out_inv, bool oen_inv)
+{
+    int channel = (int)signal_idx - SIM_DEDIC_SIG;
+    int i, bit;
+
+    /* GPIO output register or another peripheral, the fake drives a
+       channel only on the pad the bundle was created with */
+    simRoute(gpio_num, NULL);
+    for (i = 0; live[i] != NULL; i++)
+    {
+        bit = channel - live[i]->core * 8 - live[i]->offset;
+        if (bit >= 0 && bit < live[i]->count && live[i]->pins[bit] == (int)gpio_num)
+        {
+            simRoute(gpio_num, live[i]);
+        }
+    }
+}
+
+void dedic_gpio_bundle_write(dedic_gpio_bundle_handle_t bundle, uint32_t mask, uint32_t value)
+{
+    int i;
+
+    if (bundle->core != simCore)
+    {
+        simDedic.lost++;
+        return;
+    }
+    if (simDedic.count < SIM_DEDIC_LOG)
+    {
+        simDedic.log[simDedic.count].mask = mask;
+        simDedic.log[simDedic.count].value = value;
+        simDedic.log[simDedic.count].cycles = simCycles();
+        simDedic.count++;
+    }
+    bundle->out = (bundle->out & ~mask) | (value & mask);
+    for (i = 0; i < bundle->count; i++)
+    {
+        if ((mask & (1u << i)) && simRouted(bundle->pins[i]) == bundle)
+        {
+            simPad(bundle->pins[i], (bundle->out >> i) & 1);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * @file hc595.c
+ * @brief 74HC595 on an SPI bus
+ *
+ * SER shifts in MSB first on SRCLK, the outputs follow the register
+ * when CS (RCLK) rises at the end of the transaction. Wired like
+ * LCD_SPI_595_MAP, QA - QD D4 - D7, QE RS, QG EN, QH backlight.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "driver/spi_master.h"
+#include "sim.h"
+#include "sim_spi.h"
+
+/* Model pin of each register output, -1 when not wired */
+static const int qPin[8] = {19, 18, 17, 16, 23, -1, 22, -1};
+
+sim_spi_t simSpi;
+
+struct spi_device_t
+{
+    int unused;
+};
+
+void simSpiReset(void)
+{
+    memset(&simSpi, 0, sizeof(simSpi));
+}
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t *config, int dma)
+{
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host)
+{
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t *config,
+                             spi_device_handle_t *handle)
+{
+    *handle = calloc(1, sizeof(**handle));
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle)
+{
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t dev, spi_transaction_t *trans, TickType_t wait)
+{
+    const uint8_t *tx = (trans->flags & SPI_TRANS_USE_TXDATA) ? trans->tx_data : trans->tx_buffer;
+    uint8_t shift = 0;
+    int bit, i;
+
+    /* Shift in MSB first */
+    for (bit = 0; bit < (int)trans->length; bit++)
+    {
+        shift = (shift << 1) | ((tx[bit / 8] >> (7 - bit % 8)) & 1);
+    }
+
+    /* Latch, EN last so data is set up */
+    for (i = 0; i < 8; i++)
+    {
+        if (i != 6)
+        {
+            simPad(qPin[i], (shift >> i) & 1);
+        }
+    }
+    simPad(qPin[6], (shift >> 6) & 1);
+    if (simSpi.count < SIM_SPI_LOG)
+    {
+        simSpi.log[simSpi.count++] = shift;
+    }
+
+    if (++simSpi.pending > simSpi.maxPending)
+    {
+        simSpi.maxPending = simSpi.pending;
+    }
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t dev, spi_transaction_t **trans, TickType_t wait)
+{
+    if (simSpi.pending == 0)
+    {
+        /* Would wait forever */
+        sim.deadlock++;
+        return ESP_ERR_TIMEOUT;
+    }
+    simSpi.pending--;
+    return ESP_OK;
+}
@@ -0,0 +1,323 @@
+/**
+ * @file hd44780.c
+ * @brief HD44780 model driven through the GPIO driver
+ *
+ * Latches nibbles on the falling edge of EN like the controller does,
+ * executes instructions and data writes against DDRAM and CGRAM, and
+ * answers reads with the busy flag and address counter or RAM data.
+ */
+#include <string.h>
+#include "driver/gpio.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#include "sim.h"
+
+sim_t sim;
+int simFailures;
+
+static int level[64];               /* pad levels */
+static const void *route[64];       /* peripheral owning each pad, NULL for GPIO */
+
+/**
+ * @brief Back to power on with the lcdDefault wiring
+ */
+void simReset(void)
+{
+    memset(&sim, 0, sizeof(sim));
+    memset(level, 0, sizeof(level));
+    memset(route, 0, sizeof(route));
+    memset(sim.ddram, ' ', sizeof(sim.ddram));
+    sim.d[0] = 19;
+    sim.d[1] = 18;
+    sim.d[2] = 17;
+    sim.d[3] = 16;
+    sim.en = 22;
+    sim.rs = 23;
+    sim.rw = -1;
+}
+
+/**
+ * @brief Step address counter like the controller, DDRAM wraps per line
+ */
+static void simStep(void)
+{
+    if (sim.cg)
+    {
+        sim.ac = (sim.ac + 1) & 63;
+    }
+    else
+    {
+        sim.ac = sim.ac == 0x27 ? 0x40 : sim.ac == 0x67 ? 0 : (sim.ac + 1) & 127;
+    }
+}
+
+/**
+ * @brief Execute an instruction or data write
+ */
+static void simExec(int rs, uint8_t v)
+{
+    if (sim.busy)
+    {
+        sim.busyUntil = sim.us + (!rs && v <= 3 ? 1520 : 37);
+    }
+    if (rs)
+    {
+        if (sim.cg)
+        {
+            sim.cgram[sim.ac & 63] = v;
+        }
+        else
+        {
+            sim.ddram[sim.ac & 127] = v;
+        }
+        simStep();
+        sim.datas++;
+        return;
+    }
+    sim.cmds++;
+    if (v & 0x80)
+    {
+        sim.cg = 0;
+        sim.ac = v & 0x7F;
+    }
+    else if (v & 0x40)
+    {
+        sim.cg = 1;
+        sim.ac = v & 0x3F;
+    }
+    else if (v & 0x20)
+    {
+        sim.four = !(v & 0x10);
+    }
+    else if (v & 0x08)
+    {
+        sim.display = v;
+    }
+    else if (v == 0x01)
+    {
+        memset(sim.ddram, ' ', sizeof(sim.ddram));
+        sim.ac = 0;
+        sim.cg = 0;
+    }
+}
+
+/**
+ * @brief Byte a read returns, busy flag and address counter or RAM
+ */
+static uint8_t simRead(int rs)
+{
+    uint8_t v;
+
+    if (!rs)
+    {
+        return (sim.ac & 0x7F) | (sim.busy && sim.us < sim.busyUntil ? 0x80 : 0);
+    }
+    v = sim.cg ? sim.cgram[sim.ac & 63] : sim.ddram[sim.ac & 127];
+    simStep();
+    return v;
+}
+
+static int simNibble(void)
+{
+    int n = 0, i;
+    for (i = 0; i < 4; i++)
+    {
+        n |= (level[sim.d[i]] & 1) << i;
+    }
+    return n;
+}
+
+/**
+ * @brief Drive a pad, the LCD sees the change
+ */
+void simPad(int pin, int l)
+{
+    int old, rw;
+
+    if (pin < 0 || pin >= 64)
+    {
+        return;
+    }
+    old = level[pin];
+    level[pin] = l & 1;
+    sim.edges++;
+    rw = sim.rw >= 0 && level[sim.rw];
+
+    if ((pin == sim.rs || pin == sim.rw) && old != level[pin])
+    {
+        sim.rsSet = simCycles();
+    }
+
+    if (pin == sim.en && old && !level[pin])
+    {
+        /* Falling edge latches, a pulse shorter than the LCD needs is missed */
+        if (sim.dropNext || (sim.pulseNs > 0 && (simCycles() - sim.enRise) * 1000 / 240 < sim.pulseNs))
+        {
+            sim.dropNext = false;
+        }
+        else if (rw)
+        {
+            sim.half ^= 1;
+        }
+        else if (!sim.four)
+        {
+            simExec(level[sim.rs], simNibble() << 4);
+            sim.half = 0;
+        }
+        else if (!sim.half)
+        {
+            sim.hi = simNibble();
+            sim.half = 1;
+        }
+        else
+        {
+            sim.half = 0;
+            simExec(level[sim.rs], (sim.hi << 4) | simNibble());
+        }
+    }
+    else if (pin == sim.en && !old && level[pin] && !rw)
+    {
+        /* RS set up too late, the strobe is missed */
+        if (sim.setupNs > 0 && (simCycles() - sim.rsSet) * 1000 / 240 < sim.setupNs)
+        {
+            sim.dropNext = true;
+        }
+        sim.enRise = simCycles();
+    }
+    else if (pin == sim.en && !old && level[pin] && rw)
+    {
+        /* Rising edge of a read puts the byte on the bus */
+        if (sim.busy)
+        {
+            sim.us++;
+        }
+        if (!sim.half)
+        {
+            sim.rdval = simRead(level[sim.rs]);
+        }
+    }
+}
+
+/**
+ * @brief Level on a pad, D4 - D7 are driven by the LCD while reading
+ */
+int simPadLevel(int pin)
+{
+    int i;
+    for (i = 0; i < 4; i++)
+    {
+        if (sim.d[i] == pin && sim.rw >= 0 && level[sim.rw])
+        {
+            uint8_t n = sim.half ? sim.rdval & 15 : sim.rdval >> 4;
+            if (sim.corruptRead)
+            {
+                n ^= 1;
+            }
+            return (n >> i) & 1;
+        }
+    }
+    return pin >= 0 && pin < 64 ? level[pin] : 0;
+}
+
+void simRoute(int pin, const void *owner)
+{
+    if (pin >= 0 && pin < 64)
+    {
+        route[pin] = owner;
+    }
+}
+
+const void *simRouted(int pin)
+{
+    return pin >= 0 && pin < 64 ? route[pin] : NULL;
+}
+
+void simScreen(char out[2][17])
+{
+    int r, c;
+    for (r = 0; r < 2; r++)
+    {
+        for (c = 0; c < 16; c++)
+        {
+            out[r][c] = sim.ddram[r * 0x40 + c];
+        }
+        out[r][16] = '\0';
+    }
+}
+
+/* GPIO driver */
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t l)
+{
+    if (pin < 0)
+    {
+        return ESP_FAIL;
+    }
+    /* The GPIO output register does not reach a pad routed elsewhere */
+    if (simRouted(pin) == NULL)
+    {
+        simPad(pin, l);
+    }
+    return ESP_OK;
+}
+
+/* GPIO output set and clear registers, one bank of 32 pads each */
+void simRegWrite(uint32_t reg, uint32_t value)
+{
+    int bank = reg == GPIO_OUT1_W1TS_REG || reg == GPIO_OUT1_W1TC_REG ? 32 : 0;
+    int set = reg == GPIO_OUT_W1TS_REG || reg == GPIO_OUT1_W1TS_REG;
+    int i;
+
+    for (i = 0; i < 32; i++)
+    {
+        if ((value & (1UL << i)) && simRouted(bank + i) == NULL)
+        {
+            simPad(bank + i, set);
+        }
+    }
+}
+
+int gpio_get_level(gpio_num_t pin)
+{
+    return simPadLevel(pin);
+}
+
+esp_err_t gpio_set_direction(gpio_num_t pin, gpio_mode_t mode)
+{
+    /* Like IDF, routes the pad back to the GPIO output register */
+    simRoute(pin, NULL);
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t pin)
+{
+    simRoute(pin, NULL);
+    return ESP_OK;
+}
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+    return ESP_OK;
+}
+
+void esp_rom_gpio_pad_select_gpio(uint32_t pin)
+{
+}
+
+void gpio_pad_select_gpio(uint32_t pin)
+{
+}
+
+/* Time passes only when the driver waits */
+void esp_rom_delay_us(uint32_t us)
+{
+    sim.us += us;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    sim.ticks += ticks;
+    sim.us += ticks * portTICK_PERIOD_MS * 1000;
+}
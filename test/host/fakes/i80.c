@@ -0,0 +1,74 @@
+/**
+ * @file i80.c
+ * @brief I80 LCD peripheral stand-in
+ *
+ * Plays each transmitted sample onto the data GPIOs of the bus, one
+ * sample per PCLK, and completes the transfer at once.
+ */
+#include <stdlib.h>
+#include "esp_lcd_panel_io.h"
+#include "sim.h"
+
+struct esp_lcd_i80_bus_t
+{
+    int pins[8];
+};
+
+struct esp_lcd_panel_io_t
+{
+    struct esp_lcd_i80_bus_t *bus;
+    esp_lcd_panel_io_i80_config_t config;
+};
+
+unsigned long simI80Tx, simI80Bytes;
+
+esp_err_t esp_lcd_new_i80_bus(const esp_lcd_i80_bus_config_t *config, esp_lcd_i80_bus_handle_t *handle)
+{
+    int i;
+    *handle = calloc(1, sizeof(**handle));
+    for (i = 0; i < 8; i++)
+    {
+        (*handle)->pins[i] = config->data_gpio_nums[i];
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_del_i80_bus(esp_lcd_i80_bus_handle_t handle)
+{
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_new_panel_io_i80(esp_lcd_i80_bus_handle_t bus, const esp_lcd_panel_io_i80_config_t *config,
+                                   esp_lcd_panel_io_handle_t *handle)
+{
+    *handle = calloc(1, sizeof(**handle));
+    (*handle)->bus = bus;
+    (*handle)->config = *config;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t handle)
+{
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int cmd, const void *buf, size_t len)
+{
+    const uint8_t *samples = buf;
+    size_t n;
+    int i;
+
+    simI80Tx++;
+    simI80Bytes += len;
+    for (n = 0; n < len; n++)
+    {
+        for (i = 0; i < 8; i++)
+        {
+            simPad(io->bus->pins[i], (samples[n] >> i) & 1);
+        }
+    }
+    io->config.on_color_trans_done(io, NULL, io->config.user_ctx);
+    return ESP_OK;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file ledc.c
+ * @brief LEDC stand-in keeping the last duty
+ *
+ * A hardware fade runs for its time on the sim clock. Before ESP-IDF
+ * v5.1 duty changes wait for it, those are counted as blocked.
+ */
+#include "driver/ledc.h"
+#include "sim.h"
+
+int simLedcDuty = -1, simLedcFades, simLedcStops, simLedcInstalls, simLedcBlocked;
+static unsigned long fadeUntil, fadeUs;
+
+/**
+ * @brief Duty change, waits out a fade in flight
+ */
+static void simLedcWait(void)
+{
+    if (sim.us < fadeUntil)
+    {
+        simLedcBlocked++;
+        sim.us = fadeUntil;
+    }
+}
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *config)
+{
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *config)
+{
+    simLedcDuty = config->duty;
+    fadeUntil = 0;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_func_install(int flags)
+{
+    return simLedcInstalls++ ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
+
+esp_err_t ledc_fade_stop(ledc_mode_t mode, ledc_channel_t channel)
+{
+    fadeUntil = 0;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty)
+{
+    simLedcWait();
+    simLedcDuty = duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t channel)
+{
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty, int ms)
+{
+    simLedcWait();
+    simLedcDuty = duty;
+    simLedcFades++;
+    fadeUs = (unsigned long)ms * 1000;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t channel, ledc_fade_mode_t wait)
+{
+    fadeUntil = sim.us + fadeUs;
+    return ESP_OK;
+}
+
+esp_err_t ledc_stop(ledc_mode_t mode, ledc_channel_t channel, uint32_t idle)
+{
+    simLedcStops++;
+    simLedcDuty = 0;
+    fadeUntil = 0;
+    return ESP_OK;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file nvs.c
+ * @brief NVS stand-in holding a single blob
+ */
+#include <stdbool.h>
+#include <string.h>
+#include "nvs.h"
+
+bool simNvsReady = true;
+char simNvsKey[NVS_KEY_NAME_MAX_SIZE];
+uint8_t simNvsBlob[64];
+size_t simNvsLen;
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *handle)
+{
+    *handle = 1;
+    return simNvsReady ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out, size_t *len)
+{
+    if (simNvsLen == 0 || strcmp(key, simNvsKey) != 0 || *len < simNvsLen)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    memcpy(out, simNvsBlob, simNvsLen);
+    *len = simNvsLen;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *val, size_t len)
+{
+    if (len > sizeof(simNvsBlob))
+    {
+        return ESP_FAIL;
+    }
+    strncpy(simNvsKey, key, sizeof(simNvsKey) - 1);
+    memcpy(simNvsBlob, val, len);
+    simNvsLen = len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+}
@@ -0,0 +1,250 @@
+/**
+ * @file pcf8574.c
+ * @brief PCF8574 expander on an I2C bus, both I2C driver APIs
+ *
+ * Wired like the common backpack, P0 RS, P1 R/W, P2 EN, P3 backlight,
+ * P4 - P7 D4 - D7. Every byte on the bus is kept in simI2C so tests
+ * can decode what the driver sent.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "driver/i2c.h"
+#include "driver/i2c_master.h"
+#include "sim.h"
+#include "sim_i2c.h"
+
+/* Model pin of each expander pin, -1 for the backlight */
+static const int pcfPin[8] = {23, 21, 22, -1, 19, 18, 17, 16};
+
+sim_i2c_t simI2C;
+
+void simI2CReset(void)
+{
+    memset(&simI2C, 0, sizeof(simI2C));
+}
+
+static void simI2CLog(uint8_t byte, bool read)
+{
+    if (simI2C.count < SIM_I2C_LOG)
+    {
+        simI2C.log[simI2C.count].byte = byte;
+        simI2C.log[simI2C.count].read = read;
+        simI2C.log[simI2C.count].batch = simI2C.batches;
+        simI2C.count++;
+    }
+}
+
+/* Expander output latch to the pins. All pins change together, EN
+ * rising with RS or R/W gives no address setup time, the LCD misses
+ * that strobe. */
+static void pcfWrite(uint8_t byte)
+{
+    int i;
+    if (!simPadLevel(pcfPin[2]) && (byte & 0x04) &&
+        (simPadLevel(pcfPin[0]) != (byte & 1) || simPadLevel(pcfPin[1]) != ((byte >> 1) & 1)))
+    {
+        simI2C.tas++;
+        sim.dropNext = true;
+    }
+    for (i = 0; i < 8; i++)
+    {
+        if (i != 2)
+        {
+            simPad(pcfPin[i], (byte >> i) & 1);
+        }
+    }
+    simPad(pcfPin[2], (byte >> 2) & 1);
+    simI2CLog(byte, false);
+}
+
+static uint8_t pcfRead(void)
+{
+    uint8_t byte = 0;
+    int i;
+    for (i = 0; i < 8; i++)
+    {
+        if (pcfPin[i] >= 0)
+        {
+            byte |= (simPadLevel(pcfPin[i]) & 1) << i;
+        }
+    }
+    simI2CLog(byte, true);
+    return byte;
+}
+
+/* Transaction start, false when the expander does not acknowledge */
+static bool pcfAck(void)
+{
+    if (simI2C.nack > 0 && simI2C.nackAfter > 0)
+    {
+        simI2C.nackAfter--;
+    }
+    else if (simI2C.nack > 0)
+    {
+        simI2C.nack--;
+        return false;
+    }
+    simI2C.batches++;
+    return true;
+}
+
+/* I2C master driver, ESP-IDF v5.2 and later */
+struct i2c_master_bus_t
+{
+    int unused;
+};
+
+struct i2c_master_dev_t
+{
+    int unused;
+};
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *config, i2c_master_bus_handle_t *handle)
+{
+    *handle = calloc(1, sizeof(**handle));
+    return ESP_OK;
+}
+
+esp_err_t i2c_del_master_bus(i2c_master_bus_handle_t handle)
+{
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus, const i2c_device_config_t *config,
+                                    i2c_master_dev_handle_t *handle)
+{
+    simI2C.addr = config->device_address;
+    *handle = calloc(1, sizeof(**handle));
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t handle)
+{
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t dev, const uint8_t *buf, size_t len, int timeout)
+{
+    size_t i;
+    if (!pcfAck())
+    {
+        return ESP_FAIL;
+    }
+    for (i = 0; i < len; i++)
+    {
+        pcfWrite(buf[i]);
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_receive(i2c_master_dev_handle_t dev, uint8_t *buf, size_t len, int timeout)
+{
+    size_t i;
+    if (!pcfAck())
+    {
+        return ESP_FAIL;
+    }
+    for (i = 0; i < len; i++)
+    {
+        buf[i] = pcfRead();
+    }
+    return ESP_OK;
+}
+
+/* Legacy I2C driver, command links run on i2c_master_cmd_begin */
+typedef struct
+{
+    int count;
+    struct
+    {
+        bool read;
+        uint8_t byte;
+        uint8_t *dst;
+    } ops[256];
+} sim_i2c_cmd_t;
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *config)
+{
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode, size_t rx, size_t tx, int flags)
+{
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t port)
+{
+    return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create(void)
+{
+    return calloc(1, sizeof(sim_i2c_cmd_t));
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd)
+{
+    free(cmd);
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd)
+{
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd)
+{
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t byte, bool ack)
+{
+    /* Address byte */
+    simI2C.addr = byte >> 1;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t handle, const uint8_t *buf, size_t len, bool ack)
+{
+    sim_i2c_cmd_t *cmd = handle;
+    size_t i;
+    for (i = 0; i < len; i++)
+    {
+        cmd->ops[cmd->count].read = false;
+        cmd->ops[cmd->count++].byte = buf[i];
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t handle, uint8_t *dst, i2c_ack_type_t ack)
+{
+    sim_i2c_cmd_t *cmd = handle;
+    cmd->ops[cmd->count].read = true;
+    cmd->ops[cmd->count++].dst = dst;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t handle, TickType_t wait)
+{
+    sim_i2c_cmd_t *cmd = handle;
+    int i;
+    if (!pcfAck())
+    {
+        return ESP_FAIL;
+    }
+    for (i = 0; i < cmd->count; i++)
+    {
+        if (cmd->ops[i].read)
+        {
+            *cmd->ops[i].dst = pcfRead();
+        }
+        else
+        {
+            pcfWrite(cmd->ops[i].byte);
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,250 @@
+/**
+ * @file rtos.c
+ * @brief FreeRTOS, esp_timer clock, CPU and heap stand-ins
+ *
+ * Single threaded. Locks count, the render task runs on demand from
+ * simRender until it waits for a notification.
+ */
+#include <setjmp.h>
+#include <stdlib.h>
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "hal/cpu_hal.h"
+#include "sim.h"
+
+/******************************************************************
+ * \struct sim_sem_t rtos.c
+ * \brief Semaphore, count for binary ones, depth for recursive ones
+ *******************************************************************/
+typedef struct
+{
+    int count;
+} sim_sem_t;
+
+bool simLockBusy;
+int simLockDeletedHeld;
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutexStatic(StaticSemaphore_t *buffer)
+{
+    sim_sem_t *sem = (sim_sem_t *)buffer;
+    sem->count = 0;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer)
+{
+    return xSemaphoreCreateRecursiveMutexStatic(buffer);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return calloc(1, sizeof(sim_sem_t));
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t handle, TickType_t wait)
+{
+    if (wait == 0 && simLockBusy)
+    {
+        return pdFALSE;
+    }
+    ((sim_sem_t *)handle)->count++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t handle)
+{
+    ((sim_sem_t *)handle)->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t handle, TickType_t wait)
+{
+    sim_sem_t *sem = handle;
+    if (sem->count == 0)
+    {
+        /* Nobody else could give it */
+        sim.deadlock++;
+        return pdFALSE;
+    }
+    sem->count = 0;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t handle)
+{
+    ((sim_sem_t *)handle)->count = 1;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t handle, BaseType_t *woken)
+{
+    return xSemaphoreGive(handle);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t handle)
+{
+    if (((sim_sem_t *)handle)->count > 0)
+    {
+        simLockDeletedHeld++;
+    }
+}
+
+void *xSemaphoreGetMutexHolder(SemaphoreHandle_t handle)
+{
+    return ((sim_sem_t *)handle)->count > 0 ? xTaskGetCurrentTaskHandle() : NULL;
+}
+
+void vPortEnterCritical(portMUX_TYPE *mux)
+{
+}
+
+void vPortExitCritical(portMUX_TYPE *mux)
+{
+}
+
+/* Render task, one at a time */
+int simCore;
+int simPinned = -2;
+static TaskFunction_t taskFn;
+static void *taskArg;
+static int notified, alive;
+static jmp_buf waiting;
+
+BaseType_t xPortGetCoreID(void)
+{
+    return simCore;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    simPinned = core;
+    taskFn = fn;
+    taskArg = arg;
+    alive = 1;
+    notified = 0;
+    *handle = (TaskHandle_t)&taskFn;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t handle)
+{
+    alive = 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle)
+{
+    notified++;
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait)
+{
+    uint32_t n = notified;
+    if (n == 0)
+    {
+        /* Task blocks, back to simRender */
+        longjmp(waiting, 1);
+    }
+    notified = 0;
+    return n;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    /* One task, the test */
+    return (TaskHandle_t)&simCore;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return sim.ticks;
+}
+
+int simRender(void)
+{
+    if (!alive)
+    {
+        return -1;
+    }
+    if (!setjmp(waiting))
+    {
+        taskFn(taskArg);
+    }
+    return notified;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return sim.us;
+}
+
+/* Cycle counter at 240 MHz, advances a little on every read */
+static uint32_t cycles;
+
+uint32_t esp_cpu_get_cycle_count(void)
+{
+    return cycles += 7;
+}
+
+uint32_t simCycles(void)
+{
+    return cycles;
+}
+
+uint32_t esp_rom_get_cpu_ticks_per_us(void)
+{
+    return 240;
+}
+
+uint32_t cpu_hal_get_cycle_count(void)
+{
+    return esp_cpu_get_cycle_count();
+}
+
+void *heap_caps_malloc(size_t size, unsigned caps)
+{
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, unsigned caps)
+{
+    return calloc(n, size);
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+static vprintf_like_t logSink = vprintf;
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t sink)
+{
+    vprintf_like_t old = logSink;
+    logSink = sink;
+    return old;
+}
+
+int simLog(const char *format, ...)
+{
+    va_list args;
+    int ret;
+
+    va_start(args, format);
+    ret = logSink(format, args);
+    va_end(args);
+    return ret;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file sim.h
+ * @brief Host simulation of the LCD and the ESP-IDF peripherals it sits on
+ *
+ * The HD44780 model listens to GPIO pins. Bus fakes (I80, I2C expander,
+ * shift register, dedicated GPIO) turn their traffic into pin changes,
+ * so every backend ends up on the same model and counters.
+ */
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+/******************************************************************
+ * \struct sim_t sim.h
+ * \brief HD44780 model state and bus counters
+ *******************************************************************/
+typedef struct
+{
+    int d[4], en, rs, rw;           /* pins wired to D4 - D7, EN, RS, R/W, -1 not wired */
+    uint8_t ddram[128];             /* display data RAM, by address */
+    uint8_t cgram[64];              /* character generator RAM */
+    uint8_t ac, cg;                 /* address counter, 1 while it points into CGRAM */
+    uint8_t four, half, hi;         /* 4-bit mode, second nibble pending, first nibble */
+    uint8_t display;                /* last display control command */
+    uint8_t rdval;                  /* byte latched for the read in progress */
+    bool dropNext;                  /* swallow the next EN strobe */
+    bool corruptRead;               /* flip D4 on reads */
+    bool busy;                      /* model execution time on the busy flag */
+    uint32_t pulseNs;               /* shortest EN pulse latched, 0 takes any */
+    uint32_t enRise;                /* CPU cycle count at the EN rising edge */
+    uint32_t setupNs;               /* shortest RS and R/W set up before EN rises, 0 takes any */
+    uint32_t rsSet;                 /* CPU cycle count of the last RS or R/W change */
+    unsigned long busyUntil;        /* busy flag clears at this time */
+    unsigned long edges;            /* pin changes */
+    unsigned long cmds, datas;      /* instructions and data bytes executed */
+    unsigned long deadlock;         /* waits that would never return */
+    unsigned long ticks, us;        /* time slept in ticks, time waited in microseconds */
+} sim_t;
+
+extern sim_t sim;
+
+/* Test results */
+extern int simFailures;
+
+#define CHECK(cond)                                                            \
+    do                                                                         \
+    {                                                                          \
+        if (!(cond))                                                           \
+        {                                                                      \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);    \
+            simFailures++;                                                     \
+        }                                                                      \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                         \
+    do                                                                         \
+    {                                                                          \
+        long long a_ = (long long)(a), b_ = (long long)(b);                    \
+        if (a_ != b_)                                                          \
+        {                                                                      \
+            printf("%s:%d: CHECK_EQ(%s, %s) failed, %lld != %lld\n",           \
+                   __FILE__, __LINE__, #a, #b, a_, b_);                        \
+            simFailures++;                                                     \
+        }                                                                      \
+    } while (0)
+
+#define CHECK_STR(a, b)                                                        \
+    do                                                                         \
+    {                                                                          \
+        if (strcmp((a), (b)) != 0)                                             \
+        {                                                                      \
+            printf("%s:%d: CHECK_STR(%s, %s) failed, \"%s\" != \"%s\"\n",      \
+                   __FILE__, __LINE__, #a, #b, (a), (b));                      \
+            simFailures++;                                                     \
+        }                                                                      \
+    } while (0)
+
+/* Exit status of a test program */
+#define SIM_RESULT() (simFailures == 0 ? 0 : 1)
+
+/* HD44780 model, default wiring of lcdDefault */
+void simReset(void);
+void simScreen(char out[2][17]);
+void simPad(int pin, int level);
+int simPadLevel(int pin);
+
+/* GPIO matrix, a pin routed to a peripheral ignores gpio_set_level */
+void simRoute(int pin, const void *owner);
+const void *simRouted(int pin);
+
+/* CPU cycle counter, without advancing it */
+uint32_t simCycles(void);
+
+/* Render task, runs it until it waits, -1 when there is none */
+extern int simCore;
+extern int simPinned;
+int simRender(void);
+
+/* esp_log output, through the hook set by esp_log_set_vprintf */
+int simLog(const char *format, ...);
+
+/* esp_timer, fires the newest running timer */
+extern int simTimers;
+void simTimerFire(void);
+
+/* Recursive lock, try-takes fail while set, locks deleted while taken */
+extern bool simLockBusy;
+extern int simLockDeletedHeld;
+
+/* LEDC, last duty, fades started, duty changes that waited for a fade */
+extern int simLedcDuty, simLedcFades, simLedcStops, simLedcInstalls, simLedcBlocked;
+
+/* NVS, opens while ready, holds one blob under its key */
+extern bool simNvsReady;
+extern char simNvsKey[];
+extern size_t simNvsLen;
+
+/* VFS, the registered device, a write through it and its file mode */
+extern char simVfsPath[32];
+ssize_t simVfsWrite(const char *text);
+int simVfsMode(void);
@@ -0,0 +1,33 @@
+/**
+ * @file sim_dedic.h
+ * @brief Dedicated GPIO stand-in, bundle writes
+ */
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SIM_DEDIC_LOG 4096  /* writes kept */
+
+/******************************************************************
+ * \struct sim_dedic_t sim_dedic.h
+ * \brief Bundles and the writes that reached their pins
+ *******************************************************************/
+typedef struct
+{
+    struct
+    {
+        uint32_t mask;      /* bundle bits written */
+        uint32_t value;     /* bundle bits */
+        uint32_t cycles;    /* CPU cycle count of the write */
+    } log[SIM_DEDIC_LOG];
+    int count;              /* writes logged */
+    int bundles;            /* bundles alive */
+    int created;            /* bundles ever created */
+    int lastCore;           /* core of the newest bundle */
+    int lost;               /* writes from a core not owning the bundle */
+    bool full;              /* no free channels */
+} sim_dedic_t;
+
+extern sim_dedic_t simDedic;
+
+void simDedicReset(void);
@@ -0,0 +1,34 @@
+/**
+ * @file sim_i2c.h
+ * @brief PCF8574 expander stand-in, bus log
+ */
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define SIM_I2C_LOG 4096    /* bytes kept */
+
+/******************************************************************
+ * \struct sim_i2c_t sim_i2c.h
+ * \brief Expander bytes in bus order
+ *******************************************************************/
+typedef struct
+{
+    struct
+    {
+        uint8_t byte;       /* expander pins written or read */
+        bool read;          /* byte was read from the expander */
+        int batch;          /* transaction it belongs to, from 1 */
+    } log[SIM_I2C_LOG];
+    int count;              /* bytes logged */
+    int batches;            /* acknowledged transactions */
+    int nack;               /* transactions left to refuse */
+    int nackAfter;          /* transactions acknowledged before refusing */
+    int tas;                /* EN rose in the byte changing RS or R/W, strobe missed */
+    uint16_t addr;          /* last device address */
+} sim_i2c_t;
+
+extern sim_i2c_t simI2C;
+
+void simI2CReset(void);
@@ -0,0 +1,24 @@
+/**
+ * @file sim_spi.h
+ * @brief 74HC595 shift register stand-in, latched states
+ */
+#pragma once
+#include <stdint.h>
+
+#define SIM_SPI_LOG 4096    /* states kept */
+
+/******************************************************************
+ * \struct sim_spi_t sim_spi.h
+ * \brief Register outputs in latch order, bit 0 QA - bit 7 QH
+ *******************************************************************/
+typedef struct
+{
+    uint8_t log[SIM_SPI_LOG];   /* outputs after each latch */
+    int count;                  /* latches */
+    int pending;                /* transactions queued, not collected */
+    int maxPending;             /* deepest queue seen */
+} sim_spi_t;
+
+extern sim_spi_t simSpi;
+
+void simSpiReset(void);
@@ -0,0 +1,73 @@
+/**
+ * @file timer.c
+ * @brief esp_timer stand-in, timers fire when the test says so
+ */
+#include <stdlib.h>
+#include "esp_timer.h"
+#include "sim.h"
+
+struct esp_timer
+{
+    esp_timer_cb_t callback;
+    void *arg;
+    uint64_t period;
+    bool running;
+};
+
+int simTimers;
+static struct esp_timer *newest;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out)
+{
+    struct esp_timer *timer = calloc(1, sizeof(*timer));
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+    *out = newest = timer;
+    simTimers++;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    if (timer->running)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->period = period;
+    timer->running = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout)
+{
+    return esp_timer_start_periodic(timer, timeout);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (!timer->running)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->running = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    if (newest == timer)
+    {
+        newest = NULL;
+    }
+    free(timer);
+    simTimers--;
+    return ESP_OK;
+}
+
+void simTimerFire(void)
+{
+    if (newest != NULL && newest->running)
+    {
+        newest->callback(newest->arg);
+    }
+}
@@ -0,0 +1,38 @@
+/**
+ * @file vfs.c
+ * @brief VFS stand-in keeping the registered device
+ */
+#include <string.h>
+#include "esp_vfs.h"
+
+esp_vfs_t simVfs;
+void *simVfsCtx;
+char simVfsPath[32];
+
+esp_err_t esp_vfs_register(const char *path, const esp_vfs_t *vfs, void *ctx)
+{
+    simVfs = *vfs;
+    simVfsCtx = ctx;
+    strncpy(simVfsPath, path, sizeof(simVfsPath) - 1);
+    return ESP_OK;
+}
+
+esp_err_t esp_vfs_unregister(const char *path)
+{
+    simVfsPath[0] = '\0';
+    return ESP_OK;
+}
+
+ssize_t simVfsWrite(const char *text)
+{
+    int fd = simVfs.open_p(simVfsCtx, "/", 0, 0);
+    ssize_t n = simVfs.write_p(simVfsCtx, fd, text, strlen(text));
+    simVfs.close_p(simVfsCtx, fd);
+    return n;
+}
+
+int simVfsMode(void)
+{
+    struct stat st;
+    return simVfs.fstat_p(simVfsCtx, 0, &st) == 0 ? (int)st.st_mode : -1;
+}
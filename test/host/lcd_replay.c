@@ -0,0 +1,113 @@
+/**
+ * @file lcd_replay.c
+ * @brief Replay API call records and report the LCD bus cost
+ *
+ *   lcd_replay workload.lcdr [-v]
+ *   lcd_replay before.lcdr after.lcdr
+ *
+ * Run through tools/lcd_replay.py, which builds it.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "replay.h"
+
+static uint8_t *readFile(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *data = NULL;
+    long size;
+
+    if (f == NULL)
+    {
+        return NULL;
+    }
+    if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) >= 0 && fseek(f, 0, SEEK_SET) == 0)
+    {
+        data = malloc(size ? size : 1);
+        *len = fread(data, 1, size, f);
+    }
+    fclose(f);
+    return data;
+}
+
+static void report(const char *path, const replay_report_t *rep)
+{
+    uint32_t calls = 0;
+    double busUs = rep->busNs / 1000.0;
+    const char *sep = "";
+    int op;
+
+    for (op = 0; op < REPLAY_OPS; op++)
+    {
+        calls += rep->calls[op];
+    }
+    printf("%s:\n  calls      %u (", path, calls);
+    for (op = 0; op < REPLAY_OPS; op++)
+    {
+        if (rep->calls[op] > 0)
+        {
+            printf("%s%s %u", sep, replayOpName(op), rep->calls[op]);
+            sep = ", ";
+        }
+    }
+    printf(")\n  recorded   %.3f s\n", rep->wallUs / 1e6);
+    printf("  bus bytes  %u (%u commands, %u data)\n", rep->cmds + rep->datas, rep->cmds, rep->datas);
+    printf("  bus time   %.3f ms, %.2f %% of recorded time\n", busUs / 1000.0,
+           rep->wallUs ? 100.0 * busUs / rep->wallUs : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    replay_report_t reports[2];
+    int i, count = 0, verbose = 0;
+
+    for (i = 1; i < argc; i++)
+    {
+        verbose |= strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0;
+    }
+    for (i = 1; i < argc; i++)
+    {
+        replay_report_t rep;
+        const char *error;
+        uint8_t *data;
+        size_t len = 0;
+        lcd_t lcd;
+
+        if (argv[i][0] == '-')
+        {
+            continue;
+        }
+        if ((data = readFile(argv[i], &len)) == NULL)
+        {
+            fprintf(stderr, "%s: cannot read\n", argv[i]);
+            return 1;
+        }
+        error = replayRun(&lcd, data, len, &rep, verbose ? stdout : NULL);
+        free(data);
+        if (error != NULL)
+        {
+            fprintf(stderr, "%s: %s\n", argv[i], error);
+            return 1;
+        }
+        lcdFree(&lcd);
+        report(argv[i], &rep);
+        if (count < 2)
+        {
+            reports[count] = rep;
+        }
+        count++;
+    }
+    if (count == 0)
+    {
+        fprintf(stderr, "usage: %s records... [-v]\n", argv[0]);
+        return 2;
+    }
+
+    if (count == 2)
+    {
+        printf("bus time %+.3f ms, bus bytes %+lld\n",
+               ((double)reports[1].busNs - (double)reports[0].busNs) / 1e6,
+               (long long)(reports[1].cmds + reports[1].datas) - (long long)(reports[0].cmds + reports[0].datas));
+    }
+    return 0;
+}
@@ -0,0 +1,339 @@
+/**
+ * @file replay.c
+ * @brief Replay of an API call record through the driver
+ *
+ * Every recorded call is made again on the driver built for the host,
+ * so the report follows the driver code, nothing models it on the side.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "replay.h"
+
+/******************************************************************
+ * \struct replay_reader_t replay.c
+ * \brief Cursor over the record bytes
+ *******************************************************************/
+typedef struct
+{
+    const uint8_t *data;
+    size_t len, pos;
+    bool truncated;
+} replay_reader_t;
+
+/* Counting bus, one LCD object at a time */
+static replay_report_t *counted;
+static uint8_t half;
+
+static void replayBusWrite(lcd_t *const lcd, uint8_t lines, uint32_t us)
+{
+    /* Two nibbles a byte, each with an enable pulse */
+    counted->busNs += 2 * lcd->timing.pulseNs + (uint64_t)us * 1000;
+    if (half)
+    {
+        if (lines & LCD_LINE_RS)
+        {
+            counted->datas++;
+        }
+        else
+        {
+            counted->cmds++;
+        }
+    }
+    half ^= 1;
+}
+
+static int replayBusRead(lcd_t *const lcd, uint8_t lines)
+{
+    /* Write only */
+    return -1;
+}
+
+static const lcd_bus_t replay_bus = {
+    .write = replayBusWrite,
+    .read = replayBusRead,
+};
+
+static const char *const op_names[REPLAY_OPS] = {
+    [LCD_RECORD_TEXT] = "text",
+    [LCD_RECORD_INT] = "int",
+    [LCD_RECORD_SPANS] = "spans",
+    [LCD_RECORD_PLAY] = "play",
+    [LCD_RECORD_CLEAR] = "clear",
+    [LCD_RECORD_GLYPH] = "glyph",
+    [LCD_RECORD_CHARSET] = "charset",
+    [LCD_RECORD_BEGIN] = "begin",
+    [LCD_RECORD_COMMIT] = "commit",
+    [LCD_RECORD_REGION_OPEN] = "region-open",
+    [LCD_RECORD_REGION_TEXT] = "region-text",
+    [LCD_RECORD_REGION_CLEAR] = "region-clear",
+    [LCD_RECORD_REGION_SHOW] = "region-show",
+    [LCD_RECORD_REGION_CLOSE] = "region-close",
+    [LCD_RECORD_REGION_LANE] = "region-lane",
+    [LCD_RECORD_RING] = "ring",
+};
+
+const char *replayOpName(int op)
+{
+    return op > 0 && op < REPLAY_OPS ? op_names[op] : NULL;
+}
+
+static const uint8_t *readBytes(replay_reader_t *r, size_t n)
+{
+    const uint8_t *p = r->data + r->pos;
+    if (r->truncated || n > r->len - r->pos)
+    {
+        r->truncated = true;
+        return NULL;
+    }
+    r->pos += n;
+    return p;
+}
+
+static uint8_t readByte(replay_reader_t *r)
+{
+    const uint8_t *p = readBytes(r, 1);
+    return p != NULL ? *p : 0;
+}
+
+static uint64_t readVarint(replay_reader_t *r)
+{
+    uint64_t value = 0;
+    int shift = 0;
+    uint8_t b;
+
+    do
+    {
+        b = readByte(r);
+        if (shift < 64)
+        {
+            value |= (uint64_t)(b & 0x7F) << shift;
+        }
+        shift += 7;
+    } while ((b & 0x80) && !r->truncated);
+    return value;
+}
+
+static int32_t readInt(replay_reader_t *r)
+{
+    uint32_t v = readVarint(r);
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+/* Text of a record, NUL terminated copy in buf */
+static const char *readText(replay_reader_t *r, char **buf, size_t *len)
+{
+    const uint8_t *p;
+
+    *len = readVarint(r);
+    if ((p = readBytes(r, *len)) == NULL)
+    {
+        return NULL;
+    }
+    free(*buf);
+    *buf = malloc(*len + 1);
+    memcpy(*buf, p, *len);
+    (*buf)[*len] = '\0';
+    return *buf;
+}
+
+/* Region handle of the replay for a recorded one */
+static lcd_region_t replayRegion(const lcd_region_t *regions, uint64_t recorded)
+{
+    return recorded < LCD_MAX_REGIONS ? regions[recorded] : -1;
+}
+
+const char *replayRun(lcd_t *lcd, const uint8_t *data, size_t len, replay_report_t *report, FILE *log)
+{
+    static char error[64];
+    replay_reader_t r = {.data = data, .len = len};
+    lcd_region_t regions[LCD_MAX_REGIONS];
+    lcd_span_t *spans = NULL;
+    lcd_timing_t timing;
+    char *text = NULL;
+    const uint8_t *p;
+    size_t n, i;
+    int op, x, y;
+
+    memset(report, 0, sizeof(replay_report_t));
+    for (i = 0; i < LCD_MAX_REGIONS; i++)
+    {
+        regions[i] = -1;
+    }
+
+    /* Header: magic, version, bus timing and charset at start */
+    p = readBytes(&r, 4);
+    if (p == NULL || memcmp(p, LCD_RECORD_MAGIC, 4) != 0)
+    {
+        return "not an LCD call record";
+    }
+    op = readByte(&r);
+    if (op < 1 || op > LCD_RECORD_VERSION)
+    {
+        snprintf(error, sizeof(error), "record version %d, expected %d", op, LCD_RECORD_VERSION);
+        return error;
+    }
+    timing.pulseNs = readVarint(&r);
+    timing.cmdUs = readVarint(&r);
+    timing.clearUs = readVarint(&r);
+    op = readByte(&r);
+    if (r.truncated)
+    {
+        return "record truncated in the header";
+    }
+
+    /* Power on, then the device timing and charset */
+    counted = report;
+    half = 0;
+    lcdCtorBus(lcd, &replay_bus, NULL, false);
+    lcdInit(lcd);
+    lcd->timing = timing;
+    lcdSetCharset(lcd, op);
+    memset(report, 0, sizeof(replay_report_t));
+
+    while (r.pos < r.len && !r.truncated)
+    {
+        size_t at = r.pos;
+        uint64_t busNs = report->busNs;
+
+        op = readByte(&r);
+        report->wallUs += readVarint(&r);
+        switch (op)
+        {
+        case LCD_RECORD_TEXT:
+        case LCD_RECORD_RING:
+            x = readInt(&r);
+            y = readInt(&r);
+            if (readText(&r, &text, &n) != NULL)
+            {
+                lcdWrite(lcd, text, n, x, y);
+            }
+            break;
+        case LCD_RECORD_INT:
+            x = readInt(&r);
+            y = readInt(&r);
+            lcdSetInt(lcd, readInt(&r), x, y);
+            break;
+        case LCD_RECORD_SPANS:
+            n = readVarint(&r);
+            if (n > r.len)
+            {
+                r.truncated = true;
+                break;
+            }
+            free(spans);
+            spans = calloc(n ? n : 1, sizeof(lcd_span_t));
+            for (i = 0; i < n && !r.truncated; i++)
+            {
+                spans[i].x = readInt(&r);
+                spans[i].y = readInt(&r);
+                spans[i].len = readVarint(&r);
+                spans[i].buf = (const char *)readBytes(&r, spans[i].len);
+            }
+            if (!r.truncated)
+            {
+                lcdWriteSpans(lcd, spans, n);
+            }
+            break;
+        case LCD_RECORD_PLAY:
+            n = readVarint(&r);
+            if ((p = readBytes(&r, n)) != NULL)
+            {
+                lcdPlay(lcd, p, n);
+            }
+            break;
+        case LCD_RECORD_CLEAR:
+            lcdClear(lcd);
+            break;
+        case LCD_RECORD_GLYPH:
+            x = readByte(&r);
+            if ((p = readBytes(&r, LCD_GLYPH_ROWS)) != NULL)
+            {
+                lcdSetGlyph(lcd, x, p);
+            }
+            break;
+        case LCD_RECORD_CHARSET:
+            lcdSetCharset(lcd, readByte(&r));
+            break;
+        case LCD_RECORD_BEGIN:
+            lcdBegin(lcd);
+            break;
+        case LCD_RECORD_COMMIT:
+            lcdCommit(lcd);
+            break;
+        case LCD_RECORD_REGION_OPEN:
+        {
+            int width, height, z;
+            lcd_region_t region;
+            x = readInt(&r);
+            y = readInt(&r);
+            width = readInt(&r);
+            height = readInt(&r);
+            z = readInt(&r);
+            n = readVarint(&r);
+            if (!r.truncated && n < LCD_MAX_REGIONS &&
+                lcdRegionOpen(lcd, x, y, width, height, z, &region) == LCD_OK)
+            {
+                regions[n] = region;
+            }
+            break;
+        }
+        case LCD_RECORD_REGION_TEXT:
+            n = readVarint(&r);
+            x = readInt(&r);
+            y = readInt(&r);
+            {
+                lcd_region_t region = replayRegion(regions, n);
+                if (readText(&r, &text, &n) != NULL)
+                {
+                    lcdRegionSetText(lcd, region, text, x, y);
+                }
+            }
+            break;
+        case LCD_RECORD_REGION_CLEAR:
+            lcdRegionClear(lcd, replayRegion(regions, readVarint(&r)));
+            break;
+        case LCD_RECORD_REGION_SHOW:
+            n = readVarint(&r);
+            lcdRegionShow(lcd, replayRegion(regions, n), readVarint(&r) != 0);
+            break;
+        case LCD_RECORD_REGION_CLOSE:
+            n = readVarint(&r);
+            lcdRegionClose(lcd, replayRegion(regions, n));
+            if (n < LCD_MAX_REGIONS)
+            {
+                regions[n] = -1;
+            }
+            break;
+        case LCD_RECORD_REGION_LANE:
+            n = readVarint(&r);
+            lcdRegionSetLane(lcd, replayRegion(regions, n), readVarint(&r));
+            break;
+        default:
+            snprintf(error, sizeof(error), "unknown op %d at byte %zu", op, at);
+            free(text);
+            free(spans);
+            lcdFree(lcd);
+            return error;
+        }
+        if (r.truncated)
+        {
+            break;
+        }
+        report->calls[op]++;
+        if (log != NULL)
+        {
+            fprintf(log, "%10llu us  %-12s bus %8.1f us\n", (unsigned long long)report->wallUs,
+                    op_names[op], (report->busNs - busNs) / 1000.0);
+        }
+    }
+
+    free(text);
+    free(spans);
+    if (r.truncated)
+    {
+        snprintf(error, sizeof(error), "record truncated at byte %zu", r.pos);
+        lcdFree(lcd);
+        return error;
+    }
+    return NULL;
+}
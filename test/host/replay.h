@@ -0,0 +1,32 @@
+/**
+ * @file replay.h
+ * @brief Replay of an API call record through the driver
+ *
+ * The recorded calls are made on an LCD object built on a bus backend
+ * that counts the bytes written and the bus time they take, with the
+ * timing from the record header.
+ */
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include "esp_lcd.h"
+
+#define REPLAY_OPS (LCD_RECORD_RING + 1)   /* op codes, 0 unused */
+
+/******************************************************************
+ * \struct replay_report_t replay.h
+ * \brief Calls replayed and the bus traffic they caused
+ *******************************************************************/
+typedef struct
+{
+    uint32_t calls[REPLAY_OPS];     /* calls replayed per op */
+    uint64_t wallUs;                /* recorded time */
+    uint64_t busNs;                 /* bus time */
+    uint32_t cmds, datas;           /* instructions and data bytes written */
+} replay_report_t;
+
+/* Name of a recorded call, NULL for an unknown op */
+const char *replayOpName(int op);
+
+/* Replay a record on lcd, left initialized on success. Error message or NULL */
+const char *replayRun(lcd_t *lcd, const uint8_t *data, size_t len, replay_report_t *report, FILE *log);
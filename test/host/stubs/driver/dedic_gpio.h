@@ -0,0 +1,11 @@
+/* Host stand-in for ESP-IDF driver/dedic_gpio.h, only what the driver uses */
+#pragma once
+#include "esp_err.h"
+#include <stdint.h>
+#include <stddef.h>
+typedef struct dedic_gpio_bundle_t *dedic_gpio_bundle_handle_t;
+typedef struct { const int *gpio_array; size_t array_size; struct { unsigned in_en:1; unsigned in_invert:1; unsigned out_en:1; unsigned out_invert:1; } flags; } dedic_gpio_bundle_config_t;
+esp_err_t dedic_gpio_new_bundle(const dedic_gpio_bundle_config_t *config, dedic_gpio_bundle_handle_t *ret_bundle);
+esp_err_t dedic_gpio_del_bundle(dedic_gpio_bundle_handle_t bundle);
+esp_err_t dedic_gpio_get_out_mask(dedic_gpio_bundle_handle_t bundle, uint32_t *mask);
+void dedic_gpio_bundle_write(dedic_gpio_bundle_handle_t bundle, uint32_t mask, uint32_t value);
@@ -0,0 +1,25 @@
+/* Host stand-in for ESP-IDF driver/i2c.h, only what the driver uses */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+typedef int i2c_port_t;
+typedef enum { I2C_MODE_SLAVE, I2C_MODE_MASTER } i2c_mode_t;
+typedef enum { I2C_MASTER_WRITE = 0, I2C_MASTER_READ = 1 } i2c_rw_t;
+typedef enum { I2C_MASTER_ACK, I2C_MASTER_NACK, I2C_MASTER_LAST_NACK } i2c_ack_type_t;
+typedef void *i2c_cmd_handle_t;
+typedef struct { i2c_mode_t mode; int sda_io_num; int scl_io_num; bool sda_pullup_en; bool scl_pullup_en; union { struct { uint32_t clk_speed; } master; }; uint32_t clk_flags; } i2c_config_t;
+esp_err_t i2c_param_config(i2c_port_t, const i2c_config_t *);
+esp_err_t i2c_driver_install(i2c_port_t, i2c_mode_t, size_t, size_t, int);
+esp_err_t i2c_driver_delete(i2c_port_t);
+i2c_cmd_handle_t i2c_cmd_link_create(void);
+void i2c_cmd_link_delete(i2c_cmd_handle_t);
+esp_err_t i2c_master_start(i2c_cmd_handle_t);
+esp_err_t i2c_master_stop(i2c_cmd_handle_t);
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t, uint8_t, bool);
+esp_err_t i2c_master_write(i2c_cmd_handle_t, const uint8_t *, size_t, bool);
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t, uint8_t *, i2c_ack_type_t);
+esp_err_t i2c_master_cmd_begin(i2c_port_t, i2c_cmd_handle_t, TickType_t);
@@ -0,0 +1,4 @@
+/* Host stand-in for ESP-IDF esp_cpu.h, only what the driver uses */
+#pragma once
+#include <stdint.h>
+uint32_t esp_cpu_get_cycle_count(void);
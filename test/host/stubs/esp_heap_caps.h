@@ -0,0 +1,8 @@
+/* Host stand-in for ESP-IDF esp_heap_caps.h, only what the driver uses */
+#pragma once
+#include <stddef.h>
+#define MALLOC_CAP_DMA (1<<3)
+#define MALLOC_CAP_8BIT (1<<2)
+void *heap_caps_malloc(size_t, unsigned);
+void *heap_caps_calloc(size_t, size_t, unsigned);
+void heap_caps_free(void *);
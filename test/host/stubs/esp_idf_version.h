@@ -0,0 +1,7 @@
+/* Host stand-in for ESP-IDF esp_idf_version.h, only what the driver uses */
+#pragma once
+#define ESP_IDF_VERSION_VAL(a,b,c) (((a)<<16)|((b)<<8)|(c))
+#ifndef HOST_IDF_VERSION
+#define HOST_IDF_VERSION ESP_IDF_VERSION_VAL(5,1,0)
+#endif
+#define ESP_IDF_VERSION HOST_IDF_VERSION
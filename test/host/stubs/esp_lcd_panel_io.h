@@ -0,0 +1,18 @@
+/* Host stand-in for ESP-IDF esp_lcd_panel_io.h, only what the driver uses */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+typedef struct esp_lcd_i80_bus_t *esp_lcd_i80_bus_handle_t;
+typedef struct esp_lcd_panel_io_t *esp_lcd_panel_io_handle_t;
+typedef struct { int dummy; } esp_lcd_panel_io_event_data_t;
+typedef bool (*esp_lcd_panel_io_color_trans_done_cb_t)(esp_lcd_panel_io_handle_t, esp_lcd_panel_io_event_data_t *, void *);
+typedef enum { LCD_CLK_SRC_DEFAULT } lcd_clock_source_t;
+typedef struct { int dc_gpio_num; int wr_gpio_num; lcd_clock_source_t clk_src; int data_gpio_nums[24]; size_t bus_width; size_t max_transfer_bytes; size_t psram_trans_align; size_t sram_trans_align; } esp_lcd_i80_bus_config_t;
+typedef struct { int cs_gpio_num; uint32_t pclk_hz; size_t trans_queue_depth; esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done; void *user_ctx; int lcd_cmd_bits; int lcd_param_bits; } esp_lcd_panel_io_i80_config_t;
+esp_err_t esp_lcd_new_i80_bus(const esp_lcd_i80_bus_config_t *, esp_lcd_i80_bus_handle_t *);
+esp_err_t esp_lcd_del_i80_bus(esp_lcd_i80_bus_handle_t);
+esp_err_t esp_lcd_new_panel_io_i80(esp_lcd_i80_bus_handle_t, const esp_lcd_panel_io_i80_config_t *, esp_lcd_panel_io_handle_t *);
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t);
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t, int, const void *, size_t);
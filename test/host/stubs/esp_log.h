@@ -0,0 +1,11 @@
+/* Host stand-in for ESP-IDF esp_log.h, only what the driver uses */
+#pragma once
+#include <stdarg.h>
+#include <stdio.h>
+#define ESP_LOGE(t, ...) ((void)(t), (void)printf(__VA_ARGS__))
+#define ESP_LOGW(t, ...) ((void)(t), (void)printf(__VA_ARGS__))
+#define ESP_LOGI(t, ...) ((void)(t), (void)printf(__VA_ARGS__))
+#define ESP_LOGD(t, ...) ((void)(t), (void)printf(__VA_ARGS__))
+typedef int (*vprintf_like_t)(const char *, va_list);
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t);
+typedef enum { ESP_LOG_NONE, ESP_LOG_ERROR, ESP_LOG_WARN, ESP_LOG_INFO, ESP_LOG_DEBUG, ESP_LOG_VERBOSE } esp_log_level_t;
@@ -0,0 +1,5 @@
+/* Host stand-in for ESP-IDF esp_rom_gpio.h, only what the driver uses */
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+void esp_rom_gpio_connect_out_signal(uint32_t gpio_num, uint32_t signal_idx, bool out_inv, bool oen_inv);
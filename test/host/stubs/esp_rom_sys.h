@@ -0,0 +1,5 @@
+/* Host stand-in for ESP-IDF esp_rom_sys.h, only what the driver uses */
+#pragma once
+#include <stdint.h>
+void esp_rom_delay_us(uint32_t);
+uint32_t esp_rom_get_cpu_ticks_per_us(void);
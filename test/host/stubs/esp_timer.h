@@ -0,0 +1,13 @@
+/* Host stand-in for ESP-IDF esp_timer.h, only what the driver uses */
+#pragma once
+#include <stdint.h>
+int64_t esp_timer_get_time(void);
+typedef struct esp_timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *arg);
+typedef struct { esp_timer_cb_t callback; void *arg; int dispatch_method; const char *name; int skip_unhandled_events; } esp_timer_create_args_t;
+#include "esp_err.h"
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t period);
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout);
+esp_err_t esp_timer_stop(esp_timer_handle_t t);
+esp_err_t esp_timer_delete(esp_timer_handle_t t);
@@ -0,0 +1,16 @@
+/* Host stand-in for ESP-IDF esp_vfs.h, only what the driver uses */
+#pragma once
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "esp_err.h"
+#define ESP_VFS_FLAG_CONTEXT_PTR 1
+typedef struct {
+    int flags;
+    ssize_t (*write_p)(void *ctx, int fd, const void *data, size_t size);
+    int (*open_p)(void *ctx, const char *path, int flags, int mode);
+    int (*close_p)(void *ctx, int fd);
+    int (*fstat_p)(void *ctx, int fd, struct stat *st);
+} esp_vfs_t;
+esp_err_t esp_vfs_register(const char *base_path, const esp_vfs_t *vfs, void *ctx);
+esp_err_t esp_vfs_unregister(const char *base_path);
@@ -0,0 +1,26 @@
+/* Host stand-in for ESP-IDF freertos/FreeRTOS.h, only what the driver uses */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+typedef uint32_t TickType_t; typedef int BaseType_t; typedef unsigned UBaseType_t;
+#define portTICK_PERIOD_MS 10
+#define pdMS_TO_TICKS(x) ((x)/10)
+#define portMAX_DELAY 0xffffffffu
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define tskNO_AFFINITY 0x7fffffff
+typedef struct { int x[32]; } StaticSemaphore_t;
+typedef struct { int x[32]; } StaticTask_t;
+typedef uint32_t StackType_t;
+typedef struct { int x; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+void vPortEnterCritical(portMUX_TYPE*); void vPortExitCritical(portMUX_TYPE*);
+#define portENTER_CRITICAL(m) vPortEnterCritical(m)
+#define portEXIT_CRITICAL(m) vPortExitCritical(m)
+#define portENTER_CRITICAL_ISR(m) vPortEnterCritical(m)
+#define portEXIT_CRITICAL_ISR(m) vPortExitCritical(m)
+#define spinlock_initialize(m) ((m)->x = 0)
+#define portYIELD_FROM_ISR() 
+#define configTICK_RATE_HZ 100
+#define portNUM_PROCESSORS 2
@@ -0,0 +1,14 @@
+/* Host stand-in for ESP-IDF freertos/semphr.h, only what the driver uses */
+#pragma once
+#include "FreeRTOS.h"
+typedef void *SemaphoreHandle_t;
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutexStatic(StaticSemaphore_t*);
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t*);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t, TickType_t);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t, BaseType_t*);
+void vSemaphoreDelete(SemaphoreHandle_t);
+void *xSemaphoreGetMutexHolder(SemaphoreHandle_t);
@@ -0,0 +1,4 @@
+/* Host stand-in for ESP-IDF hal/cpu_hal.h, only what the driver uses */
+#pragma once
+#include <stdint.h>
+uint32_t cpu_hal_get_cycle_count(void);
@@ -0,0 +1,4 @@
+/* Host stand-in for ESP-IDF sdkconfig.h, only what the driver uses */
+#pragma once
+#define CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ 240
+#define CONFIG_FREERTOS_HZ 100
@@ -0,0 +1,5 @@
+/* Host stand-in for ESP-IDF soc/dedic_gpio_periph.h, only what the driver uses */
+#pragma once
+#include "soc/soc_caps.h"
+typedef struct { struct { const int in_sig_per_channel[SOC_DEDIC_GPIO_IN_CHANNELS_NUM]; const int out_sig_per_channel[SOC_DEDIC_GPIO_OUT_CHANNELS_NUM]; } cores[SOC_CPU_CORES_NUM]; } dedic_gpio_signal_conn_t;
+extern const dedic_gpio_signal_conn_t dedic_gpio_sig_info;
@@ -0,0 +1,6 @@
+/* Host stand-in for ESP-IDF soc/gpio_reg.h, only what the driver uses */
+#pragma once
+#define GPIO_OUT_W1TS_REG 0x3FF44008
+#define GPIO_OUT_W1TC_REG 0x3FF4400C
+#define GPIO_OUT1_W1TS_REG 0x3FF44014
+#define GPIO_OUT1_W1TC_REG 0x3FF44018
@@ -0,0 +1,8 @@
+/* Host stand-in for ESP-IDF soc/soc.h, only what the driver uses */
+#pragma once
+#include <stdint.h>
+
+/* GPIO output set and clear registers drive the pads, @see hd44780.c */
+void simRegWrite(uint32_t reg, uint32_t value);
+
+#define REG_WRITE(_r, _v) simRegWrite((_r), (_v))
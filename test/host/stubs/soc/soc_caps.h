@@ -0,0 +1,9 @@
+/* Host stand-in for ESP-IDF soc/soc_caps.h, only what the driver uses */
+#pragma once
+#define SOC_DEDICATED_GPIO_SUPPORTED 1
+#define SOC_LCD_I80_SUPPORTED 1
+#define SOC_LEDC_SUPPORT_HS_MODE 1
+#define SOC_GPIO_PIN_COUNT 40
+#define SOC_CPU_CORES_NUM 2
+#define SOC_DEDIC_GPIO_OUT_CHANNELS_NUM 8
+#define SOC_DEDIC_GPIO_IN_CHANNELS_NUM 8
@@ -0,0 +1,147 @@
+/**
+ * @file test_anim.c
+ * @brief Glyph animation ticks, dropped frames and the bus budget
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+
+static const uint8_t spinner[3][LCD_GLYPH_ROWS] = {
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00},
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00},
+    {0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00},
+};
+
+static const uint8_t blink[2][LCD_GLYPH_ROWS] = {
+    {0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00, 0x00, 0x00},
+    {0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00, 0x00, 0x00},
+};
+
+static void testTick(void)
+{
+    lcd_t lcd;
+    lcd_anim_t anim;
+    unsigned long datas, cmds;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdAnimStart(&lcd, 0, spinner, 3, 100), LCD_FAIL);
+    CHECK_EQ(lcdAnimOpen(&lcd, &anim, 0, 0), LCD_OK);
+    CHECK_EQ(lcdAnimOpen(&lcd, &anim, 0, 0), LCD_FAIL);
+    CHECK_EQ(anim.tickUs, LCD_ANIM_TICK_MS * 1000);
+    CHECK_EQ(lcdAnimStart(&lcd, 8, spinner, 3, 100), LCD_FAIL);
+
+    /* First frame at once, shown through its character code */
+    CHECK_EQ(lcdAnimStart(&lcd, 0, spinner, 3, 100), LCD_OK);
+    CHECK(memcmp(sim.cgram, spinner[0], LCD_GLYPH_ROWS) == 0);
+    CHECK_EQ(lcdSetText(&lcd, "\x08 busy", 0, 0), LCD_OK);
+    CHECK_EQ(sim.ddram[0], 0x08);
+
+    /* Nothing due yet */
+    datas = sim.datas;
+    simTimerFire();
+    CHECK_EQ(sim.datas, datas);
+
+    /* A frame rewrites the glyph rows and no text */
+    sim.us += 100000;
+    cmds = sim.cmds;
+    simTimerFire();
+    CHECK(memcmp(sim.cgram, spinner[1], LCD_GLYPH_ROWS) == 0);
+    CHECK_EQ(sim.datas - datas, LCD_GLYPH_ROWS);
+    CHECK_EQ(sim.cmds - cmds, 2);
+    CHECK_EQ(anim.frames, 1);
+
+    /* Late frames are dropped, not caught up */
+    sim.us += 350000;
+    simTimerFire();
+    CHECK_EQ(anim.frames, 2);
+    CHECK(memcmp(sim.cgram, spinner[2], LCD_GLYPH_ROWS) == 0);
+    simTimerFire();
+    CHECK_EQ(anim.frames, 2);
+
+    /* Repeated frames cost no bus time */
+    CHECK_EQ(lcdAnimStart(&lcd, 1, blink, 2, 100), LCD_OK);
+    CHECK_EQ(lcdAnimStop(&lcd, 0), LCD_OK);
+    CHECK_EQ(lcdAnimStop(&lcd, 0), LCD_FAIL);
+    datas = sim.datas;
+    sim.us += 100000;
+    simTimerFire();
+    CHECK_EQ(sim.datas, datas);
+    CHECK_EQ(anim.sprites[1].frame, 1);
+
+    /* A busy bus skips the tick */
+    CHECK_EQ(lcdAnimStart(&lcd, 0, spinner, 3, 100), LCD_OK);
+    sim.us += 100000;
+    simLockBusy = true;
+    simTimerFire();
+    simLockBusy = false;
+    CHECK_EQ(anim.sprites[0].frame, 0);
+    simTimerFire();
+    CHECK_EQ(anim.sprites[0].frame, 1);
+
+    /* Zero and too long periods */
+    CHECK_EQ(lcdAnimStart(&lcd, 2, blink, 2, UINT32_MAX / 1000 + 1), LCD_FAIL);
+    CHECK_EQ(lcdAnimStart(&lcd, 2, spinner, 3, 0), LCD_OK);
+    CHECK_EQ(anim.sprites[2].frameUs, anim.tickUs);
+    sim.us += anim.tickUs;
+    simTimerFire();
+    CHECK_EQ(anim.sprites[2].frame, 1);
+    CHECK_EQ(lcdAnimStop(&lcd, 2), LCD_OK);
+
+        /* lcdFree closes the animations */
+    CHECK_EQ(simTimers, 1);
+    lcdFree(&lcd);
+    CHECK_EQ(simTimers, 0);
+}
+
+static void testBudget(void)
+{
+    lcd_t lcd;
+    lcd_anim_t anim;
+    int slot;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    /* Room for one glyph a tick */
+    CHECK_EQ(lcdAnimOpen(&lcd, &anim, 20, 1), LCD_OK);
+    for (slot = 0; slot < 3; slot++)
+    {
+        CHECK_EQ(lcdAnimStart(&lcd, slot, spinner, 3, 100), LCD_OK);
+        sim.us += 1000;
+    }
+    sim.us += 100000;
+
+    /* Most overdue first, the rest wait for the next tick */
+    simTimerFire();
+    CHECK_EQ(anim.frames, 1);
+    CHECK_EQ(anim.deferred, 2);
+    CHECK_EQ(anim.sprites[0].frame, 1);
+    CHECK(anim.costUs > 0);
+    simTimerFire();
+    simTimerFire();
+    CHECK_EQ(anim.frames, 3);
+    CHECK_EQ(anim.sprites[2].frame, 1);
+
+    /* Repeated frames every tick, nothing holds the tick back */
+    CHECK_EQ(lcdAnimClose(&lcd), LCD_OK);
+    CHECK_EQ(lcdAnimOpen(&lcd, &anim, 0, 0), LCD_OK);
+    CHECK_EQ(lcdAnimStart(&lcd, 0, blink, 2, 0), LCD_OK);
+    sim.us += anim.tickUs;
+    simTimerFire();
+    CHECK_EQ(anim.sprites[0].frame, 1);
+    CHECK_EQ(anim.frames, 0);
+
+    CHECK_EQ(lcdAnimClose(&lcd), LCD_OK);
+    CHECK_EQ(lcdAnimClose(&lcd), LCD_FAIL);
+    CHECK_EQ(simTimers, 0);
+    lcdFree(&lcd);
+}
+
+int main(void)
+{
+    testTick();
+    testBudget();
+    return SIM_RESULT();
+}
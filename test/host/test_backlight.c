@@ -0,0 +1,158 @@
+/**
+ * @file test_backlight.c
+ * @brief Backlight duty sequence, idle dimming and LEDC fades
+ */
+#include <string.h>
+#include "esp_idf_version.h"
+#include "esp_lcd.h"
+#include "sim.h"
+
+/* Recording PWM backend */
+static struct
+{
+    int inits, releases, count;
+    uint32_t duty[16], ms[16];
+} rec;
+
+static bool recInit(lcd_backlight_t *bl)
+{
+    rec.inits++;
+    return true;
+}
+
+static void recFade(lcd_backlight_t *bl, uint32_t duty, uint32_t ms)
+{
+    if (rec.count < 16)
+    {
+        rec.duty[rec.count] = duty;
+        rec.ms[rec.count] = ms;
+        rec.count++;
+    }
+}
+
+static void recRelease(lcd_backlight_t *bl)
+{
+    rec.releases++;
+}
+
+static const lcd_pwm_t rec_pwm = {
+    .init = recInit,
+    .fade = recFade,
+    .release = recRelease,
+};
+
+static const lcd_backlight_config_t config = {
+    .pin = 4,
+    .freqHz = LCD_BL_FREQ_HZ,
+    .on = 255,
+    .dim = 32,
+    .idleMs = 1000,
+    .fadeMs = LCD_BL_FADE_MS,
+};
+
+static void testIdle(void)
+{
+    lcd_t lcd;
+    lcd_backlight_t bl;
+
+    simReset();
+    memset(&rec, 0, sizeof(rec));
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdBacklightOpenPwm(&lcd, &bl, &config, &rec_pwm), LCD_OK);
+    CHECK_EQ(rec.inits, 1);
+    CHECK_EQ(rec.count, 1);
+    CHECK_EQ(rec.duty[0], LCD_BL_DUTY_MAX);
+    CHECK_EQ(rec.ms[0], LCD_BL_FADE_MS);
+    CHECK_EQ(simTimers, 1);
+
+    /* Updates before the timeout keep it on */
+    sim.us += 600 * 1000;
+    lcdSetText(&lcd, "busy", 0, 0);
+    sim.us += 600 * 1000;
+    simTimerFire();
+    CHECK_EQ(rec.count, 1);
+
+    /* Dims once idle, squared, 32 is about 1.6 % */
+    sim.us += 1000 * 1000;
+    simTimerFire();
+    CHECK_EQ(rec.count, 2);
+    CHECK_EQ(rec.duty[1], 16);
+    CHECK(bl.dimmed);
+
+    /* Stopped while dimmed, the next update wakes it */
+    sim.us += 5000 * 1000;
+    simTimerFire();
+    CHECK_EQ(rec.count, 2);
+    lcdSetText(&lcd, "wake", 0, 1);
+    CHECK_EQ(rec.count, 3);
+    CHECK_EQ(rec.duty[2], LCD_BL_DUTY_MAX);
+    CHECK(!bl.dimmed);
+
+    /* Same duty twice is not faded again, a new level is */
+    lcdBacklightWake(&lcd);
+    CHECK_EQ(rec.count, 3);
+    CHECK_EQ(lcdBacklightSet(&lcd, 128), LCD_OK);
+    CHECK_EQ(rec.count, 4);
+    CHECK_EQ(rec.duty[3], 258);
+
+    /* A busy bus skips the idle check */
+    sim.us += 2000 * 1000;
+    simLockBusy = true;
+    simTimerFire();
+    simLockBusy = false;
+    CHECK_EQ(rec.count, 4);
+    simTimerFire();
+    CHECK_EQ(rec.count, 5);
+    CHECK_EQ(rec.duty[4], 16);
+
+    /* Set while dimmed only changes the level it wakes to */
+    CHECK_EQ(lcdBacklightSet(&lcd, 0), LCD_OK);
+    CHECK_EQ(rec.count, 6);
+    CHECK_EQ(rec.duty[5], 0);
+
+    CHECK_EQ(lcdBacklightClose(&lcd), LCD_OK);
+    CHECK_EQ(rec.releases, 1);
+    CHECK_EQ(simTimers, 0);
+    CHECK_EQ(lcdBacklightWake(&lcd), LCD_FAIL);
+    lcdFree(&lcd);
+}
+
+static void testLedc(void)
+{
+    lcd_t lcd;
+    lcd_backlight_t bl;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    simLedcFades = simLedcBlocked = 0;
+    CHECK_EQ(lcdBacklightOpen(&lcd, &bl, &config), LCD_OK);
+    CHECK_EQ(simLedcDuty, LCD_BL_DUTY_MAX);
+
+    /* Dim and wake again while the dim fade still runs */
+    sim.us += 1000 * 1000;
+    simTimerFire();
+    CHECK_EQ(simLedcDuty, 16);
+    lcdSetText(&lcd, "wake", 0, 0);
+    CHECK_EQ(simLedcDuty, LCD_BL_DUTY_MAX);
+
+    /* Never waits for a fade with the lock held */
+    CHECK_EQ(simLedcBlocked, 0);
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+    CHECK_EQ(simLedcFades, 3);
+#else
+    CHECK_EQ(simLedcFades, 0);
+#endif
+
+    CHECK_EQ(lcdBacklightClose(&lcd), LCD_OK);
+    CHECK_EQ(simLedcDuty, 0);
+    lcdFree(&lcd);
+}
+
+int main(void)
+{
+    testIdle();
+    testLedc();
+    return SIM_RESULT();
+}
@@ -0,0 +1,101 @@
+/**
+ * @file test_calibrate.c
+ * @brief Timing calibration, stored in NVS and loaded by lcdInit
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+
+static gpio_num_t data[LCD_DATA_LINE] = {19, 18, 17, 16};
+
+/* Readable display on the default pins, R/W on 21 */
+static void readable(lcd_t *lcd)
+{
+    sim.rw = 21;
+    sim.busy = true;
+    lcdCtorRW(lcd, data, 22, 23, 21);
+    lcdInit(lcd);
+}
+
+static void testCalibrate(void)
+{
+    lcd_t lcd, again;
+    lcd_timing_t timing;
+    char screen[2][17];
+
+    simReset();
+    simNvsLen = 0;
+    sim.pulseNs = 300;
+    readable(&lcd);
+    lcdSetText(&lcd, "kept", 0, 0);
+
+    /* Shortest pulse the LCD latches, busy flag times with margin */
+    CHECK_EQ(lcdCalibrate(&lcd, &timing), LCD_OK);
+    CHECK(timing.pulseNs >= 300 * 125 / 100 && timing.pulseNs < 350 * 125 / 100);
+    CHECK(timing.cmdUs > 37 && timing.cmdUs < 50);
+    CHECK(timing.clearUs > 1520 && timing.clearUs < 2000);
+    CHECK(memcmp(&lcd.timing, &timing, sizeof(timing)) == 0);
+    simScreen(screen);
+    CHECK_STR(screen[0], "kept            ");
+    CHECK_EQ(lcdSetText(&lcd, "after", 0, 1), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[1], "after           ");
+
+    /* Stored under the wiring, loaded on the next boot */
+    CHECK_EQ(simNvsLen, sizeof(lcd_timing_t));
+    CHECK_STR(simNvsKey, "t015535d6");
+    lcdFree(&lcd);
+    readable(&again);
+    CHECK(memcmp(&again.timing, &timing, sizeof(timing)) == 0);
+    lcdFree(&again);
+
+    /* A slower clone on the same wiring does not take it */
+    sim.pulseNs = 800;
+    readable(&again);
+    CHECK_EQ(again.timing.pulseNs, 500);
+    CHECK_EQ(lcdCalibrate(&again, &timing), LCD_OK);
+    CHECK(timing.pulseNs >= 800 * 125 / 100 && timing.pulseNs < 850 * 125 / 100);
+    lcdFree(&again);
+}
+
+static void testFail(void)
+{
+    lcd_t lcd;
+    lcd_timing_t timing = {0};
+
+    /* Write only bus */
+    simReset();
+    simNvsLen = 0;
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdCalibrate(&lcd, &timing), LCD_FAIL);
+    lcdFree(&lcd);
+
+    /* Reads never match, default timing stays */
+    simReset();
+    readable(&lcd);
+    sim.corruptRead = true;
+    CHECK_EQ(lcdCalibrate(&lcd, &timing), LCD_FAIL);
+    CHECK_EQ(timing.cmdUs, 0);
+    CHECK_EQ(lcd.timing.pulseNs, 500);
+    CHECK_EQ(lcd.timing.cmdUs, 50);
+    CHECK_EQ(simNvsLen, 0);
+    lcdFree(&lcd);
+
+    /* Without NVS the calibration still applies */
+    simReset();
+    simNvsReady = false;
+    readable(&lcd);
+    CHECK_EQ(lcdCalibrate(&lcd, &timing), LCD_OK);
+    CHECK_EQ(simNvsLen, 0);
+    CHECK(lcd.timing.cmdUs < 50);
+    simNvsReady = true;
+    lcdFree(&lcd);
+}
+
+int main(void)
+{
+    testCalibrate();
+    testFail();
+    return SIM_RESULT();
+}
@@ -0,0 +1,171 @@
+/**
+ * @file test_dedic.c
+ * @brief Bus selection and the dedicated GPIO bus
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+#include "sim_dedic.h"
+
+/* Bundle bits, D4 - D7, RS, EN */
+#define B_RS 0x10
+#define B_EN 0x20
+
+static gpio_num_t data[LCD_DATA_LINE] = {19, 18, 17, 16};
+
+static void testSelect(void)
+{
+    lcd_t lcd;
+    char screen[2][17];
+
+    /* Free channels, data, RS and EN go to one bundle */
+    simReset();
+    simDedicReset();
+    lcdCtor(&lcd, data, 22, 23);
+    CHECK_EQ(simDedic.bundles, 1);
+    lcdInit(&lcd);
+    lcdSetText(&lcd, "bundle", 0, 0);
+    simScreen(screen);
+    CHECK_STR(screen[0], "bundle          ");
+    CHECK(simDedic.count > 0);
+    lcdFree(&lcd);
+    CHECK_EQ(simDedic.bundles, 0);
+
+    /* No channels, GPIO bus */
+    simReset();
+    simDedicReset();
+    simDedic.full = true;
+    lcdCtor(&lcd, data, 22, 23);
+    CHECK_EQ(simDedic.bundles, 0);
+    lcdInit(&lcd);
+    lcdSetText(&lcd, "gpio", 0, 0);
+    simScreen(screen);
+    CHECK_STR(screen[0], "gpio            ");
+    CHECK_EQ(simDedic.count, 0);
+    lcdFree(&lcd);
+}
+
+static void testSetup(void)
+{
+    lcd_t lcd;
+    int i, strobes = 0;
+
+    simReset();
+    simDedicReset();
+    lcdCtor(&lcd, data, 22, 23);
+    lcdInit(&lcd);
+    simDedic.count = 0;
+    lcdSetText(&lcd, "tAS", 0, 1);
+
+    /* RS is set up tAS, 60 ns or 15 cycles at 240 MHz, before EN rises */
+    for (i = 1; i < simDedic.count; i++)
+    {
+        if ((simDedic.log[i].value & simDedic.log[i].mask & B_EN) && simDedic.log[i].mask == 0x3F)
+        {
+            CHECK_EQ(simDedic.log[i - 1].value & B_EN, 0);
+            CHECK_EQ(simDedic.log[i - 1].value & B_RS, simDedic.log[i].value & B_RS);
+            CHECK(simDedic.log[i].cycles - simDedic.log[i - 1].cycles >= 15);
+            strobes++;
+        }
+    }
+    CHECK_EQ(strobes, 8);
+    lcdFree(&lcd);
+}
+
+static void testRead(void)
+{
+    lcd_t lcd;
+    lcd_stats_t stats;
+    char screen[2][17];
+    int repaired = -1;
+
+    simReset();
+    simDedicReset();
+    sim.rw = 21;
+    lcdCtorRW(&lcd, data, 22, 23, 21);
+    lcdInit(&lcd);
+
+    /* Every write checks sync with a read, later writes still land */
+    lcdSetText(&lcd, "first", 0, 0);
+    lcdSetText(&lcd, "second", 0, 1);
+    lcdSetText(&lcd, "third", 8, 0);
+    simScreen(screen);
+    CHECK_STR(screen[0], "first   third   ");
+    CHECK_STR(screen[1], "second          ");
+    lcdGetStats(&lcd, &stats);
+    CHECK_EQ(stats.recoveries, 0);
+    CHECK_EQ(simDedic.bundles, 1);
+
+    /* Reads keep the bundle, the data lines go back to its channels */
+    CHECK_EQ(simDedic.created, 1);
+
+    /* Reads in a row, then a repair write */
+    sim.ddram[1] = '#';
+    CHECK_EQ(lcdScrub(&lcd, 2 * LCD_COLS, &repaired), LCD_OK);
+    CHECK_EQ(repaired, 1);
+    lcdSetText(&lcd, "4", 15, 1);
+    simScreen(screen);
+    CHECK_STR(screen[0], "first   third   ");
+    CHECK_STR(screen[1], "second         4");
+    CHECK_EQ(simDedic.created, 1);
+    lcdGetStats(&lcd, &stats);
+    CHECK_EQ(stats.fallbacks, 0);
+    lcdFree(&lcd);
+}
+
+static void testFollow(void)
+{
+    lcd_t lcd;
+    lcd_stats_t stats;
+    char screen[2][17];
+
+    simReset();
+    simDedicReset();
+    simCore = 0;
+    lcdCtor(&lcd, data, 22, 23);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdRenderStartPinned(&lcd, 1, 1), LCD_OK);
+    CHECK_EQ(simPinned, 1);
+
+    /* Render task on core 1 takes the bundle along */
+    lcdSetText(&lcd, "core 1", 0, 0);
+    simCore = 1;
+    simRender();
+    simCore = 0;
+    CHECK_EQ(simDedic.bundles, 1);
+    CHECK_EQ(simDedic.lastCore, 1);
+    simScreen(screen);
+    CHECK_STR(screen[0], "core 1          ");
+
+    /* Stopping writes the rest from core 0, the bundle comes back */
+    lcdSetText(&lcd, "core 0", 0, 1);
+    CHECK_EQ(lcdRenderStop(&lcd), LCD_OK);
+    CHECK_EQ(simDedic.lastCore, 0);
+    CHECK_EQ(simDedic.bundles, 1);
+    CHECK_EQ(simDedic.lost, 0);
+    simScreen(screen);
+    CHECK_STR(screen[1], "core 0          ");
+
+    /* No channels on core 1, falls back to the GPIO bus */
+    CHECK_EQ(lcdRenderStartPinned(&lcd, 1, 1), LCD_OK);
+    simDedic.full = true;
+    lcdSetText(&lcd, "fallback", 0, 0);
+    simCore = 1;
+    simRender();
+    simCore = 0;
+    CHECK_EQ(simDedic.bundles, 0);
+    lcdGetStats(&lcd, &stats);
+    CHECK_EQ(stats.fallbacks, 1);
+    simScreen(screen);
+    CHECK_STR(screen[0], "fallback        ");
+    lcdFree(&lcd);
+}
+
+int main(void)
+{
+    testSelect();
+    testSetup();
+    testRead();
+    testFollow();
+    return SIM_RESULT();
+}
@@ -0,0 +1,75 @@
+/**
+ * @file test_hpp.cpp
+ * @brief C++ template driver on the HD44780 model
+ */
+#include <string.h>
+/* Host stand-ins are C */
+extern "C" {
+#include "driver/gpio.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "hal/cpu_hal.h"
+#include "soc/soc.h"
+#include "sim.h"
+}
+#include "esp_lcd.hpp"
+
+/* Clear takes 1.5 ticks */
+typedef hd44780::Lcd<hd44780::GpioBus<19, 18, 17, 16, 23, 22>, hd44780::Geometry<>,
+                     hd44780::Timing<500, 50, 15000>> slow_lcd;
+
+static void testWrite(void)
+{
+    slow_lcd lcd;
+    char screen[2][17];
+
+    simReset();
+    lcd.init();
+    CHECK_EQ(lcd.setText("hello", 0, 0), LCD_OK);
+    CHECK_EQ(lcd.setInt(-42, 3, 1), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "hello           ");
+    CHECK_STR(screen[1], "   -42          ");
+}
+
+static void testSetup(void)
+{
+    slow_lcd lcd;
+    char screen[2][17];
+
+    /* RS is set up tAS before EN rises, or the LCD misses the strobe */
+    simReset();
+    sim.setupNs = 60;
+    lcd.init();
+    CHECK_EQ(lcd.setText("tAS", 0, 0), LCD_OK);
+    CHECK_EQ(lcd.setText("60 ns", 0, 1), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "tAS             ");
+    CHECK_STR(screen[1], "60 ns           ");
+}
+
+static void testWait(void)
+{
+    slow_lcd lcd;
+    unsigned long ticks, us;
+
+    simReset();
+    lcd.init();
+    ticks = sim.ticks;
+    us = sim.us;
+
+    /* Sleeps whole ticks, never less than the clear takes */
+    CHECK_EQ(lcd.clear(), LCD_OK);
+    CHECK_EQ(sim.ticks - ticks, 2);
+    CHECK(sim.us - us >= 15000);
+}
+
+int main(void)
+{
+    testWrite();
+    testSetup();
+    testWait();
+    return SIM_RESULT();
+}
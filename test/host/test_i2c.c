@@ -0,0 +1,299 @@
+/**
+ * @file test_i2c.c
+ * @brief PCF8574 I2C backpack bus
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+#include "sim_i2c.h"
+
+/* Backpack expander pins */
+#define P_RS 0x01
+#define P_RW 0x02
+#define P_EN 0x04
+#define P_BL 0x08
+
+static const lcd_i2c_config_t config = {
+    .port = 0,
+    .sda = 21,
+    .scl = 22,
+    .addr = LCD_I2C_ADDR,
+    .clockHz = LCD_I2C_CLOCK_HZ,
+    .map = LCD_I2C_PCF8574_MAP,
+};
+
+/******************************************************************
+ * \struct decoded_t test_i2c.c
+ * \brief Bytes the LCD latched, rebuilt from expander writes
+ *******************************************************************/
+typedef struct
+{
+    uint8_t byte[64];
+    uint8_t rs[64];
+    int count;
+    int batch;
+} decoded_t;
+
+/**
+ * @brief Pair the nibbles latched on each EN fall back into bytes
+ */
+static void decode(decoded_t *out)
+{
+    int i, nibbles = 0;
+    uint8_t prev = 0, hi = 0;
+
+    memset(out, 0, sizeof(*out));
+    for (i = 0; i < simI2C.count; i++)
+    {
+        uint8_t cur = simI2C.log[i].byte;
+        if (cur & P_RW)
+        {
+            /* Rest is the sync check reading back */
+            break;
+        }
+        /* Every write keeps the backlight on */
+        CHECK(cur & P_BL);
+        out->batch = simI2C.log[i].batch;
+        if (!(prev & P_EN) && (cur & P_EN) && i > 0)
+        {
+            /* RS set up before EN rises */
+            CHECK_EQ(prev & P_RS, cur & P_RS);
+        }
+        if ((prev & P_EN) && !(cur & P_EN))
+        {
+            if (nibbles++ % 2 == 0)
+            {
+                hi = prev >> 4;
+            }
+            else if (out->count < 64)
+            {
+                out->byte[out->count] = (hi << 4) | (prev >> 4);
+                out->rs[out->count++] = prev & P_RS;
+            }
+        }
+        prev = cur;
+    }
+    CHECK_EQ(nibbles % 2, 0);
+    CHECK_EQ(simI2C.tas, 0);
+}
+
+static void testWrite(void)
+{
+    lcd_t lcd;
+    decoded_t dec;
+    char screen[2][17];
+
+    simReset();
+    sim.rw = 21;
+    simI2CReset();
+    CHECK_EQ(lcdCtorI2C(&lcd, &config), LCD_OK);
+    lcdInit(&lcd);
+    CHECK_EQ(simI2C.addr, LCD_I2C_ADDR);
+
+    simI2CReset();
+    CHECK_EQ(lcdSetText(&lcd, "Hi!", 2, 1), LCD_OK);
+    decode(&dec);
+    CHECK_EQ(dec.count, 4);
+    CHECK_EQ(dec.byte[0], 0x80 | 0x42);
+    CHECK_EQ(dec.rs[0], 0);
+    CHECK_EQ(dec.byte[1], 'H');
+    CHECK_EQ(dec.byte[2], 'i');
+    CHECK_EQ(dec.byte[3], '!');
+    CHECK_EQ(dec.rs[1] & dec.rs[2] & dec.rs[3], P_RS);
+    /* Two bytes per nibble, instruction to data adds one RS setup byte */
+    CHECK_EQ(simI2C.log[0].byte, 0xC0 | P_BL | P_EN);
+    CHECK_EQ(simI2C.log[3].byte & (P_RS | P_EN), 0);
+    CHECK_EQ(simI2C.log[4].byte & (P_RS | P_EN), P_RS);
+    CHECK_EQ(simI2C.log[5].byte & (P_RS | P_EN), P_RS | P_EN);
+    /* One transaction for the whole update */
+    CHECK_EQ(dec.batch, 1);
+
+    simScreen(screen);
+    CHECK_STR(screen[1], "  Hi!           ");
+    lcdFree(&lcd);
+}
+
+static void testRead(void)
+{
+    lcd_t lcd;
+    lcd_stats_t stats;
+    char screen[2][17];
+    int repaired = -1, i, reads = 0;
+
+    simReset();
+    sim.rw = 21;
+    CHECK_EQ(lcdCtorI2C(&lcd, &config), LCD_OK);
+    lcdInit(&lcd);
+    lcdSetText(&lcd, "I2C backpack", 0, 0);
+
+    /* Address counter read through the pin map matches */
+    simI2CReset();
+    CHECK_EQ(lcdCheck(&lcd), LCD_OK);
+    lcdGetStats(&lcd, &stats);
+    CHECK_EQ(stats.recoveries, 0);
+    for (i = 1; i < simI2C.count; i++)
+    {
+        if (simI2C.log[i].read)
+        {
+            /* Strobe before each read: R/W, EN and released D4 - D7 high */
+            CHECK_EQ(simI2C.log[i - 1].byte & (0xF0 | P_RW | P_EN), 0xF0 | P_RW | P_EN);
+            reads++;
+        }
+    }
+    CHECK_EQ(reads, 2);
+
+    /* DDRAM read back through the pin map finds the flipped cell */
+    sim.ddram[3] = 'X';
+    CHECK_EQ(lcdScrub(&lcd, LCD_COLS, &repaired), LCD_OK);
+    CHECK_EQ(repaired, 1);
+    simScreen(screen);
+    CHECK_STR(screen[0], "I2C backpack    ");
+    lcdFree(&lcd);
+}
+
+static void testReadWrite(void)
+{
+    lcd_t lcd;
+    decoded_t dec;
+    char screen[2][17];
+
+    simReset();
+    sim.rw = 21;
+    CHECK_EQ(lcdCtorI2C(&lcd, &config), LCD_OK);
+    lcdInit(&lcd);
+    lcdSetText(&lcd, "before", 0, 0);
+
+    /* A read leaves R/W high, the instruction after it sets up R/W
+     * and RS with EN low before the strobe */
+    CHECK_EQ(lcdCheck(&lcd), LCD_OK);
+    simI2CReset();
+    CHECK_EQ(lcdSetText(&lcd, "after", 0, 1), LCD_OK);
+    CHECK_EQ(simI2C.log[0].byte & (P_RW | P_EN | P_RS), 0);
+    decode(&dec);
+    CHECK_EQ(dec.byte[0], 0x80 | 0x40);
+    CHECK_EQ(dec.rs[0], 0);
+    simScreen(screen);
+    CHECK_STR(screen[0], "before          ");
+    CHECK_STR(screen[1], "after           ");
+
+    /* Every read and write after it keeps the setup time */
+    CHECK_EQ(lcdScrub(&lcd, LCD_COLS, NULL), LCD_OK);
+    lcdSetText(&lcd, "!", 15, 1);
+    CHECK_EQ(simI2C.tas, 0);
+    lcdFree(&lcd);
+}
+
+static int countReads(void)
+{
+    int i, reads = 0;
+    for (i = 0; i < simI2C.count; i++)
+    {
+        reads += simI2C.log[i].read;
+    }
+    return reads;
+}
+
+static void testReadError(void)
+{
+    lcd_t lcd;
+    lcd_stats_t stats;
+    char screen[2][17];
+    int repaired = -1;
+
+    simReset();
+    sim.rw = 21;
+    CHECK_EQ(lcdCtorI2C(&lcd, &config), LCD_OK);
+    lcdInit(&lcd);
+    lcdSetText(&lcd, "I2C backpack", 0, 0);
+
+    /* A refused read is no desync */
+    simI2C.nack = 1;
+    CHECK_EQ(lcdCheck(&lcd), LCD_OK);
+    lcdGetStats(&lcd, &stats);
+    CHECK_EQ(stats.readErrors, 1);
+    CHECK_EQ(stats.desyncs, 0);
+    CHECK_EQ(stats.recoveries, 0);
+
+    /* Scrub stops at the failed cell and picks it up next time: after
+     * the sync probe, three transactions per nibble, and the address
+     * write the first data read is refused */
+    sim.ddram[0] = 'X';
+    simI2C.nack = 1;
+    simI2C.nackAfter = 7;
+    CHECK_EQ(lcdScrub(&lcd, LCD_COLS, &repaired), LCD_FAIL);
+    CHECK_EQ(repaired, 0);
+    CHECK_EQ(lcdScrub(&lcd, LCD_COLS, &repaired), LCD_OK);
+    CHECK_EQ(repaired, 1);
+    lcdGetStats(&lcd, &stats);
+    CHECK_EQ(stats.readErrors, 2);
+    CHECK_EQ(stats.recoveries, 0);
+
+    /* Address counter put back, writes land where they should */
+    lcdSetText(&lcd, "!", 15, 1);
+    simScreen(screen);
+    CHECK_STR(screen[0], "I2C backpack    ");
+    CHECK_STR(screen[1], "               !");
+    lcdFree(&lcd);
+}
+
+static void testLazyProbe(void)
+{
+    lcd_t lcd;
+    lcd_stats_t stats;
+
+    simReset();
+    sim.rw = 21;
+    CHECK_EQ(lcdCtorI2C(&lcd, &config), LCD_OK);
+    lcdInit(&lcd);
+
+    /* Writes within LCD_PROBE_MS of a probe are not read back */
+    lcdSetText(&lcd, "0", 15, 0);
+    simI2CReset();
+    lcdSetText(&lcd, "1", 0, 0);
+    lcdSetText(&lcd, "2", 1, 0);
+    lcdSetText(&lcd, "3", 2, 0);
+    CHECK_EQ(countReads(), 0);
+
+    /* The next write after it probes once */
+    sim.ticks += pdMS_TO_TICKS(LCD_PROBE_MS);
+    lcdSetText(&lcd, "4", 3, 0);
+    CHECK_EQ(countReads(), 2);
+    lcdSetText(&lcd, "5", 4, 0);
+    CHECK_EQ(countReads(), 2);
+    lcdGetStats(&lcd, &stats);
+    CHECK_EQ(stats.probes, 2);
+
+    /* A lost strobe is still found by the next due probe */
+    sim.dropNext = true;
+    lcdSetText(&lcd, "6", 5, 1);
+    sim.ticks += pdMS_TO_TICKS(LCD_PROBE_MS);
+    lcdSetText(&lcd, "7", 6, 1);
+    lcdGetStats(&lcd, &stats);
+    CHECK_EQ(stats.recoveries, 1);
+    lcdFree(&lcd);
+}
+
+static void testNoRW(void)
+{
+    lcd_t lcd;
+    lcd_i2c_config_t wired = config;
+
+    /* R/W tied to ground, nothing to read with */
+    simReset();
+    wired.map[5] = 8;
+    CHECK_EQ(lcdCtorI2C(&lcd, &wired), LCD_OK);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdScrub(&lcd, 1, NULL), LCD_FAIL);
+    lcdFree(&lcd);
+}
+
+int main(void)
+{
+    testWrite();
+    testRead();
+    testReadWrite();
+    testReadError();
+    testLazyProbe();
+    testNoRW();
+    return SIM_RESULT();
+}
@@ -0,0 +1,106 @@
+/**
+ * @file test_log.c
+ * @brief Log sink, filtering, the log task and the previous output
+ */
+#include <stdarg.h>
+#include <string.h>
+#include "esp_lcd.h"
+#include "esp_log.h"
+#include "sim.h"
+
+static int consoleLines;
+
+static int console(const char *format, va_list args)
+{
+    consoleLines++;
+    return 1;
+}
+
+static void testSink(void)
+{
+    lcd_log_config_t config = {.level = ESP_LOG_WARN, .row = 0, .rows = 2, .intervalMs = 100};
+    lcd_t lcd, other;
+    char screen[2][17];
+    unsigned long datas, ticks;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    esp_log_set_vprintf(console);
+    CHECK_EQ(lcdLogOpen(&lcd, &config), LCD_OK);
+    CHECK_EQ(lcdLogOpen(&lcd, &config), LCD_FAIL);
+
+    /* Logging only copies the line, the log task writes the LCD */
+    datas = sim.datas;
+    ticks = sim.ticks;
+    CHECK_EQ(simLog("I (10) app: %s\n", "info"), 1);
+    CHECK_EQ(simLog("W (12) app: warn %d\n", 1), 1);
+    CHECK_EQ(consoleLines, 2);
+    CHECK_EQ(sim.datas, datas);
+    simRender();
+    simScreen(screen);
+    CHECK_STR(screen[0], "                ");
+    CHECK_STR(screen[1], "warn 1          ");
+    CHECK_EQ(sim.ticks - ticks, 10);
+
+    /* A burst is shown together, colours stripped, newest at the bottom,
+     * lines in another format count as info */
+    CHECK_EQ(simLog("E (13) net: down\n"), 1);
+    CHECK_EQ(simLog("\033[0;33mW (14) app: a very long message\033[0m\n"), 1);
+    CHECK_EQ(simLog("plain line\n"), 1);
+    simRender();
+    simScreen(screen);
+    CHECK_STR(screen[0], "down            ");
+    CHECK_STR(screen[1], "a very long mess");
+    CHECK_EQ(sim.ticks - ticks, 20);
+
+    lcdDefault(&other);
+    CHECK_EQ(lcdLogClose(&other), LCD_FAIL);
+    CHECK_EQ(lcdLogClose(&lcd), LCD_OK);
+
+    /* Closed, the console still gets everything */
+    datas = sim.datas;
+    CHECK_EQ(simLog("E (15) app: gone\n"), 1);
+    CHECK_EQ(consoleLines, 6);
+    simRender();
+    CHECK_EQ(sim.datas, datas);
+    lcdFree(&lcd);
+}
+
+static void testFilter(void)
+{
+    lcd_log_config_t config = {.level = ESP_LOG_INFO, .tag = "net", .row = 1, .rows = 1};
+    lcd_t lcd;
+    char screen[2][17];
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    lcdSetText(&lcd, "title", 0, 0);
+
+    config.rows = 0;
+    CHECK_EQ(lcdLogOpen(&lcd, &config), LCD_FAIL);
+    config.rows = 2;
+    CHECK_EQ(lcdLogOpen(&lcd, &config), LCD_FAIL);
+    config.rows = 1;
+    CHECK_EQ(lcdLogOpen(&lcd, &config), LCD_OK);
+
+    simLog("I (20) net: up\n");
+    simLog("I (21) app: other tag\n");
+    simLog("D (22) net: too verbose\n");
+    simLog("untagged\n");
+    simLog("I (23) net: \x01\tctl\n");
+    simRender();
+    simScreen(screen);
+    CHECK_STR(screen[0], "title           ");
+    CHECK_STR(screen[1], "??ctl           ");
+    CHECK_EQ(lcdLogClose(&lcd), LCD_OK);
+    lcdFree(&lcd);
+}
+
+int main(void)
+{
+    testSink();
+    testFilter();
+    return SIM_RESULT();
+}
@@ -0,0 +1,68 @@
+/**
+ * @file test_pool.c
+ * @brief Static LCD objects, built with LCD_POOL_SIZE 2 and without a pool
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+
+#ifdef LCD_POOL_SIZE
+
+static void testPool(void)
+{
+    lcd_t *a, *b, *c;
+    lcd_t local;
+    char screen[2][17];
+
+    simReset();
+    a = lcdPoolTake();
+    b = lcdPoolTake();
+    CHECK(a != NULL && b != NULL && a != b);
+    CHECK(lcdPoolTake() == NULL);
+
+    /* Constructed and used as usual */
+    lcdDefault(a);
+    lcdInit(a);
+    CHECK_EQ(lcdSetText(a, "pool", 0, 0), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "pool            ");
+
+    /* Kept while it cannot be freed */
+    CHECK_EQ(lcdBegin(a), LCD_OK);
+    CHECK_EQ(lcdPoolGive(a), LCD_FAIL);
+    CHECK(lcdPoolTake() == NULL);
+    CHECK_EQ(lcdCommit(a), LCD_OK);
+
+    /* Freed on the way back, taken again */
+    CHECK_EQ(lcdPoolGive(a), LCD_OK);
+    CHECK_EQ(a->state, LCD_INACTIVE);
+    CHECK(a->bus == NULL);
+    CHECK_EQ(lcdPoolGive(a), LCD_FAIL);
+    c = lcdPoolTake();
+    CHECK(c == a);
+
+    /* Never constructed, and not from the pool */
+    CHECK_EQ(lcdPoolGive(b), LCD_OK);
+    CHECK_EQ(lcdPoolGive(&local), LCD_FAIL);
+    CHECK_EQ(lcdPoolGive(NULL), LCD_FAIL);
+    CHECK_EQ(lcdPoolGive((lcd_t *)c->frame), LCD_FAIL);
+    CHECK_EQ(lcdPoolGive(c), LCD_OK);
+}
+
+#else
+
+static void testPool(void)
+{
+    lcd_t local;
+
+    CHECK(lcdPoolTake() == NULL);
+    CHECK_EQ(lcdPoolGive(&local), LCD_FAIL);
+}
+
+#endif
+
+int main(void)
+{
+    testPool();
+    return SIM_RESULT();
+}
@@ -0,0 +1,95 @@
+/**
+ * @file test_region.c
+ * @brief Regions, z-order and clears around them
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+
+static const uint8_t screen_clear[] = {
+    LCD_PLAY_CLEAR, 0,
+    LCD_PLAY_AT(0, 1), 3, 'n', 'e', 'w',
+};
+
+static void testZ(void)
+{
+    lcd_t lcd;
+    lcd_region_t a, b;
+    char screen[2][17];
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdRegionOpen(&lcd, 0, 0, 4, 1, 128, &a), LCD_FAIL);
+    CHECK_EQ(lcdRegionOpen(&lcd, 0, 0, 4, 1, -129, &a), LCD_FAIL);
+    CHECK_EQ(lcdRegionOpen(&lcd, 0, 0, 4, 1, 1000, &a), LCD_FAIL);
+
+    /* Extremes keep their order */
+    CHECK_EQ(lcdRegionOpen(&lcd, 0, 0, 4, 1, INT8_MAX, &a), LCD_OK);
+    CHECK_EQ(lcdRegionOpen(&lcd, 2, 0, 4, 1, INT8_MIN, &b), LCD_OK);
+    lcdRegionSetText(&lcd, a, "AAAA", 0, 0);
+    lcdRegionSetText(&lcd, b, "BBBB", 0, 0);
+    simScreen(screen);
+    CHECK_STR(screen[0], "AAAABB          ");
+    lcdFree(&lcd);
+}
+
+static void testClear(void)
+{
+    lcd_t lcd;
+    lcd_region_t status;
+    char screen[2][17];
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdRegionOpen(&lcd, 12, 0, 4, 1, 0, &status), LCD_OK);
+    lcdRegionSetText(&lcd, status, "12:00", 0, 0);
+    lcdSetText(&lcd, "menu", 0, 0);
+    lcdSetText(&lcd, "item", 0, 1);
+
+    /* Clear leaves the region on screen */
+    CHECK_EQ(lcdClear(&lcd), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "            12:0");
+    CHECK_STR(screen[1], "                ");
+
+    /* Inside a transaction too */
+    lcdSetText(&lcd, "menu", 0, 0);
+    CHECK_EQ(lcdBegin(&lcd), LCD_OK);
+    CHECK_EQ(lcdClear(&lcd), LCD_OK);
+    CHECK_EQ(lcdSetText(&lcd, "next", 0, 1), LCD_OK);
+    CHECK_EQ(lcdCommit(&lcd), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "            12:0");
+    CHECK_STR(screen[1], "next            ");
+
+    /* Played clears, direct and in a transaction */
+    CHECK_EQ(lcdPlay(&lcd, screen_clear, sizeof(screen_clear)), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "            12:0");
+    CHECK_STR(screen[1], "new             ");
+    lcdSetText(&lcd, "x", 0, 0);
+    CHECK_EQ(lcdBegin(&lcd), LCD_OK);
+    CHECK_EQ(lcdPlay(&lcd, screen_clear, sizeof(screen_clear)), LCD_OK);
+    CHECK_EQ(lcdCommit(&lcd), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "            12:0");
+    CHECK_STR(screen[1], "new             ");
+
+    /* The region is cleared on its own */
+    CHECK_EQ(lcdRegionClear(&lcd, status), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "                ");
+    lcdRegionSetText(&lcd, status, "9:30", 0, 0);
+    simScreen(screen);
+    CHECK_STR(screen[0], "            9:30");
+    lcdFree(&lcd);
+}
+
+int main(void)
+{
+    testZ();
+    testClear();
+    return SIM_RESULT();
+}
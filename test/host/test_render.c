@@ -0,0 +1,121 @@
+/**
+ * @file test_render.c
+ * @brief Render task lanes, takeovers, latency and burst alignment
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+
+static void testLanes(void)
+{
+    lcd_t lcd;
+    lcd_region_t alarm;
+    lcd_stats_t stats;
+    char screen[2][17];
+    unsigned long datas;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdRegionOpen(&lcd, 0, 1, 4, 1, 1, &alarm), LCD_OK);
+    CHECK_EQ(lcdRegionSetLane(&lcd, alarm, LCD_LANE_HIGH), LCD_OK);
+    CHECK_EQ(lcdRegionSetLane(&lcd, alarm, LCD_LANES), LCD_FAIL);
+    CHECK_EQ(lcdRenderStart(&lcd, 1), LCD_OK);
+    CHECK_EQ(lcdRenderStart(&lcd, 1), LCD_FAIL);
+    lcdResetStats(&lcd);
+
+    /* Updates return once they are on the shadow screen */
+    datas = sim.datas;
+    CHECK_EQ(lcdSetText(&lcd, "0123456789ABCDEF", 0, 0), LCD_OK);
+    CHECK_EQ(lcdSetText(&lcd, "low", 0, 1), LCD_OK);
+    CHECK_EQ(sim.datas, datas);
+
+    /* The urgent update takes over the low lane cells it covers */
+    CHECK_EQ(lcdRegionSetText(&lcd, alarm, "HIGH", 0, 0), LCD_OK);
+    CHECK_EQ(sim.datas, datas);
+    simRender();
+    simScreen(screen);
+    CHECK_STR(screen[0], "0123456789ABCDEF");
+    CHECK_STR(screen[1], "HIGH            ");
+
+    lcdGetStats(&lcd, &stats);
+    CHECK_EQ(stats.lanes[LCD_LANE_HIGH].updates, 1);
+    CHECK_EQ(stats.lanes[LCD_LANE_HIGH].cells, 4);
+    CHECK_EQ(stats.lanes[LCD_LANE_LOW].updates, 1);
+    CHECK_EQ(stats.lanes[LCD_LANE_LOW].cells, 16);
+    CHECK_EQ(stats.lanes[LCD_LANE_LOW].cancelled, 3);
+    CHECK(stats.lanes[LCD_LANE_LOW].latencyMaxUs > stats.lanes[LCD_LANE_HIGH].latencyMaxUs);
+    CHECK(stats.lanes[LCD_LANE_LOW].latencyTotalUs >= stats.lanes[LCD_LANE_LOW].latencyMaxUs);
+    CHECK_EQ(sim.datas - datas, 20);
+
+    /* Stop writes what is left and goes back to synchronous writes */
+    CHECK_EQ(lcdSetText(&lcd, "left", 4, 1), LCD_OK);
+    CHECK_EQ(lcdRenderStop(&lcd), LCD_OK);
+    CHECK_EQ(lcdRenderStop(&lcd), LCD_FAIL);
+    simScreen(screen);
+    CHECK_STR(screen[1], "HIGHleft        ");
+    CHECK_EQ(lcdSetText(&lcd, "sync", 12, 1), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[1], "HIGHleft    sync");
+    lcdFree(&lcd);
+}
+
+static void testBursts(void)
+{
+    lcd_t lcd;
+    lcd_region_t alarm;
+    lcd_stats_t stats;
+    char screen[2][17];
+    unsigned long ticks;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdRegionOpen(&lcd, 12, 1, 4, 1, 0, &alarm), LCD_OK);
+    CHECK_EQ(lcdRegionSetLane(&lcd, alarm, LCD_LANE_HIGH), LCD_OK);
+    CHECK_EQ(lcdRenderStart(&lcd, 1), LCD_OK);
+    /* 45 ms rounds up to 5 ticks */
+    CHECK_EQ(lcdRenderSetPeriod(&lcd, 45), LCD_OK);
+    sim.ticks = 12;
+    lcdResetStats(&lcd);
+
+    /* Updates within a period share the burst on its boundary */
+    CHECK_EQ(lcdSetText(&lcd, "a", 0, 0), LCD_OK);
+    CHECK_EQ(lcdSetText(&lcd, "b", 1, 0), LCD_OK);
+    simRender();
+    CHECK_EQ(sim.ticks, 15);
+    lcdGetStats(&lcd, &stats);
+    CHECK_EQ(stats.bursts, 1);
+    CHECK_EQ(stats.wakeups, 1);
+
+    /* High lane work does not wait for the boundary */
+    ticks = sim.ticks + 1;
+    sim.ticks = ticks;
+    CHECK_EQ(lcdRegionSetText(&lcd, alarm, "FIRE", 0, 0), LCD_OK);
+    simRender();
+    CHECK_EQ(sim.ticks, ticks);
+    lcdGetStats(&lcd, &stats);
+    CHECK_EQ(stats.bursts, 2);
+    CHECK_EQ(stats.wakeups, 1);
+    simScreen(screen);
+    CHECK_STR(screen[0], "ab              ");
+    CHECK_STR(screen[1], "            FIRE");
+
+    /* Period 0 writes at once */
+    CHECK_EQ(lcdRenderSetPeriod(&lcd, 0), LCD_OK);
+    CHECK_EQ(lcdSetText(&lcd, "c", 2, 0), LCD_OK);
+    simRender();
+    CHECK_EQ(sim.ticks, ticks);
+    lcdGetStats(&lcd, &stats);
+    CHECK_EQ(stats.bursts, 3);
+
+    CHECK_EQ(lcdRenderStop(&lcd), LCD_OK);
+    lcdFree(&lcd);
+}
+
+int main(void)
+{
+    testLanes();
+    testBursts();
+    return SIM_RESULT();
+}
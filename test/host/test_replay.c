@@ -0,0 +1,159 @@
+/**
+ * @file test_replay.c
+ * @brief Call record of a workload replayed through the driver
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "replay.h"
+#include "sim.h"
+
+static const uint8_t arrow[LCD_GLYPH_ROWS] = {0x00, 0x04, 0x06, 0x1F, 0x06, 0x04, 0x00, 0x00};
+
+static const uint8_t screen_menu[] = {
+    LCD_PLAY_CLEAR, 0,
+    LCD_PLAY_AT(0, 0), 4, 'm', 'e', 'n', 'u',
+    LCD_PLAY_AT(0, 1), 3, '>', 'o', 'k',
+};
+
+static uint8_t log_buf[4096];
+
+/* Calls of every kind, regions included */
+static void workload(lcd_t *lcd)
+{
+    lcd_span_t spans[] = {
+        {.buf = "T=", .len = 2, .x = 0, .y = 1},
+        {.buf = "21.5", .len = 4, .x = 2, .y = 1},
+    };
+    lcd_region_t clock, popup;
+
+    lcdSetText(lcd, "hello", 0, 0);
+    lcdSetInt(lcd, -42, 8, 0);
+    lcdWriteSpans(lcd, spans, 2);
+    CHECK_EQ(lcdRegionOpen(lcd, 11, 0, 5, 1, 0, &clock), LCD_OK);
+    lcdRegionSetText(lcd, clock, "12:00", 0, 0);
+    lcdRegionSetLane(lcd, clock, LCD_LANE_HIGH);
+    lcdClear(lcd);
+    lcdPlay(lcd, screen_menu, sizeof(screen_menu));
+    lcdSetGlyph(lcd, 1, arrow);
+    lcdSetCharset(lcd, LCD_CHARSET_A00);
+    lcdSetText(lcd, "22\xc2\xb0" "C", 0, 1);
+    CHECK_EQ(lcdRegionOpen(lcd, 2, 0, 12, 2, 5, &popup), LCD_OK);
+    lcdRegionSetInt(lcd, popup, 7, 0, 1);
+    lcdRegionShow(lcd, popup, false);
+    lcdRegionSetText(lcd, clock, "12:01", 0, 0);
+    lcdRegionShow(lcd, popup, true);
+    lcdRegionClose(lcd, popup);
+    lcdBegin(lcd);
+    lcdClear(lcd);
+    lcdSetText(lcd, "next", 0, 0);
+    lcdSetGlyph(lcd, 2, arrow);
+    lcdCommit(lcd);
+    lcdRegionClear(lcd, clock);
+    lcdRegionClose(lcd, clock);
+}
+
+static void testReplay(void)
+{
+    lcd_t lcd, again;
+    lcd_record_t rec;
+    replay_report_t rep;
+    unsigned long cmds, datas;
+    FILE *f;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdRecordStart(&lcd, &rec, log_buf, sizeof(log_buf)), LCD_OK);
+    cmds = sim.cmds;
+    datas = sim.datas;
+    workload(&lcd);
+    cmds = sim.cmds - cmds;
+    datas = sim.datas - datas;
+    CHECK_EQ(lcdRecordStop(&lcd), LCD_OK);
+    CHECK_EQ(rec.overflow, 0);
+    CHECK_EQ(rec.calls, 24);
+
+    /* Same calls, same bus bytes, same screen */
+    CHECK(replayRun(&again, rec.buf, rec.len, &rep, NULL) == NULL);
+    CHECK_EQ(rep.calls[LCD_RECORD_TEXT], 3);
+    CHECK_EQ(rep.calls[LCD_RECORD_REGION_OPEN], 2);
+    CHECK_EQ(rep.calls[LCD_RECORD_REGION_TEXT], 3);
+    CHECK_EQ(rep.calls[LCD_RECORD_REGION_SHOW], 2);
+    CHECK_EQ(rep.calls[LCD_RECORD_REGION_CLOSE], 2);
+    CHECK_EQ(rep.calls[LCD_RECORD_REGION_CLEAR], 1);
+    CHECK_EQ(rep.calls[LCD_RECORD_REGION_LANE], 1);
+    CHECK_EQ(rep.cmds, cmds);
+    CHECK_EQ(rep.datas, datas);
+    CHECK(memcmp(again.ddram, lcd.ddram, sizeof(lcd.ddram)) == 0);
+    CHECK(memcmp(again.cgram, lcd.cgram, sizeof(lcd.cgram)) == 0);
+    CHECK(rep.busNs > 0);
+    lcdFree(&again);
+
+    /* For the replay tool */
+    f = fopen("test_replay.lcdr", "wb");
+    CHECK(f != NULL);
+    if (f != NULL)
+    {
+        fwrite(rec.buf, 1, rec.len, f);
+        fclose(f);
+    }
+    lcdFree(&lcd);
+}
+
+static void testRing(void)
+{
+    lcd_t lcd, again;
+    lcd_record_t rec;
+    lcd_ring_t ring;
+    replay_report_t rep;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdRenderStart(&lcd, 1), LCD_OK);
+    CHECK_EQ(lcdRingOpen(&lcd, &ring, LCD_LANE_LOW), LCD_OK);
+    CHECK_EQ(lcdRecordStart(&lcd, &rec, log_buf, sizeof(log_buf)), LCD_OK);
+
+    /* Recorded once the render task applies them */
+    CHECK_EQ(lcdRingPost(&ring, "rpm", 0, 0), LCD_OK);
+    CHECK_EQ(lcdRingPost(&ring, "1200", 4, 0), LCD_OK);
+    CHECK_EQ(rec.calls, 0);
+    simRender();
+    CHECK_EQ(rec.calls, 2);
+    CHECK_EQ(lcdRingPost(&ring, "1300", 4, 0), LCD_OK);
+    CHECK_EQ(lcdRingClose(&ring), LCD_OK);
+    simRender();
+    CHECK_EQ(rec.calls, 3);
+    CHECK_EQ(lcdRecordStop(&lcd), LCD_OK);
+
+    CHECK(replayRun(&again, rec.buf, rec.len, &rep, NULL) == NULL);
+    CHECK_EQ(rep.calls[LCD_RECORD_RING], 3);
+    CHECK(memcmp(again.ddram, lcd.ddram, sizeof(lcd.ddram)) == 0);
+    lcdFree(&again);
+    CHECK_EQ(lcdRenderStop(&lcd), LCD_OK);
+    lcdFree(&lcd);
+}
+
+static void testBad(void)
+{
+    static const uint8_t magic[] = {'L', 'C', 'D', 'X', LCD_RECORD_VERSION, 1, 1, 1, 0};
+    static const uint8_t version[] = {'L', 'C', 'D', 'R', LCD_RECORD_VERSION + 1, 1, 1, 1, 0};
+    static const uint8_t op[] = {'L', 'C', 'D', 'R', LCD_RECORD_VERSION, 1, 1, 1, 0, 99, 0};
+    static const uint8_t truncated[] = {'L', 'C', 'D', 'R', LCD_RECORD_VERSION, 1, 1, 1, 0, LCD_RECORD_TEXT, 0, 0, 0, 5, 'a'};
+    replay_report_t rep;
+    lcd_t lcd;
+
+    simReset();
+    CHECK_STR(replayRun(&lcd, magic, sizeof(magic), &rep, NULL), "not an LCD call record");
+    CHECK_STR(replayRun(&lcd, version, sizeof(version), &rep, NULL), "record version 3, expected 2");
+    CHECK_STR(replayRun(&lcd, op, sizeof(op), &rep, NULL), "unknown op 99 at byte 9");
+    CHECK_STR(replayRun(&lcd, truncated, sizeof(truncated), &rep, NULL), "record truncated at byte 14");
+}
+
+int main(void)
+{
+    testReplay();
+    testRing();
+    testBad();
+    return SIM_RESULT();
+}
@@ -0,0 +1,76 @@
+/**
+ * @file test_ring.c
+ * @brief Producer rings, posts, bounds and teardown
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+
+static void testPost(void)
+{
+    lcd_t lcd;
+    lcd_ring_t ring;
+    char screen[2][17];
+    int i;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdRingOpen(&lcd, &ring, LCD_LANE_LOW), LCD_FAIL);
+    CHECK_EQ(lcdRenderStart(&lcd, 1), LCD_OK);
+    CHECK_EQ(lcdRingOpen(&lcd, &ring, LCD_LANE_LOW), LCD_OK);
+
+    /* Applied by the render task */
+    CHECK_EQ(lcdRingPost(&ring, "ring", 0, 0), LCD_OK);
+    CHECK_EQ(lcdRingPost(&ring, "post", 12, 1), LCD_OK);
+    CHECK_EQ(sim.datas, 0);
+    simRender();
+    simScreen(screen);
+    CHECK_STR(screen[0], "ring            ");
+    CHECK_STR(screen[1], "            post");
+
+    /* Locations a post cannot hold, or lcdSetText does not take */
+    CHECK_EQ(lcdRingPost(&ring, "x", -1, 0), LCD_FAIL);
+    CHECK_EQ(lcdRingPost(&ring, "x", 128, 0), LCD_FAIL);
+    CHECK_EQ(lcdRingPost(&ring, "x", 0, -1), LCD_FAIL);
+    CHECK_EQ(lcdRingPost(&ring, "x", 0, 4), LCD_FAIL);
+    CHECK_EQ(lcdRingPost(&ring, "x", 0, 256), LCD_FAIL);
+    CHECK_EQ(lcdRingPost(&ring, "0123456789abcdefg", 0, 0), LCD_FAIL);
+    CHECK_EQ(ring.head, 2);
+
+    /* Full ring refuses and counts */
+    for (i = 0; i < LCD_RING_SIZE; i++)
+    {
+        CHECK_EQ(lcdRingPost(&ring, "f", i % LCD_COLS, 0), LCD_OK);
+    }
+    CHECK_EQ(lcdRingPost(&ring, "f", 0, 0), LCD_FAIL);
+    CHECK_EQ(ring.dropped, 1);
+    simRender();
+    simScreen(screen);
+    CHECK_STR(screen[0], "ffffffffffffffff");
+
+    /* Neither the render task nor the object go while the ring is open */
+    CHECK_EQ(lcdRenderStop(&lcd), LCD_FAIL);
+    CHECK_EQ(lcdFree(&lcd), LCD_FAIL);
+    CHECK_EQ(lcdRingPost(&ring, "still", 0, 1), LCD_OK);
+    simRender();
+    simScreen(screen);
+    CHECK_STR(screen[1], "still       post");
+
+    /* Close applies what is left, the render task writes it */
+    CHECK_EQ(lcdRingPost(&ring, "last", 0, 0), LCD_OK);
+    CHECK_EQ(lcdRingClose(&ring), LCD_OK);
+    simRender();
+    simScreen(screen);
+    CHECK_STR(screen[0], "lastffffffffffff");
+    CHECK_EQ(lcdRingPost(&ring, "late", 0, 0), LCD_FAIL);
+    CHECK_EQ(lcdRingClose(&ring), LCD_FAIL);
+    CHECK_EQ(lcdFree(&lcd), LCD_OK);
+    CHECK_EQ(sim.deadlock, 0);
+}
+
+int main(void)
+{
+    testPost();
+    return SIM_RESULT();
+}
@@ -0,0 +1,47 @@
+/**
+ * @file test_screen.c
+ * @brief Screens compiled by tools/lcd_screen.py, mapped like lcdSetText
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+#include "screen_a00.h"
+#include "screen_a02.h"
+
+/* Same text as test_screen.screen, through the driver charset */
+static void expect(lcd_charset_t charset, uint8_t ddram[128])
+{
+    lcd_t lcd;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    lcdSetCharset(&lcd, charset);
+    lcdSetText(&lcd, "22\xc2\xb0" "C \"ok\" # 5\xc2\xb5s", 0, 0);
+    lcdSetText(&lcd, "\xc3\x9f\xe2\x86\x92\xc3\xbc\x01", 0, 1);
+    memcpy(ddram, sim.ddram, sizeof(sim.ddram));
+    lcdFree(&lcd);
+}
+
+static void testScreen(lcd_charset_t charset, const uint8_t *stream, size_t size)
+{
+    uint8_t ddram[128];
+    lcd_t lcd;
+
+    expect(charset, ddram);
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdPlay(&lcd, stream, size), LCD_OK);
+    CHECK(memcmp(sim.ddram, ddram, sizeof(ddram)) == 0);
+    CHECK_EQ(sim.ddram[2], charset == LCD_CHARSET_A00 ? 0xDF : 0xB0);
+    CHECK_EQ(sim.cgram[8 + 3], 0x1F);
+    lcdFree(&lcd);
+}
+
+int main(void)
+{
+    testScreen(LCD_CHARSET_A00, screen_a00, sizeof(screen_a00));
+    testScreen(LCD_CHARSET_A02, screen_a02, sizeof(screen_a02));
+    return SIM_RESULT();
+}
@@ -0,0 +1,115 @@
+/**
+ * @file test_spi.c
+ * @brief 74HC595 shift register bus
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+#include "sim_spi.h"
+
+/* Register outputs with LCD_SPI_595_MAP */
+#define Q_DATA  0x0F
+#define Q_RS    0x10
+#define Q_EN    0x40
+#define Q_BL    0x80
+
+static const lcd_spi_config_t config = {
+    .host = 1,
+    .mosi = 13,
+    .sclk = 14,
+    .latch = 15,
+    .clockHz = LCD_SPI_CLOCK_HZ,
+    .map = LCD_SPI_595_MAP,
+};
+
+static void testStates(void)
+{
+    lcd_t lcd;
+    uint8_t bytes[8], rs[8], prev = 0, hi = 0;
+    int i, count = 0, nibbles = 0, setups = 0;
+
+    simReset();
+    simSpiReset();
+    CHECK_EQ(lcdCtorSPI(&lcd, &config), LCD_OK);
+    lcdInit(&lcd);
+
+    simSpiReset();
+    CHECK_EQ(lcdSetText(&lcd, "AB", 0, 1), LCD_OK);
+    for (i = 0; i < simSpi.count; i++)
+    {
+        uint8_t cur = simSpi.log[i];
+        /* Unused QF stays low, backlight stays on */
+        CHECK_EQ(cur & 0x20, 0);
+        CHECK(cur & Q_BL);
+        if (!(prev & Q_EN) && (cur & Q_EN) && i > 0)
+        {
+            /* EN rises with RS and data already in place */
+            CHECK_EQ(prev & Q_RS, cur & Q_RS);
+        }
+        if (!(cur & Q_EN) && i + 1 < simSpi.count && ((cur ^ prev) & Q_RS))
+        {
+            /* RS setup state */
+            CHECK(simSpi.log[i + 1] & Q_EN);
+            CHECK_EQ(simSpi.log[i + 1] & (Q_RS | Q_DATA), cur & (Q_RS | Q_DATA));
+            setups++;
+        }
+        if ((prev & Q_EN) && !(cur & Q_EN))
+        {
+            /* EN falls, data held */
+            CHECK_EQ(prev & (Q_RS | Q_DATA), cur & (Q_RS | Q_DATA));
+            if (nibbles++ % 2 == 0)
+            {
+                hi = prev & Q_DATA;
+            }
+            else if (count < 8)
+            {
+                bytes[count] = (hi << 4) | (prev & Q_DATA);
+                rs[count++] = prev & Q_RS;
+            }
+        }
+        prev = cur;
+    }
+
+    CHECK_EQ(count, 3);
+    CHECK_EQ(bytes[0], 0xC0);
+    CHECK_EQ(rs[0], 0);
+    CHECK_EQ(bytes[1], 'A');
+    CHECK_EQ(bytes[2], 'B');
+    CHECK_EQ(rs[1] & rs[2], Q_RS);
+    CHECK_EQ(setups, 1);
+    /* RS unchanged since lcdInit, no setup state before the first EN rise */
+    CHECK_EQ(simSpi.log[0], Q_BL | Q_EN | 0x0C);
+    lcdFree(&lcd);
+}
+
+static void testScreen(void)
+{
+    lcd_t lcd;
+    char screen[2][17];
+
+    simReset();
+    simSpiReset();
+    CHECK_EQ(lcdCtorSPI(&lcd, &config), LCD_OK);
+    lcdInit(&lcd);
+    lcdSetText(&lcd, "74HC595 over SPI", 0, 0);
+    lcdSetInt(&lcd, -42, 5, 1);
+    simScreen(screen);
+    CHECK_STR(screen[0], "74HC595 over SPI");
+    CHECK_STR(screen[1], "     -42        ");
+    /* Not readable */
+    CHECK_EQ(lcdScrub(&lcd, 1, NULL), LCD_FAIL);
+
+    /* States of the last flush are collected on release */
+    CHECK(simSpi.pending > 0);
+    lcdFree(&lcd);
+    CHECK_EQ(simSpi.pending, 0);
+    CHECK(simSpi.maxPending <= 64);
+    CHECK_EQ(sim.deadlock, 0);
+}
+
+int main(void)
+{
+    testStates();
+    testScreen();
+    return SIM_RESULT();
+}
@@ -0,0 +1,110 @@
+/**
+ * @file test_term.c
+ * @brief ANSI terminal, scrolling, escape sequences and the VFS device
+ */
+#include <string.h>
+#include <sys/stat.h>
+#include "esp_lcd.h"
+#include "sim.h"
+
+static void testText(void)
+{
+    lcd_t lcd;
+    lcd_term_t term;
+    char screen[2][17];
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    lcdSetText(&lcd, "old", 0, 0);
+    CHECK_EQ(lcdTermOpen(&lcd, &term, NULL), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "                ");
+
+    /* Bottom line scrolls up */
+    CHECK_EQ(lcdTermWrite(&term, "one\ntwo\nthree", 13), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "two             ");
+    CHECK_STR(screen[1], "three           ");
+
+    /* A full line and a newline leave no blank line */
+    CHECK_EQ(lcdTermWrite(&term, "\r0123456789ABCDEF\nx", 19), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "0123456789ABCDEF");
+    CHECK_STR(screen[1], "x               ");
+
+    /* Tab, backspace, carriage return */
+    CHECK_EQ(lcdTermWrite(&term, "\ty\bz\rw", 6), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[1], "w   z           ");
+    CHECK_EQ(lcdTermClose(&term), LCD_OK);
+    CHECK_EQ(lcdTermClose(&term), LCD_FAIL);
+    CHECK_EQ(lcdTermWrite(&term, "x", 1), LCD_FAIL);
+    lcdFree(&lcd);
+}
+
+static void testEscape(void)
+{
+    static const char seq[] = "\x1b[2;5HX\x1b[1;3H\x1b[1KY\x1b[31m\x1b[5C\x1b[BZ";
+    lcd_t lcd;
+    lcd_term_t term;
+    char screen[2][17];
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdTermOpen(&lcd, &term, NULL), LCD_OK);
+    CHECK_EQ(lcdTermWrite(&term, "abcdefgh", 8), LCD_OK);
+
+    /* Position, erase to cursor, colours ignored, movement */
+    CHECK_EQ(lcdTermWrite(&term, seq, sizeof(seq) - 1), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "  Ydefgh        ");
+    CHECK_STR(screen[1], "    X   Z       ");
+
+    /* Erase in line, erase in display, out of range positions clamp */
+    CHECK_EQ(lcdTermWrite(&term, "\x1b[1;6H\x1b[K\x1b[9;99HQ", 19), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "  Yde           ");
+    CHECK_STR(screen[1], "    X   Z      Q");
+    CHECK_EQ(lcdTermWrite(&term, "\x1b[2J", 4), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "                ");
+    CHECK_STR(screen[1], "                ");
+    lcdTermClose(&term);
+    lcdFree(&lcd);
+}
+
+static void testDevice(void)
+{
+    lcd_t lcd;
+    lcd_term_t term;
+    char screen[2][17];
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    lcdSetCharset(&lcd, LCD_CHARSET_A00);
+    CHECK_EQ(lcdTermOpen(&lcd, &term, "/dev/lcd"), LCD_OK);
+    CHECK_STR(simVfsPath, "/dev/lcd");
+    CHECK_EQ(simVfsMode(), S_IFCHR);
+
+    /* UTF-8 split across writes */
+    CHECK_EQ(simVfsWrite("T=21\xc2"), 5);
+    CHECK_EQ(simVfsWrite("\xb0" "C"), 2);
+    simScreen(screen);
+    CHECK_STR(screen[0], "T=21\xdf" "C          ");
+
+    CHECK_EQ(lcdTermClose(&term), LCD_OK);
+    CHECK_STR(simVfsPath, "");
+    CHECK_EQ(lcdTermOpen(&lcd, &term, "/dev/a/path/longer/than/the/terminal/keeps"), LCD_FAIL);
+    lcdFree(&lcd);
+}
+
+int main(void)
+{
+    testText();
+    testEscape();
+    testDevice();
+    return SIM_RESULT();
+}
@@ -0,0 +1,116 @@
+/**
+ * @file test_trace.c
+ * @brief Bus trace ring and its VCD export
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+
+static lcd_trace_t trace;
+
+/* VCD of the trace, NUL terminated, freed by the caller */
+static char *vcd(const lcd_trace_t *t)
+{
+    FILE *f = tmpfile();
+    char *text;
+    long len;
+
+    CHECK_EQ(lcdTraceVcd(t, f), LCD_OK);
+    len = ftell(f);
+    text = calloc(1, len + 1);
+    rewind(f);
+    CHECK_EQ(fread(text, 1, len, f), len);
+    fclose(f);
+    return text;
+}
+
+static void testTrace(void)
+{
+    lcd_t lcd;
+    uint32_t i, rise = 0, count;
+    uint8_t prev = 0, hi = 0, half = 0, last = 0, rs = 0;
+    char *text;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdTraceStop(&lcd), LCD_FAIL);
+    CHECK_EQ(lcdTraceStart(&lcd, &trace), LCD_OK);
+    CHECK_EQ(trace.cpuMhz, 240);
+    CHECK_EQ(lcdSetText(&lcd, "A", 0, 0), LCD_OK);
+    CHECK(trace.count > 0 && trace.count < LCD_TRACE_SIZE);
+
+    /* Bytes decode from the falling EN edges, pulses are long enough */
+    for (i = 0; i < trace.count; i++)
+    {
+        lcd_trace_sample_t *s = &trace.samples[i];
+        if (!(prev & LCD_LINE_EN) && (s->lines & LCD_LINE_EN))
+        {
+            rise = s->cycles;
+        }
+        if ((prev & LCD_LINE_EN) && !(s->lines & LCD_LINE_EN))
+        {
+            CHECK((s->cycles - rise) * 1000 / trace.cpuMhz >= lcd.timing.pulseNs);
+            if (half)
+            {
+                last = (hi << 4) | (prev & LCD_LINE_DATA);
+                rs = prev & LCD_LINE_RS;
+            }
+            hi = prev & LCD_LINE_DATA;
+            half ^= 1;
+        }
+        CHECK(i == 0 || s->cycles >= trace.samples[i - 1].cycles);
+        prev = s->lines;
+    }
+    CHECK_EQ(last, 'A');
+    CHECK(rs);
+
+    text = vcd(&trace);
+    CHECK(strstr(text, "$timescale 1ns $end") != NULL);
+    CHECK(strstr(text, "$var wire 1 ' EN $end") != NULL);
+    CHECK(strstr(text, "$dumpvars\n0!\n") != NULL);
+    CHECK(strstr(text, "\n1'\n") != NULL);
+    free(text);
+
+    /* Stopped, nothing more is taken */
+    count = trace.count;
+    CHECK_EQ(lcdTraceStop(&lcd), LCD_OK);
+    lcdSetText(&lcd, "B", 1, 0);
+    CHECK_EQ(trace.count, count);
+    lcdFree(&lcd);
+}
+
+static void testWrap(void)
+{
+    lcd_t lcd;
+    char *text;
+    int i;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdTraceStart(&lcd, &trace), LCD_OK);
+    for (i = 0; i < 8; i++)
+    {
+        lcdSetText(&lcd, i & 1 ? "0123456789ABCDEF" : "FEDCBA9876543210", 0, 0);
+    }
+    CHECK(trace.count > LCD_TRACE_SIZE);
+
+    /* Lines unknown until the first kept transition */
+    text = vcd(&trace);
+    CHECK(strstr(text, "$dumpvars\nx!\n") != NULL);
+    free(text);
+
+    trace.cpuMhz = 0;
+    CHECK_EQ(lcdTraceVcd(&trace, stdout), LCD_FAIL);
+    lcdTraceStop(&lcd);
+    lcdFree(&lcd);
+}
+
+int main(void)
+{
+    testTrace();
+    testWrap();
+    return SIM_RESULT();
+}
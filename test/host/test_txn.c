@@ -0,0 +1,151 @@
+/**
+ * @file test_txn.c
+ * @brief Transactions, deferred glyph and play writes, lcdFree
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+
+static const uint8_t arrow[LCD_GLYPH_ROWS] = {0x00, 0x04, 0x06, 0x1F, 0x06, 0x04, 0x00, 0x00};
+
+static const uint8_t screen_play[] = {
+    LCD_PLAY_CLEAR, 0,
+    LCD_PLAY_GLYPH(1), 8, 0x00, 0x04, 0x06, 0x1F, 0x06, 0x04, 0x00, 0x00,
+    LCD_PLAY_AT(0, 0), 5, 'p', 'l', 'a', 'y', 1,
+    LCD_PLAY_AT(3, 1), 2, 'o', 'k',
+};
+
+/* Bus traffic so far */
+static unsigned long simWrites(void)
+{
+    return sim.cmds + sim.datas;
+}
+
+static void testGlyph(void)
+{
+    lcd_t lcd;
+    char screen[2][17];
+    unsigned long writes;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+
+    /* Glyph and text go out together on commit */
+    CHECK_EQ(lcdBegin(&lcd), LCD_OK);
+    writes = simWrites();
+    CHECK_EQ(lcdSetGlyph(&lcd, 2, arrow), LCD_OK);
+    CHECK_EQ(lcdSetText(&lcd, "go\x02", 0, 0), LCD_OK);
+    CHECK_EQ(simWrites(), writes);
+    CHECK_EQ(lcdCommit(&lcd), LCD_OK);
+    CHECK(memcmp(&sim.cgram[2 * LCD_GLYPH_ROWS], arrow, LCD_GLYPH_ROWS) == 0);
+    simScreen(screen);
+    CHECK_STR(screen[0], "go\x02             ");
+
+    /* Fallback glyph allocated inside a transaction */
+    CHECK_EQ(lcdSetCharset(&lcd, LCD_CHARSET_A00), LCD_OK);
+    CHECK_EQ(lcdBegin(&lcd), LCD_OK);
+    writes = simWrites();
+    CHECK_EQ(lcdSetText(&lcd, "a~b", 0, 1), LCD_OK);
+    CHECK_EQ(simWrites(), writes);
+    CHECK_EQ(lcdCommit(&lcd), LCD_OK);
+    simScreen(screen);
+    CHECK_EQ(screen[1][0], 'a');
+    CHECK(screen[1][1] >= LCD_GLYPHS && screen[1][1] < 2 * LCD_GLYPHS);
+    CHECK_EQ(screen[1][2], 'b');
+    CHECK(memcmp(&sim.cgram[(screen[1][1] - LCD_GLYPHS) * LCD_GLYPH_ROWS], lcd.cgram[screen[1][1] - LCD_GLYPHS],
+                 LCD_GLYPH_ROWS) == 0);
+    CHECK(sim.cgram[(screen[1][1] - LCD_GLYPHS) * LCD_GLYPH_ROWS + 3] != 0);
+    lcdFree(&lcd);
+}
+
+static void testPlay(void)
+{
+    lcd_t lcd;
+    char screen[2][17];
+    unsigned long writes;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    lcdSetText(&lcd, "old text", 0, 1);
+
+    CHECK_EQ(lcdBegin(&lcd), LCD_OK);
+    writes = simWrites();
+    CHECK_EQ(lcdPlay(&lcd, screen_play, sizeof(screen_play)), LCD_OK);
+    CHECK_EQ(lcdSetText(&lcd, "!", 5, 0), LCD_OK);
+    CHECK_EQ(simWrites(), writes);
+    simScreen(screen);
+    CHECK_STR(screen[1], "old text        ");
+    CHECK_EQ(lcdCommit(&lcd), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "play\x01!          ");
+    CHECK_STR(screen[1], "   ok           ");
+    CHECK(memcmp(&sim.cgram[1 * LCD_GLYPH_ROWS], arrow, LCD_GLYPH_ROWS) == 0);
+
+    /* Outside a transaction the stream goes straight out */
+    lcdSetText(&lcd, "x", 15, 1);
+    writes = simWrites();
+    CHECK_EQ(lcdPlay(&lcd, screen_play, sizeof(screen_play)), LCD_OK);
+    CHECK(simWrites() > writes);
+    simScreen(screen);
+    CHECK_STR(screen[0], "play\x01           ");
+    CHECK_STR(screen[1], "   ok           ");
+    lcdFree(&lcd);
+}
+
+static void testZeroCmd(void)
+{
+    lcd_t lcd;
+    char screen[2][17];
+
+    /* Deferred clear with a zero instruction time */
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    lcdSetText(&lcd, "0123456789abcdef", 0, 0);
+    lcd.timing.cmdUs = 0;
+    CHECK_EQ(lcdBegin(&lcd), LCD_OK);
+    CHECK_EQ(lcdClear(&lcd), LCD_OK);
+    CHECK_EQ(lcdSetText(&lcd, "z", 0, 1), LCD_OK);
+    CHECK_EQ(lcdCommit(&lcd), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "                ");
+    CHECK_STR(screen[1], "z               ");
+    lcdFree(&lcd);
+}
+
+static void testFree(void)
+{
+    lcd_t lcd;
+
+    simReset();
+    simLockDeletedHeld = 0;
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+
+    /* Not from inside a transaction */
+    CHECK_EQ(lcdBegin(&lcd), LCD_OK);
+    CHECK_EQ(lcdBegin(&lcd), LCD_OK);
+    CHECK_EQ(lcdFree(&lcd), LCD_FAIL);
+    CHECK_EQ(lcdCommit(&lcd), LCD_OK);
+    CHECK_EQ(lcdFree(&lcd), LCD_FAIL);
+    CHECK_EQ(lcdCommit(&lcd), LCD_OK);
+    CHECK_EQ(lcdSetText(&lcd, "alive", 0, 0), LCD_OK);
+
+    /* Lock released on every level before it is deleted */
+    CHECK_EQ(lcdFree(&lcd), LCD_OK);
+    CHECK_EQ(simLockDeletedHeld, 0);
+    CHECK(lcd.lock == NULL);
+    CHECK_EQ(lcdSetText(&lcd, "gone", 0, 0), LCD_FAIL);
+    CHECK_EQ(lcdBegin(&lcd), LCD_FAIL);
+}
+
+int main(void)
+{
+    testGlyph();
+    testPlay();
+    testZeroCmd();
+    testFree();
+    return SIM_RESULT();
+}
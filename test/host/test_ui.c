@@ -0,0 +1,136 @@
+/**
+ * @file test_ui.c
+ * @brief Widgets, layout, keys, encoder steps and partial redraws
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+
+static int hookKeys[4];
+static lcd_ui_t *hookUi;
+
+static void hook(lcd_widget_t *widget, lcd_ui_key_t key, void *arg)
+{
+    hookKeys[key]++;
+    if (key == LCD_UI_KEY_OK)
+    {
+        lcdUiFocus(hookUi, arg);
+    }
+}
+
+static void testNumber(void)
+{
+    lcd_t lcd;
+    lcd_ui_t ui;
+    lcd_widget_t title, temp, status, small;
+    char screen[2][17];
+    unsigned long datas;
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    lcdSetCharset(&lcd, LCD_CHARSET_A00);
+    lcdSetText(&lcd, "boot", 0, 0);
+    CHECK_EQ(lcdUiInit(&ui, &lcd), LCD_OK);
+    CHECK_EQ(lcdUiLabel(&ui, &title, 0, 0, 6, "Temp"), LCD_OK);
+    CHECK_EQ(lcdUiNumber(&ui, &temp, 6, 0, 10, -50, 150, "\xc2\xb0" "C"), LCD_OK);
+    CHECK_EQ(lcdUiLabel(&ui, &status, 0, 1, 16, "ok"), LCD_OK);
+    CHECK_EQ(lcdUiLabel(&ui, &small, 10, 1, 7, "x"), LCD_FAIL);
+    CHECK_EQ(lcdUiNumber(&ui, &small, 0, 1, 3, 5, 4, NULL), LCD_FAIL);
+
+    CHECK_EQ(lcdUiShow(&ui), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "Temp       -50\xdf" "C");
+    CHECK_STR(screen[1], "ok              ");
+
+    /* Only the digits that change go out */
+    CHECK_EQ(lcdUiInput(&ui, LCD_UI_KEY_UP), LCD_FAIL);
+    CHECK_EQ(lcdUiFocus(&ui, &temp), LCD_OK);
+    datas = sim.datas;
+    CHECK_EQ(lcdUiInput(&ui, LCD_UI_KEY_UP), LCD_OK);
+    CHECK_EQ(sim.datas - datas, 2);
+    simScreen(screen);
+    CHECK_STR(screen[0], "Temp       -49\xdf" "C");
+
+    /* Encoder detents, one redraw */
+    datas = sim.datas;
+    CHECK_EQ(lcdUiRotate(&ui, 3), LCD_OK);
+    CHECK_EQ(sim.datas - datas, 1);
+    CHECK_EQ(temp.value, -46);
+    CHECK_EQ(lcdUiRotate(&ui, -100), LCD_OK);
+    CHECK_EQ(temp.value, -50);
+
+    /* Range and width */
+    CHECK_EQ(lcdUiSetValue(&ui, &temp, 1000), LCD_OK);
+    CHECK_EQ(lcdUiSetText(&ui, &status, "hot"), LCD_OK);
+    CHECK_EQ(lcdUiSetValue(&ui, &status, 1), LCD_FAIL);
+    CHECK_EQ(lcdUiRender(&ui), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "Temp       150\xdf" "C");
+    CHECK_STR(screen[1], "hot             ");
+    CHECK_EQ(lcdUiNumber(&ui, &small, 13, 1, 3, 0, 999, "\xc2\xb0" "C"), LCD_OK);
+    CHECK_EQ(lcdUiSetValue(&ui, &small, 100), LCD_OK);
+    CHECK_EQ(lcdUiRender(&ui), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[1], "hot          ***");
+    CHECK_EQ(lcdUiSetValue(&ui, &small, 9), LCD_OK);
+    CHECK_EQ(lcdUiRender(&ui), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[1], "hot          9\xdf" "C");
+    lcdFree(&lcd);
+}
+
+static void testList(void)
+{
+    static const char *const items[] = {"alpha", "beta", "gamma", "delta"};
+    lcd_t lcd;
+    lcd_ui_t ui;
+    lcd_widget_t menu, value, bad;
+    char screen[2][17];
+
+    simReset();
+    lcdDefault(&lcd);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdUiInit(&ui, &lcd), LCD_OK);
+    CHECK_EQ(lcdUiList(&ui, &bad, 0, 0, 2, 2, items, 4), LCD_FAIL);
+    CHECK_EQ(lcdUiList(&ui, &menu, 0, 0, 12, 2, items, 4), LCD_OK);
+    CHECK_EQ(lcdUiNumber(&ui, &value, 12, 0, 4, 0, 99, NULL), LCD_OK);
+    CHECK_EQ(lcdUiSetText(&ui, &menu, "x"), LCD_FAIL);
+    CHECK_EQ(lcdUiShow(&ui), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], ">alpha         0");
+    CHECK_STR(screen[1], " beta      v    ");
+
+    /* Down moves the selection, the list scrolls along */
+    CHECK_EQ(lcdUiFocus(&ui, &menu), LCD_OK);
+    CHECK_EQ(lcdUiInput(&ui, LCD_UI_KEY_DOWN), LCD_OK);
+    CHECK_EQ(lcdUiInput(&ui, LCD_UI_KEY_DOWN), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], " beta      ^   0");
+    CHECK_STR(screen[1], ">gamma     v    ");
+    CHECK_EQ(lcdUiRotate(&ui, 5), LCD_OK);
+    CHECK_EQ(menu.value, 3);
+    simScreen(screen);
+    CHECK_STR(screen[0], " gamma     ^   0");
+    CHECK_STR(screen[1], ">delta          ");
+
+    /* The hook runs after the key and may move the focus */
+    hookUi = &ui;
+    CHECK_EQ(lcdUiSetHook(&ui, &menu, hook, &value), LCD_OK);
+    CHECK_EQ(lcdUiRotate(&ui, -1), LCD_OK);
+    CHECK_EQ(hookKeys[LCD_UI_KEY_UP], 1);
+    CHECK_EQ(lcdUiInput(&ui, LCD_UI_KEY_OK), LCD_OK);
+    CHECK_EQ(hookKeys[LCD_UI_KEY_OK], 1);
+    CHECK(ui.focus == &value);
+    CHECK_EQ(lcdUiInput(&ui, LCD_UI_KEY_UP), LCD_OK);
+    CHECK_EQ(menu.value, 2);
+    CHECK_EQ(value.value, 1);
+    lcdFree(&lcd);
+}
+
+int main(void)
+{
+    testNumber();
+    testList();
+    return SIM_RESULT();
+}
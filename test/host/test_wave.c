@@ -0,0 +1,122 @@
+/**
+ * @file test_wave.c
+ * @brief Waveform encoder and DMA parallel bus
+ */
+#include <string.h>
+#include "esp_lcd.h"
+#include "sim.h"
+
+extern unsigned long simI80Tx, simI80Bytes;
+
+/* Bus line i on output bit i, EN on bit 6, bit 7 idles high */
+static const lcd_wave_t wave = {
+    .map = {0, 1, 2, 3, 4, 8, 6, 8},
+    .idle = 0x80,
+    .setup = 2,
+    .pulse = 3,
+    .hold = 1,
+};
+
+static void testMap(void)
+{
+    CHECK_EQ(lcdWaveMap(&wave, 0), 0x80);
+    CHECK_EQ(lcdWaveMap(&wave, 0x0F | LCD_LINE_RS), 0x9F);
+    /* R/W is not wired, EN moves to bit 6 */
+    CHECK_EQ(lcdWaveMap(&wave, LCD_LINE_RW), 0x80);
+    CHECK_EQ(lcdWaveMap(&wave, LCD_LINE_EN), 0xC0);
+}
+
+static void testPhases(void)
+{
+    uint8_t buf[16];
+    const uint8_t low = 0x80 | 0x10 | 0x05, high = low | 0x40;
+    size_t n, i;
+
+    memset(buf, 0xEE, sizeof(buf));
+    /* EN and R/W in lines are ignored, the encoder strobes EN itself */
+    n = lcdWaveEncode(&wave, 0x05 | LCD_LINE_RS | LCD_LINE_EN | LCD_LINE_RW, 4, buf, sizeof(buf));
+    CHECK_EQ(n, 2 + 3 + 1 + 4);
+    for (i = 0; i < 2; i++)
+    {
+        CHECK_EQ(buf[i], low);          /* setup, EN low */
+    }
+    for (; i < 5; i++)
+    {
+        CHECK_EQ(buf[i], high);         /* pulse, EN high */
+    }
+    for (; i < n; i++)
+    {
+        CHECK_EQ(buf[i], low);          /* hold and wait padding, EN low */
+    }
+    CHECK_EQ(buf[n], 0xEE);             /* nothing past the end */
+}
+
+static void testNoSetup(void)
+{
+    lcd_wave_t w = wave;
+    uint8_t buf[4];
+
+    w.setup = 0;
+    w.hold = 0;
+    CHECK_EQ(lcdWaveEncode(&w, 0x0A, 0, buf, sizeof(buf)), 3);
+    CHECK_EQ(buf[0], 0xCA);
+    CHECK_EQ(buf[2], 0xCA);
+}
+
+static void testFull(void)
+{
+    uint8_t buf[16];
+
+    memset(buf, 0xEE, sizeof(buf));
+    /* setup + pulse + hold + wait = 10 */
+    CHECK_EQ(lcdWaveEncode(&wave, 0, 4, buf, 9), 0);
+    CHECK_EQ(buf[0], 0xEE);
+    CHECK_EQ(lcdWaveEncode(&wave, 0, 4, buf, 10), 10);
+    CHECK_EQ(lcdWaveEncode(&wave, 0, 0xFFFFFFFF, buf, sizeof(buf)), 0);
+}
+
+static void testDma(void)
+{
+    lcd_t lcd;
+    char screen[2][17];
+    int i;
+    lcd_dma_config_t config = {
+        .data = {19, 18, 17, 16},
+        .regSel = 23,
+        .rw = GPIO_NUM_NC,
+        .en = 22,
+        .bl = GPIO_NUM_NC,
+        .wr = GPIO_NUM_NC,
+        .dc = GPIO_NUM_NC,
+        .clockHz = LCD_DMA_CLOCK_HZ,
+        .bufSize = LCD_DMA_BUF_SIZE,
+    };
+
+    simReset();
+    CHECK_EQ(lcdCtorDMA(&lcd, &config), LCD_OK);
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+        CHECK_EQ(lcd.data[i], config.data[i]);
+    }
+    CHECK_EQ(lcd.en, 22);
+    CHECK_EQ(lcd.regSel, 23);
+    lcdInit(&lcd);
+    CHECK_EQ(lcdSetText(&lcd, "DMA hello", 0, 0), LCD_OK);
+    CHECK_EQ(lcdSetInt(&lcd, 1234, 12, 1), LCD_OK);
+    simScreen(screen);
+    CHECK_STR(screen[0], "DMA hello       ");
+    CHECK_STR(screen[1], "            1234");
+    CHECK(simI80Tx > 0);
+    CHECK_EQ(sim.deadlock, 0);
+    lcdFree(&lcd);
+}
+
+int main(void)
+{
+    testMap();
+    testPhases();
+    testNoSetup();
+    testFull();
+    testDma();
+    return SIM_RESULT();
+}
@@ -0,0 +1,3535 @@
+/**
+ * @file esp_lcd.c
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display source file
+ * @version 0.1
+ * @date 2022-08-15
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_idf_version.h"
+#include "esp_lcd.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "soc/soc_caps.h"
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include "esp_cpu.h"
+#else
+#include "hal/cpu_hal.h"
+#endif
+
+/* Dedicated GPIO bus, set LCD_DEDIC_GPIO to 0 to always use the GPIO bus */
+#ifndef LCD_DEDIC_GPIO
+#define LCD_DEDIC_GPIO 1
+#endif
+#if LCD_DEDIC_GPIO && SOC_DEDICATED_GPIO_SUPPORTED && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)
+#define LCD_USE_DEDIC_GPIO 1
+#include "driver/dedic_gpio.h"
+#include "esp_rom_gpio.h"
+#include "soc/dedic_gpio_periph.h"
+#else
+#define LCD_USE_DEDIC_GPIO 0
+#endif
+
+/* Static instance pool, set LCD_POOL_SIZE to the number of displays @see lcdPoolTake */
+#ifndef LCD_POOL_SIZE
+#define LCD_POOL_SIZE 0
+#endif
+_Static_assert(LCD_POOL_SIZE <= 32, "LCD_POOL_SIZE over 32");
+
+/* Per-instance memory budget @see lcd_t */
+_Static_assert(sizeof(void *) != 4 || sizeof(lcd_t) - sizeof(StaticSemaphore_t) <= LCD_INSTANCE_BUDGET,
+               "lcd_t over its memory budget");
+
+
+/* LCD tag */
+static const char *lcd_tag = "LCD tag"; /*! < LCD tag */
+
+#if LCD_POOL_SIZE > 0
+static lcd_t lcd_pool[LCD_POOL_SIZE];   /*!< Static LCD objects */
+static uint32_t lcd_pool_used;          /*!< Bitmask of taken LCD objects */
+static portMUX_TYPE lcd_pool_mux = portMUX_INITIALIZER_UNLOCKED; /*!< Guards the pool */
+#endif
+
+#define LCD_DATA 0        /*!< LCD data */
+#define LCD_CMD 1         /*!< LCD command */
+#define GPIO_STATE_LOW 0  /*!< Logic low */
+#define GPIO_STATE_HIGH 1 /*!< Logic high */
+
+/* Default pinout  */
+#define DATA_0_PIN 19          /*!< DATA 0 */
+#define DATA_1_PIN 18          /*!< DATA 0 */
+#define DATA_2_PIN 17          /*!< DATA 0 */
+#define DATA_3_PIN 16          /*!< DATA 0 */
+#define ENABLE_PIN 22          /*!< Enable  */
+#define REGISTER_SELECT_PIN 23 /*!< Register Select  */
+
+#define LCD_BLANK ' ' /*!< Blank cell */
+
+/* Default timing, HD44780 datasheet with margin */
+#define LCD_PULSE_NS    500     /*!< Enable pulse width */
+#define LCD_SETUP_NS    60      /*!< RS and R/W setup before EN rises, tAS */
+#define LCD_CMD_US      50      /*!< Instruction execution time */
+#define LCD_CLEAR_US    2000    /*!< Clear and home execution time */
+
+/* Timing calibration @see lcdCalibrate */
+#define LCD_CAL_PULSE_MIN   100         /*!< Shortest enable pulse tried */
+#define LCD_CAL_PULSE_MAX   2000        /*!< Longest enable pulse tried */
+#define LCD_CAL_PULSE_STEP  50          /*!< Enable pulse search step */
+#define LCD_CAL_MARGIN      25          /*!< Margin added to measured timing, percent */
+#define LCD_CAL_TRIES       4           /*!< Passes per pulse width and measurement */
+#define LCD_CAL_TIMEOUT_US  10000       /*!< Busy flag never cleared */
+#define LCD_CAL_CELL        32          /*!< Scratch DDRAM index, off screen on 16x2 */
+#define LCD_CAL_CELLS       8           /*!< Scratch cells */
+#define LCD_CAL_NVS         "esp_lcd"   /*!< NVS namespace */
+
+/* CPU cycle counter */
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#define lcdCycles() ((uint32_t)esp_cpu_get_cycle_count())
+#else
+#define lcdCycles() ((uint32_t)cpu_hal_get_cycle_count())
+#endif
+
+/* Render task */
+#define LCD_RENDER_CHUNK 4      /*!< Low lane cells written between checks for urgent work */
+#define LCD_RENDER_STACK 3072   /*!< Render task stack in bytes */
+
+#define LCD_SCRUB_CELLS (LCD_ROWS * LCD_COLS)                           /*!< Scrubbed DDRAM cells */
+#define LCD_SCRUB_SIZE  (LCD_SCRUB_CELLS + LCD_GLYPHS * LCD_GLYPH_ROWS) /*!< Scrubbed DDRAM cells and CGRAM rows */
+
+/**
+ * @brief Convert DDRAM index to DDRAM address
+ *
+ * @param index DDRAM index, 0 - 79
+ * @return      DDRAM address
+ */
+static inline uint8_t lcdIndexAddr(int index)
+{
+    return index < LCD_DDRAM_LINE ? index : 0x40 + (index - LCD_DDRAM_LINE);
+}
+
+/**
+ * @brief Convert DDRAM address to DDRAM index
+ *
+ * @param addr  DDRAM address
+ * @return      DDRAM index, 0 - 79
+ */
+static inline uint8_t lcdAddrIndex(uint8_t addr)
+{
+    return ((addr & 0x40) ? LCD_DDRAM_LINE : 0) + (addr & 0x3F) % LCD_DDRAM_LINE;
+}
+
+/**
+ * @brief Busy-wait in nanoseconds
+ *
+ * @param lcd   pointer to LCD object
+ * @param ns    nanoseconds
+ * @return None
+ */
+static inline void lcdDelayNs(lcd_t *const lcd, uint32_t ns)
+{
+    uint32_t start = lcdCycles();
+    uint32_t cycles = (ns * lcd->cpuMhz + 999) / 1000;
+    while (lcdCycles() - start < cycles)
+    {
+    }
+}
+
+/**
+ * @brief Wait for the LCD, sleeping when it takes a tick or more
+ *
+ * @param lcd   pointer to LCD object
+ * @param us    microseconds
+ * @return None
+ */
+void lcdBusWait(lcd_t *const lcd, uint32_t us)
+{
+    if (us >= portTICK_PERIOD_MS * 1000)
+    {
+        vTaskDelay((us + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000));
+        lcd->stats.wakeups++;
+    }
+    else if (us > 0)
+    {
+        esp_rom_delay_us(us);
+    }
+}
+
+/**
+ * @brief Record bus lines in the trace
+ *
+ * @param lcd   pointer to LCD object
+ * @param lines bus lines @see LCD_LINE_RS
+ * @return None
+ */
+static inline void lcdTrace(lcd_t *const lcd, uint8_t lines)
+{
+    lcd_trace_t *trace = lcd->trace;
+    if (trace != NULL && lines != trace->lines)
+    {
+        lcd_trace_sample_t *sample = &trace->samples[trace->count++ % LCD_TRACE_SIZE];
+        sample->cycles = lcdCycles() - trace->start;
+        sample->lines = lines;
+        trace->lines = lines;
+    }
+}
+
+/**
+ * @brief Set GPIO pin and record the transition
+ *
+ * @param lcd   pointer to LCD object
+ * @param pin   GPIO pin
+ * @param line  bus line of the pin @see LCD_LINE_RS
+ * @param level logic level
+ * @return None
+ */
+static inline void lcdGpioSet(lcd_t *const lcd, gpio_num_t pin, uint8_t line, uint32_t level)
+{
+    gpio_set_level(pin, level);
+    if (lcd->trace != NULL)
+    {
+        lcdTrace(lcd, level ? (lcd->trace->lines | line) : (lcd->trace->lines & ~line));
+    }
+}
+
+/**
+ * @brief Append byte to call record
+ *
+ * @param rec   call record
+ * @param b     byte
+ * @note  Counts past the end so lcdRecordDone can drop a partial record.
+ * @return None
+ */
+static void lcdRecordByte(lcd_record_t *rec, uint8_t b)
+{
+    if (rec->len < rec->size)
+    {
+        rec->buf[rec->len] = b;
+    }
+    rec->len++;
+}
+
+/**
+ * @brief Append unsigned LEB128 varint to call record
+ *
+ * @param rec   call record
+ * @param v     value
+ * @return None
+ */
+static void lcdRecordVarint(lcd_record_t *rec, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        lcdRecordByte(rec, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    lcdRecordByte(rec, (uint8_t)v);
+}
+
+/**
+ * @brief Append signed zigzag varint to call record
+ *
+ * @param rec   call record
+ * @param v     value
+ * @return None
+ */
+static void lcdRecordInt(lcd_record_t *rec, int32_t v)
+{
+    lcdRecordVarint(rec, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+
+/**
+ * @brief Append bytes to call record
+ *
+ * @param rec   call record
+ * @param buf   bytes
+ * @param len   number of bytes
+ * @return None
+ */
+static void lcdRecordBytes(lcd_record_t *rec, const void *buf, size_t len)
+{
+    const uint8_t *p = buf;
+    while (len-- > 0)
+    {
+        lcdRecordByte(rec, *p++);
+    }
+}
+
+/**
+ * @brief Start call record
+ *
+ * @param lcd   pointer to LCD object
+ * @param op    recorded call @see lcd_record_op_t
+ * @return      call record, NULL when not recording
+ */
+static lcd_record_t *lcdRecordOp(lcd_t *const lcd, uint8_t op)
+{
+    lcd_record_t *rec = lcd->record;
+    int64_t now;
+
+    if (rec == NULL || rec->overflow)
+    {
+        return NULL;
+    }
+    now = esp_timer_get_time();
+    rec->start = rec->len;
+    lcdRecordByte(rec, op);
+    lcdRecordVarint(rec, (uint64_t)(now - rec->last));
+    rec->last = now;
+    return rec;
+}
+
+/**
+ * @brief Finish call record
+ *
+ * @param rec   call record
+ * @note  A record that did not fit is dropped and recording stops, so
+ *        the log never holds a partial call.
+ * @return None
+ */
+static void lcdRecordDone(lcd_record_t *rec)
+{
+    if (rec->len > rec->size)
+    {
+        rec->len = rec->start;
+        rec->overflow = true;
+        return;
+    }
+    rec->calls++;
+}
+
+/**
+ * @brief Record text call
+ *
+ * @param lcd   pointer to LCD object
+ * @param op    recorded call @see lcd_record_op_t
+ * @param text  text
+ * @param end   end of text, NULL when NUL terminated
+ * @param x     location at x-axis
+ * @param y     location at y-axis
+ * @return None
+ */
+static void lcdRecordText(lcd_t *const lcd, uint8_t op, const char *text, const char *end, int x, int y)
+{
+    lcd_record_t *rec = lcdRecordOp(lcd, op);
+    if (rec != NULL)
+    {
+        /* Text is measured only while recording */
+        size_t len = end != NULL ? (size_t)(end - text) : strlen(text);
+        lcdRecordInt(rec, x);
+        lcdRecordInt(rec, y);
+        lcdRecordVarint(rec, len);
+        lcdRecordBytes(rec, text, len);
+        lcdRecordDone(rec);
+    }
+}
+
+/**
+ * @brief Record region call
+ *
+ * @param lcd       pointer to LCD object
+ * @param op        recorded call @see lcd_record_op_t
+ * @param region    region handle
+ * @param arg       call argument, -1 when the call has none
+ * @return None
+ */
+static void lcdRecordRegion(lcd_t *const lcd, uint8_t op, lcd_region_t region, int arg)
+{
+    lcd_record_t *rec = lcdRecordOp(lcd, op);
+    if (rec != NULL)
+    {
+        lcdRecordVarint(rec, region);
+        if (arg >= 0)
+        {
+            lcdRecordVarint(rec, arg);
+        }
+        lcdRecordDone(rec);
+    }
+}
+
+/**
+ * @brief Trigger LCD enable pin
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdTriggerEN(lcd_t *const lcd)
+{
+    lcdGpioSet(lcd, lcd->en, LCD_LINE_EN, GPIO_STATE_HIGH);
+    lcdDelayNs(lcd, lcd->timing.pulseNs);
+    lcdGpioSet(lcd, lcd->en, LCD_LINE_EN, GPIO_STATE_LOW);
+    lcdDelayNs(lcd, lcd->timing.pulseNs);
+}
+
+/**
+ * @brief Transmitt lower nibble
+ *
+ * @param lcd   pointer to LCD object
+ * @param x     bits
+ * @return None
+ */
+static void lownibble(lcd_t *const lcd, unsigned char x)
+{
+    uint8_t i, val = 0x01;
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+        /* check if x is high for every bit */
+        lcdGpioSet(lcd, lcd->data[i], LCD_LINE_D4 << i, (x >> i) & val);
+    }
+}
+
+/**
+ * @brief GPIO bus, latch nibble
+ *
+ * @param lcd   pointer to LCD object
+ * @param lines D4 - D7 and RS @see LCD_LINE_RS
+ * @param us    wait after the strobe in microseconds
+ * @return None
+ */
+static void lcdGpioWrite(lcd_t *const lcd, uint8_t lines, uint32_t us)
+{
+    /* CMD: RS low, DATA: RS high */
+    lcdGpioSet(lcd, lcd->regSel, LCD_LINE_RS, (lines & LCD_LINE_RS) ? GPIO_STATE_HIGH : GPIO_STATE_LOW);
+    lownibble(lcd, lines);
+    lcdTriggerEN(lcd);
+    lcdBusWait(lcd, us);
+}
+
+/**
+ * @brief GPIO bus, read byte
+ *
+ * @param lcd   pointer to LCD object
+ * @param lines RS @see LCD_LINE_RS
+ * @return      byte read
+ */
+static int lcdGpioRead(lcd_t *const lcd, uint8_t lines)
+{
+    uint8_t val = 0;
+    int i, shift;
+
+    /* Release data lines */
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+        gpio_set_direction(lcd->data[i], GPIO_MODE_INPUT);
+    }
+
+    /* CMD: RS low, DATA: RS high */
+    lcdGpioSet(lcd, lcd->regSel, LCD_LINE_RS, (lines & LCD_LINE_RS) ? GPIO_STATE_HIGH : GPIO_STATE_LOW);
+    lcdGpioSet(lcd, lcd->rw, LCD_LINE_RW, GPIO_STATE_HIGH);
+
+    /* upper bits then lower bits */
+    for (shift = 4; shift >= 0; shift -= 4)
+    {
+        lcdGpioSet(lcd, lcd->en, LCD_LINE_EN, GPIO_STATE_HIGH);
+        lcdDelayNs(lcd, lcd->timing.pulseNs);
+        for (i = 0; i < LCD_DATA_LINE; i++)
+        {
+            val |= gpio_get_level(lcd->data[i]) << (i + shift);
+        }
+        /* Data lines as driven by the LCD */
+        if (lcd->trace != NULL)
+        {
+            lcdTrace(lcd, (lcd->trace->lines & ~LCD_LINE_DATA) | ((val >> shift) & LCD_LINE_DATA));
+        }
+        lcdGpioSet(lcd, lcd->en, LCD_LINE_EN, GPIO_STATE_LOW);
+        lcdDelayNs(lcd, lcd->timing.pulseNs);
+    }
+
+    /* Back to write */
+    lcdGpioSet(lcd, lcd->rw, LCD_LINE_RW, GPIO_STATE_LOW);
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+        gpio_set_direction(lcd->data[i], GPIO_MODE_OUTPUT);
+    }
+    return val;
+}
+
+/**
+ * @brief GPIO bus, reset pins to default configuration
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdGpioRelease(lcd_t *const lcd)
+{
+    /* Reset data pins to default configuration */
+    for (int i = 0; i < LCD_DATA_LINE; i++)
+    {
+        gpio_reset_pin(lcd->data[i]);
+    }
+    /* Reset enable pin to default configuration */
+    gpio_reset_pin(lcd->en);
+    /* Reset register select pin to default configuration */
+    gpio_reset_pin(lcd->regSel);
+    /* Reset read/write pin to default configuration */
+    if (lcd->rw != GPIO_NUM_NC)
+    {
+        gpio_reset_pin(lcd->rw);
+    }
+}
+
+/* GPIO bus, one gpio_set_level per pin */
+static const lcd_bus_t lcd_bus_gpio = {
+    .write = lcdGpioWrite,
+    .read = lcdGpioRead,
+    .flush = NULL,
+    .release = lcdGpioRelease,
+};
+
+#if LCD_USE_DEDIC_GPIO
+/**
+ * @brief Dedicated GPIO bus, map canonical lines to bundle bits
+ *
+ * Bundle order is D4 - D7, RS, EN.
+ * @param lines canonical lines
+ * @return      bundle bits
+ */
+static inline uint32_t lcdDedicBits(uint8_t lines)
+{
+    return (lines & (LCD_LINE_DATA | LCD_LINE_RS)) | ((lines & LCD_LINE_EN) ? 0x20 : 0);
+}
+
+static bool lcdDedicInit(lcd_t *const lcd);
+
+/**
+ * @brief Dedicated GPIO bus, move bundle to the calling core
+ *
+ * The bundle is driven by CPU instructions of the core that created
+ * it, writes from the other core never reach the pins. A pinned render
+ * task moves it once, direct calls from the other core move it back.
+ * @param lcd   pointer to LCD object
+ * @return      true when the bundle is usable, false after falling
+ *              back to the GPIO bus
+ */
+static bool lcdDedicFollow(lcd_t *const lcd)
+{
+    int i;
+
+    if (lcd->busCore == xPortGetCoreID())
+    {
+        return true;
+    }
+    dedic_gpio_del_bundle((dedic_gpio_bundle_handle_t)lcd->busHandle);
+    lcd->busHandle = NULL;
+    if (lcdDedicInit(lcd))
+    {
+        return true;
+    }
+
+    /* No channels on this core, route pins back to GPIO */
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+        gpio_set_direction(lcd->data[i], GPIO_MODE_OUTPUT);
+    }
+    gpio_set_direction(lcd->regSel, GPIO_MODE_OUTPUT);
+    gpio_set_direction(lcd->en, GPIO_MODE_OUTPUT);
+    gpio_set_level(lcd->en, GPIO_STATE_LOW);
+    lcd->bus = &lcd_bus_gpio;
+    lcd->busCore = tskNO_AFFINITY;
+    lcd->stats.fallbacks++;
+    return false;
+}
+
+/**
+ * @brief Dedicated GPIO bus, latch nibble
+ *
+ * Data, RS and EN change together in a single CPU write.
+ * @param lcd   pointer to LCD object
+ * @param lines D4 - D7 and RS @see LCD_LINE_RS
+ * @param us    wait after the strobe in microseconds
+ * @return None
+ */
+static void lcdDedicWrite(lcd_t *const lcd, uint8_t lines, uint32_t us)
+{
+    if (!lcdDedicFollow(lcd))
+    {
+        lcdGpioWrite(lcd, lines, us);
+        return;
+    }
+    dedic_gpio_bundle_handle_t bundle = (dedic_gpio_bundle_handle_t)lcd->busHandle;
+    lines &= LCD_LINE_DATA | LCD_LINE_RS;
+
+    /* Setup, strobe, hold */
+    dedic_gpio_bundle_write(bundle, 0x3F, lcdDedicBits(lines));
+    lcdTrace(lcd, lines);
+    lcdDelayNs(lcd, LCD_SETUP_NS);
+    dedic_gpio_bundle_write(bundle, 0x3F, lcdDedicBits(lines | LCD_LINE_EN));
+    lcdTrace(lcd, lines | LCD_LINE_EN);
+    lcdDelayNs(lcd, lcd->timing.pulseNs);
+    dedic_gpio_bundle_write(bundle, 0x20, 0);
+    lcdTrace(lcd, lines);
+    lcdDelayNs(lcd, lcd->timing.pulseNs);
+    lcdBusWait(lcd, us);
+}
+
+/**
+ * @brief Dedicated GPIO bus, read byte
+ *
+ * RS and EN belong to the bundle, data lines are sampled through GPIO.
+ * Switching their direction routes the data lines to the GPIO output
+ * register, they are connected back to the bundle channels afterwards.
+ * @param lcd   pointer to LCD object
+ * @param lines RS @see LCD_LINE_RS
+ * @return      byte read
+ */
+static int lcdDedicRead(lcd_t *const lcd, uint8_t lines)
+{
+    if (!lcdDedicFollow(lcd))
+    {
+        return lcdGpioRead(lcd, lines);
+    }
+    dedic_gpio_bundle_handle_t bundle = (dedic_gpio_bundle_handle_t)lcd->busHandle;
+    uint32_t mask = 0;
+    uint8_t val = 0;
+    int i, shift;
+
+    /* Release data lines */
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+        gpio_set_direction(lcd->data[i], GPIO_MODE_INPUT);
+    }
+    lines &= LCD_LINE_RS;
+    dedic_gpio_bundle_write(bundle, 0x3F, lcdDedicBits(lines));
+    lcdTrace(lcd, lines);
+    gpio_set_level(lcd->rw, GPIO_STATE_HIGH);
+    lcdTrace(lcd, lines | LCD_LINE_RW);
+    lcdDelayNs(lcd, LCD_SETUP_NS);
+
+    /* upper bits then lower bits */
+    for (shift = 4; shift >= 0; shift -= 4)
+    {
+        dedic_gpio_bundle_write(bundle, 0x20, 0x20);
+        lcdTrace(lcd, lines | LCD_LINE_RW | LCD_LINE_EN);
+        lcdDelayNs(lcd, lcd->timing.pulseNs);
+        for (i = 0; i < LCD_DATA_LINE; i++)
+        {
+            val |= gpio_get_level(lcd->data[i]) << (i + shift);
+        }
+        lcdTrace(lcd, lines | LCD_LINE_RW | LCD_LINE_EN | ((val >> shift) & LCD_LINE_DATA));
+        dedic_gpio_bundle_write(bundle, 0x20, 0);
+        lcdTrace(lcd, lines | LCD_LINE_RW | ((val >> shift) & LCD_LINE_DATA));
+        lcdDelayNs(lcd, lcd->timing.pulseNs);
+    }
+
+    /* Back to write */
+    gpio_set_level(lcd->rw, GPIO_STATE_LOW);
+    lcdTrace(lcd, lines | (val & LCD_LINE_DATA));
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+        gpio_set_direction(lcd->data[i], GPIO_MODE_OUTPUT);
+    }
+
+    /* Reconnect the data lines to the bundle */
+    dedic_gpio_get_out_mask(bundle, &mask);
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+        esp_rom_gpio_connect_out_signal(lcd->data[i],
+            dedic_gpio_sig_info.cores[lcd->busCore].out_sig_per_channel[__builtin_ctz(mask) + i], false, false);
+    }
+    return val;
+}
+
+/**
+ * @brief Dedicated GPIO bus, delete bundle and reset pins
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdDedicRelease(lcd_t *const lcd)
+{
+    dedic_gpio_del_bundle((dedic_gpio_bundle_handle_t)lcd->busHandle);
+    lcd->busHandle = NULL;
+    lcd->busCore = tskNO_AFFINITY;
+    lcdGpioRelease(lcd);
+}
+
+/* Dedicated GPIO bus, one CPU instruction per bus state */
+static const lcd_bus_t lcd_bus_dedic = {
+    .write = lcdDedicWrite,
+    .read = lcdDedicRead,
+    .flush = NULL,
+    .release = lcdDedicRelease,
+};
+
+/**
+ * @brief Map data, RS and EN pins to a dedicated GPIO bundle
+ *
+ * @param lcd   pointer to LCD object
+ * @note  The bundle belongs to the calling CPU core, writes from the
+ *        other core move it. @see lcdDedicFollow
+ * @return      true on success
+ */
+static bool lcdDedicInit(lcd_t *const lcd)
+{
+    int pins[] = {lcd->data[0], lcd->data[1], lcd->data[2], lcd->data[3], lcd->regSel, lcd->en};
+    dedic_gpio_bundle_handle_t bundle = NULL;
+    dedic_gpio_bundle_config_t config = {
+        .gpio_array = pins,
+        .array_size = sizeof(pins) / sizeof(pins[0]),
+        .flags = {
+            .out_en = 1,
+        },
+    };
+
+    if (dedic_gpio_new_bundle(&config, &bundle) != ESP_OK)
+    {
+        ESP_LOGW(lcd_tag, "No dedicated GPIO channels, using GPIO bus\n");
+        return false;
+    }
+    lcd->busHandle = bundle;
+    lcd->busCore = xPortGetCoreID();
+    return true;
+}
+#endif
+
+/**
+ * @brief Write command to LCD object
+ *
+ * @param lcd       pointer to LCD object
+ * @param cmd       LCD command
+ * @param lcd_opt   0: data , 1: command
+ * @return None
+ */
+static void lcdWriteCmd(lcd_t *const lcd, unsigned char cmd, uint8_t lcd_opt)
+{
+    /* CMD: RS low, DATA: RS high */
+    uint8_t rs = (lcd_opt == LCD_CMD) ? 0 : LCD_LINE_RS;
+
+    /* Clear and home take longer than other instructions */
+    uint32_t us = (lcd_opt == LCD_CMD && cmd <= 0x03) ? lcd->timing.clearUs : lcd->timing.cmdUs;
+
+    /* upper bits */
+    lcd->bus->write(lcd, rs | (cmd >> 4), 0);
+
+    /* lower bits */
+    lcd->bus->write(lcd, rs | (cmd & 0x0F), us);
+}
+
+/**
+ * @brief Complete batched bus writes
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static inline void lcdBusFlush(lcd_t *const lcd)
+{
+    if (lcd->bus->flush != NULL)
+    {
+        lcd->bus->flush(lcd);
+    }
+}
+
+/**
+ * @brief Read from LCD object
+ *
+ * @param lcd       pointer to LCD object
+ * @param lcd_opt   0: data , 1: busy flag and address counter
+ * @note  Requires a readable bus. @see lcdCtorRW
+ * @return          byte read, -1 on a bus error
+ */
+static int lcdRead(lcd_t *const lcd, uint8_t lcd_opt)
+{
+    int val = lcd->bus->read(lcd, (lcd_opt == LCD_CMD) ? 0 : LCD_LINE_RS);
+
+    /* Wait for address counter update */
+    if (lcd_opt == LCD_DATA)
+    {
+        lcdBusWait(lcd, lcd->timing.cmdUs);
+    }
+    return val;
+}
+
+/**
+ * @brief Write glyph from CGRAM mirror to LCD
+ *
+ * @param lcd   pointer to LCD object
+ * @param slot  glyph slot, 0 - 7
+ * @note  Deferred to lcdCommit inside a transaction.
+ * @return None
+ */
+static void lcdWriteGlyph(lcd_t *const lcd, int slot)
+{
+    int i;
+
+    if (lcd->depth > 0)
+    {
+        lcd->glyphDirty |= 1 << slot;
+        return;
+    }
+    lcd->glyphDirty &= ~(1 << slot);
+    lcdWriteCmd(lcd, 0x40 | (slot << 3), LCD_CMD);
+    for (i = 0; i < LCD_GLYPH_ROWS; i++)
+    {
+        lcdWriteCmd(lcd, lcd->cgram[slot][i], LCD_DATA);
+    }
+    /* Back to DDRAM */
+    lcdWriteCmd(lcd, 0x80 | lcdIndexAddr(lcd->ac), LCD_CMD);
+    lcdBusFlush(lcd);
+}
+
+/**
+ * @brief Check if a character code is on screen or waiting in a region
+ *
+ * @param lcd   pointer to LCD object
+ * @param ch    character code
+ * @return      true if in use
+ */
+static bool lcdCharInUse(lcd_t *const lcd, uint8_t ch)
+{
+    int r;
+    if (memchr(lcd->frame, ch, sizeof(lcd->frame)) != NULL || memchr(lcd->ddram, ch, sizeof(lcd->ddram)) != NULL)
+    {
+        return true;
+    }
+    for (r = 0; r < LCD_MAX_REGIONS; r++)
+    {
+        if (lcd->regions[r].used && memchr(lcd->regions[r].cells, ch, sizeof(lcd->regions[r].cells)) != NULL)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Get CGRAM glyph for a character missing from the ROM
+ *
+ * Loads the fallback glyph into a free slot, or evicts a fallback glyph
+ * no longer on screen. Custom glyphs are never evicted.
+ * @param lcd   pointer to LCD object
+ * @param code  code point
+ * @return      character code, '?' if no glyph is available
+ */
+static uint8_t lcdGlyphAlloc(lcd_t *const lcd, uint32_t code)
+{
+    const uint8_t *bitmap;
+    int i, slot = -1;
+
+    /* Already loaded */
+    for (i = 0; i < LCD_GLYPHS; i++)
+    {
+        if ((lcd->glyphs & (1 << i)) && lcd->glyphCode[i] == code)
+        {
+            return LCD_GLYPHS + i;
+        }
+    }
+
+    bitmap = lcdCharsetGlyph(code);
+    if (bitmap == NULL)
+    {
+        return '?';
+    }
+
+    /* Free slot, else evict round robin */
+    for (i = 0; i < LCD_GLYPHS && slot < 0; i++)
+    {
+        if (!(lcd->glyphs & (1 << i)))
+        {
+            slot = i;
+        }
+    }
+    for (i = 0; i < LCD_GLYPHS && slot < 0; i++)
+    {
+        int s = (lcd->glyphNext + i) % LCD_GLYPHS;
+        if (lcd->glyphCode[s] != 0 && !lcdCharInUse(lcd, s) && !lcdCharInUse(lcd, LCD_GLYPHS + s))
+        {
+            slot = s;
+            lcd->glyphNext = (s + 1) % LCD_GLYPHS;
+        }
+    }
+    if (slot < 0)
+    {
+        return '?';
+    }
+
+    memcpy(lcd->cgram[slot], bitmap, LCD_GLYPH_ROWS);
+    lcd->glyphs |= 1 << slot;
+    lcd->glyphCode[slot] = code;
+    lcdWriteGlyph(lcd, slot);
+    return LCD_GLYPHS + slot;
+}
+
+/**
+ * @brief Get next character code from text
+ *
+ * @param lcd   pointer to LCD object
+ * @param text  pointer to text, advanced past the character
+ * @return      character code
+ */
+static uint8_t lcdNextChar(lcd_t *const lcd, const char **text, const char *end)
+{
+    uint32_t code;
+    uint8_t ch;
+
+    /* Raw bytes */
+    if (lcd->charset == LCD_CHARSET_RAW)
+    {
+        return (uint8_t)*(*text)++;
+    }
+
+    /* UTF-8, CGRAM codes as is, ROM glyph else CGRAM glyph */
+    code = lcdUtf8Decode(text, end);
+    if (code < LCD_GLYPHS * 2)
+    {
+        return code;
+    }
+    ch = lcdCharsetMap(lcd->charset, code);
+    return ch != 0 ? ch : lcdGlyphAlloc(lcd, code);
+}
+
+/**
+ * @brief Place text on the shadow screen
+ *
+ * @param lcd   pointer to LCD object
+ * @param text  text
+ * @param end   end of text, NULL if text is NUL terminated
+ * @param x     location at x-axis, 16 or more continues at the cursor
+ * @param y     location at y-axis
+ * @return None
+ */
+static void lcdPutText(lcd_t *const lcd, const char *text, const char *end, int x, int y)
+{
+    if (x < 16)
+    {
+        x |= 0x80; // Set LCD for first line write
+        switch (y)
+        {
+        case 1:
+            x |= 0x40; // Set LCD for second line write
+            break;
+        case 2:
+            x |= 0x60; // Set LCD for first line write reverse
+            break;
+        case 3:
+            x |= 0x20; // Set LCD for second line write reverse
+            break;
+        }
+        lcd->cursor = lcdAddrIndex(x & 0x7F);
+    }
+
+    /* Write text to shadow screen */
+    while (end != NULL ? text < end : *text != '\0')
+    {
+        lcd->frame[lcd->cursor] = lcdNextChar(lcd, &text, end);
+        lcd->cursor = (lcd->cursor + 1) % LCD_DDRAM_SIZE;
+    }
+}
+
+/**
+ * @brief Write shadow screen cell to the LCD
+ *
+ * @param lcd   pointer to LCD object
+ * @param i     DDRAM index
+ * @return None
+ */
+static void lcdWriteCell(lcd_t *const lcd, int i)
+{
+    /* Move address counter only when not already there */
+    if (lcd->ac != i)
+    {
+        lcdWriteCmd(lcd, 0x80 | lcdIndexAddr(i), LCD_CMD);
+    }
+    lcdWriteCmd(lcd, lcd->frame[i], LCD_DATA);
+    lcd->ddram[i] = lcd->frame[i];
+    lcd->ac = (i + 1) % LCD_DDRAM_SIZE;
+}
+
+/**
+ * @brief Write shadow screen cells that differ from the LCD
+ *
+ * @param lcd   pointer to LCD object
+ * @note  Adjacent dirty cells share a single set address command.
+ * @return      number of written cells
+ */
+static int lcdFlushFrame(lcd_t *const lcd)
+{
+    int i, written = 0;
+    for (i = 0; i < LCD_DDRAM_SIZE; i++)
+    {
+        /* Skip clean cells */
+        if (lcd->frame[i] == lcd->ddram[i])
+        {
+            continue;
+        }
+        lcdWriteCell(lcd, i);
+        written++;
+    }
+    lcdBusFlush(lcd);
+    return written;
+}
+
+/**
+ * @brief Compose visible regions into the shadow screen
+ *
+ * @param lcd   pointer to LCD object
+ * @note  Cells released by every region are blanked.
+ * @return None
+ */
+static void lcdRegionCompose(lcd_t *const lcd)
+{
+    int row, col, r;
+    for (row = 0; row < LCD_ROWS; row++)
+    {
+        for (col = 0; col < LCD_COLS; col++)
+        {
+            int cell = row * LCD_COLS + col;
+            int top = -1;
+
+            /* Find top most visible region, later regions win ties */
+            for (r = 0; r < LCD_MAX_REGIONS; r++)
+            {
+                const lcd_region_obj_t *reg = &lcd->regions[r];
+                if (!reg->used || !reg->visible)
+                {
+                    continue;
+                }
+                if (col < reg->x || col >= reg->x + reg->width || row < reg->y || row >= reg->y + reg->height)
+                {
+                    continue;
+                }
+                if (top < 0 || reg->z >= lcd->regions[top].z)
+                {
+                    top = r;
+                }
+            }
+
+            if (top >= 0)
+            {
+                const lcd_region_obj_t *reg = &lcd->regions[top];
+                lcd->frame[row * LCD_DDRAM_LINE + col] = reg->cells[(row - reg->y) * reg->width + (col - reg->x)];
+            }
+            else if (lcd->owner[cell] >= 0)
+            {
+                lcd->frame[row * LCD_DDRAM_LINE + col] = LCD_BLANK;
+            }
+            lcd->owner[cell] = top;
+        }
+    }
+}
+
+/**
+ * @brief Blank the shadow screen around the regions
+ *
+ * Region cells keep their contents and are composed back.
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdClearFrame(lcd_t *const lcd)
+{
+    memset(lcd->frame, LCD_BLANK, sizeof(lcd->frame));
+    lcdRegionCompose(lcd);
+    lcd->cursor = 0;
+}
+
+/**
+ * @brief Get region object from handle
+ *
+ * @param lcd       pointer to LCD object
+ * @param region    region handle
+ * @return          region object, NULL if handle is invalid
+ */
+static lcd_region_obj_t *lcdRegionGet(lcd_t *const lcd, lcd_region_t region)
+{
+    if (lcd->state != LCD_ACTIVE || region < 0 || region >= LCD_MAX_REGIONS || !lcd->regions[region].used)
+    {
+        return NULL;
+    }
+    return &lcd->regions[region];
+}
+
+/**
+ * @brief Reset LCD to 4-bit mode and repaint it
+ *
+ * Sending 0x03 three times puts the LCD in 8-bit mode whatever nibble
+ * it expects next, so this also recovers a desynchronized bus.
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdReset(lcd_t *const lcd)
+{
+    /* Send 0x03 3 times at 10ms */
+    lcd->bus->write(lcd, 0x03, 10000);
+    lcd->bus->write(lcd, 0x03, 10000);
+    lcd->bus->write(lcd, 0x03, 10000);
+
+    /* switch to 4-bit mode, 0x02 */
+    lcd->bus->write(lcd, 0x02, 10000);
+
+    /* Initialize LCD */
+    lcdWriteCmd(lcd, 0x28, LCD_CMD); // 4-bit, 2 line, 5x8
+    lcdWriteCmd(lcd, 0x08, LCD_CMD); // Instruction Flow
+    lcdWriteCmd(lcd, 0x01, LCD_CMD); // Clear LCD
+    lcdWriteCmd(lcd, 0x06, LCD_CMD); // Auto-Increment
+    lcdWriteCmd(lcd, 0x0C, LCD_CMD); // Display On, No blink
+
+    /* LCD is blank, home */
+    memset(lcd->ddram, LCD_BLANK, sizeof(lcd->ddram));
+    lcd->ac = 0;
+
+    /* Restore loaded glyphs */
+    for (int slot = 0; slot < LCD_GLYPHS; slot++)
+    {
+        if (lcd->glyphs & (1 << slot))
+        {
+            lcdWriteGlyph(lcd, slot);
+        }
+    }
+
+    /* Restore shadow screen */
+    lcdFlushFrame(lcd);
+}
+
+/**
+ * @brief Check LCD nibble synchronization
+ *
+ * Reads the address counter and compares it with the expected one.
+ * Once a strobe is lost every read comes back nibble swapped.
+ * @param lcd   pointer to LCD object
+ * @return      true if in sync, the R/W pin is not available or the
+ *              read failed
+ */
+static bool lcdInSync(lcd_t *const lcd)
+{
+    uint8_t expected = lcdIndexAddr(lcd->ac);
+    int val;
+
+    /* Nibble swapped counter would read the same, inconclusive */
+    if (!lcd->readable || (expected >> 4) == (expected & 0x0F))
+    {
+        return true;
+    }
+
+    lcd->stats.probes++;
+    if ((val = lcdRead(lcd, LCD_CMD)) < 0)
+    {
+        /* Bus error, says nothing about the nibbles */
+        lcd->stats.readErrors++;
+        return true;
+    }
+    return val == expected;
+}
+
+/**
+ * @brief Check if a write is followed by a sync probe
+ *
+ * Buses with costly reads, e.g. I2C, probe at most once per
+ * LCD_PROBE_MS, the others after every write.
+ * @param lcd   pointer to LCD object
+ * @return      true if the probe is due
+ */
+static bool lcdProbeDue(lcd_t *const lcd)
+{
+    TickType_t now;
+
+    if (!lcd->lazyProbe)
+    {
+        return true;
+    }
+    now = xTaskGetTickCount();
+    if (now - lcd->probed < pdMS_TO_TICKS(LCD_PROBE_MS))
+    {
+        return false;
+    }
+    lcd->probed = now;
+    return true;
+}
+
+/**
+ * @brief Resynchronize LCD and repaint it from the shadow screen
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdRecover(lcd_t *const lcd)
+{
+    ESP_LOGW(lcd_tag, "LCD desync, recovering...\n");
+    lcd->stats.desyncs++;
+    lcdReset(lcd);
+    lcd->stats.recoveries++;
+}
+
+/**
+ * @brief Check the LCD at the current timing
+ *
+ * Writes patterns to off screen scratch cells, reads them back and
+ * checks the address counter, then restores the cells.
+ * @param lcd   pointer to LCD object
+ * @note  Requires a readable bus. The LCD may be out of sync on failure.
+ * @return      true if every pass read back correctly
+ */
+static bool lcdCalVerify(lcd_t *const lcd)
+{
+    static const uint8_t pattern[LCD_CAL_CELLS] = {0x55, 0xAA, 0x0F, 0xF0, 0x33, 0xCC, 0x96, 0x69};
+    bool ok = true;
+    int t, i;
+
+    for (t = 0; t < LCD_CAL_TRIES && ok; t++)
+    {
+        lcdWriteCmd(lcd, 0x80 | lcdIndexAddr(LCD_CAL_CELL), LCD_CMD);
+        for (i = 0; i < LCD_CAL_CELLS; i++)
+        {
+            lcdWriteCmd(lcd, pattern[(i + t) % LCD_CAL_CELLS], LCD_DATA);
+        }
+        lcdWriteCmd(lcd, 0x80 | lcdIndexAddr(LCD_CAL_CELL), LCD_CMD);
+        lcdBusFlush(lcd);
+        for (i = 0; i < LCD_CAL_CELLS && ok; i++)
+        {
+            ok = lcdRead(lcd, LCD_DATA) == pattern[(i + t) % LCD_CAL_CELLS];
+        }
+        ok = ok && lcdRead(lcd, LCD_CMD) == lcdIndexAddr(LCD_CAL_CELL + LCD_CAL_CELLS);
+    }
+    if (!ok)
+    {
+        return false;
+    }
+
+    /* Restore scratch cells and address counter */
+    lcdWriteCmd(lcd, 0x80 | lcdIndexAddr(LCD_CAL_CELL), LCD_CMD);
+    for (i = 0; i < LCD_CAL_CELLS; i++)
+    {
+        lcdWriteCmd(lcd, lcd->ddram[LCD_CAL_CELL + i], LCD_DATA);
+    }
+    lcdWriteCmd(lcd, 0x80 | lcdIndexAddr(lcd->ac), LCD_CMD);
+    lcdBusFlush(lcd);
+    return true;
+}
+
+/**
+ * @brief Measure instruction execution time with the busy flag
+ *
+ * @param lcd       pointer to LCD object
+ * @param cmd       instruction or data byte
+ * @param lcd_opt   0: data , 1: command
+ * @return          microseconds until the busy flag cleared, LCD_CAL_TIMEOUT_US if it never did
+ */
+static uint32_t lcdCalBusy(lcd_t *const lcd, unsigned char cmd, uint8_t lcd_opt)
+{
+    uint8_t rs = (lcd_opt == LCD_CMD) ? 0 : LCD_LINE_RS;
+    int64_t start, elapsed;
+
+    /* No wait after the strobe, poll instead */
+    lcd->bus->write(lcd, rs | (cmd >> 4), 0);
+    lcd->bus->write(lcd, rs | (cmd & 0x0F), 0);
+    lcdBusFlush(lcd);
+    start = esp_timer_get_time();
+    do
+    {
+        elapsed = esp_timer_get_time() - start;
+    } while ((lcdRead(lcd, LCD_CMD) & 0x80) && elapsed < LCD_CAL_TIMEOUT_US);
+
+    return elapsed < LCD_CAL_TIMEOUT_US ? (uint32_t)elapsed : LCD_CAL_TIMEOUT_US;
+}
+
+/**
+ * @brief Load calibrated timing from NVS
+ *
+ * @param lcd       pointer to LCD object
+ * @param timing    loaded timing
+ * @note  NVS must be initialized by the application, nvs_flash_init.
+ * @return          true if this display has a calibration
+ */
+static bool lcdCalLoad(lcd_t *const lcd, lcd_timing_t *timing)
+{
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    size_t size = sizeof(lcd_timing_t);
+    nvs_handle_t nvs;
+    esp_err_t err;
+
+    if (lcd->calKey == 0 || nvs_open(LCD_CAL_NVS, NVS_READONLY, &nvs) != ESP_OK)
+    {
+        return false;
+    }
+    snprintf(key, sizeof(key), "t%08x", (unsigned)lcd->calKey);
+    err = nvs_get_blob(nvs, key, timing, &size);
+    nvs_close(nvs);
+    return err == ESP_OK && size == sizeof(lcd_timing_t) && timing->cmdUs > 0;
+}
+
+/**
+ * @brief Store calibrated timing in NVS
+ *
+ * @param lcd   pointer to LCD object
+ * @return      true if stored
+ */
+static bool lcdCalSave(lcd_t *const lcd)
+{
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_handle_t nvs;
+    esp_err_t err;
+
+    if (lcd->calKey == 0 || nvs_open(LCD_CAL_NVS, NVS_READWRITE, &nvs) != ESP_OK)
+    {
+        return false;
+    }
+    snprintf(key, sizeof(key), "t%08x", (unsigned)lcd->calKey);
+    err = nvs_set_blob(nvs, key, &lcd->timing, sizeof(lcd_timing_t));
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    return err == ESP_OK;
+}
+
+/**
+ * @brief Back to datasheet timing and reinitialize the LCD
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdCalDefault(lcd_t *const lcd)
+{
+    lcd->timing.pulseNs = LCD_PULSE_NS;
+    lcd->timing.cmdUs = LCD_CMD_US;
+    lcd->timing.clearUs = LCD_CLEAR_US;
+    lcdReset(lcd);
+}
+
+/**
+ * @brief Take bus ownership
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static inline void lcdLock(lcd_t *const lcd)
+{
+    if (lcd->lock != NULL)
+    {
+        xSemaphoreTakeRecursive(lcd->lock, portMAX_DELAY);
+    }
+}
+
+/**
+ * @brief Give bus ownership back
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static inline void lcdUnlock(lcd_t *const lcd)
+{
+    if (lcd->lock != NULL)
+    {
+        xSemaphoreGiveRecursive(lcd->lock);
+    }
+}
+
+/**
+ * @brief Queue cells changed since the last call for the render task
+ *
+ * Cells already pending on a lower lane are taken over, they are
+ * written once with the urgent update.
+ * @param lcd   pointer to LCD object
+ * @param lane  update lane @see LCD_LANE_HIGH
+ * @return None
+ */
+static void lcdQueue(lcd_t *const lcd, int lane)
+{
+    int i;
+    for (i = 0; i < LCD_DDRAM_SIZE; i++)
+    {
+        if (lcd->frame[i] == lcd->queued[i])
+        {
+            continue;
+        }
+        lcd->queued[i] = lcd->frame[i];
+        if (lcd->mark[i] > lane)
+        {
+            /* Already pending on this lane or a higher one */
+            continue;
+        }
+        if (lcd->mark[i] != 0)
+        {
+            lcd->pending[lcd->mark[i] - 1]--;
+            lcd->stats.lanes[lcd->mark[i] - 1].cancelled++;
+        }
+        if (lcd->pending[lane]++ == 0)
+        {
+            lcd->since[lane] = esp_timer_get_time();
+        }
+        lcd->mark[i] = lane + 1;
+    }
+}
+
+/**
+ * @brief Record latency of drained lanes
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdLaneDrained(lcd_t *const lcd)
+{
+    int lane;
+    for (lane = 0; lane < LCD_LANES; lane++)
+    {
+        if (lcd->pending[lane] == 0 && lcd->since[lane] >= 0)
+        {
+            lcd_lane_stats_t *stats = &lcd->stats.lanes[lane];
+            uint32_t us = esp_timer_get_time() - lcd->since[lane];
+            stats->updates++;
+            stats->latencyTotalUs += us;
+            if (us > stats->latencyMaxUs)
+            {
+                stats->latencyMaxUs = us;
+            }
+            lcd->since[lane] = -1;
+        }
+    }
+}
+
+/**
+ * @brief Apply posts of the producer rings to the shadow screen
+ *
+ * Each ring is queued on its own lane. Runs under the lock on the
+ * render task, producers never take it.
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdRingDrain(lcd_t *const lcd)
+{
+    lcd_ring_t *ring;
+    lcd_post_t *post;
+    uint32_t head;
+    int r;
+
+    for (r = 0; r < LCD_RINGS; r++)
+    {
+        ring = lcd->rings[r];
+        if (ring == NULL)
+        {
+            continue;
+        }
+        /* Posts up to head are complete */
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (ring->tail == head)
+        {
+            continue;
+        }
+        while (ring->tail != head)
+        {
+            post = &ring->posts[ring->tail % LCD_RING_SIZE];
+            lcdRecordText(lcd, LCD_RECORD_RING, post->text, post->text + post->len, post->x, post->y);
+            lcdPutText(lcd, post->text, post->text + post->len, post->x, post->y);
+            /* Hand the slot back to the producer */
+            __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+        }
+        lcdQueue(lcd, ring->lane);
+    }
+}
+
+/**
+ * @brief Write next batch of queued cells
+ *
+ * The high lane is drained in one go, the low lane a chunk at a time
+ * so urgent updates queued meanwhile go first.
+ * @param lcd   pointer to LCD object
+ * @return      number of written cells
+ */
+static int lcdRenderStep(lcd_t *const lcd)
+{
+    int lane = lcd->pending[LCD_LANE_HIGH] > 0 ? LCD_LANE_HIGH : LCD_LANE_LOW;
+    int budget = lane == LCD_LANE_HIGH ? LCD_DDRAM_SIZE : LCD_RENDER_CHUNK;
+    int i, written = 0;
+
+    for (i = 0; i < LCD_DDRAM_SIZE && budget > 0 && lcd->pending[lane] > 0; i++)
+    {
+        if (lcd->mark[i] != lane + 1)
+        {
+            continue;
+        }
+        lcd->mark[i] = 0;
+        lcd->pending[lane]--;
+        budget--;
+        /* Cell may have been written since, by a clear or a repaint */
+        if (lcd->frame[i] != lcd->ddram[i])
+        {
+            lcdWriteCell(lcd, i);
+            written++;
+        }
+    }
+    lcdBusFlush(lcd);
+    lcd->stats.lanes[lane].cells += written;
+    lcdLaneDrained(lcd);
+
+    return written;
+}
+
+/**
+ * @brief Sleep until the next burst period boundary
+ *
+ * Boundaries are multiples of the period on the tick count, so updates
+ * posted meanwhile and other tasks on the same period share the wakeup.
+ * Urgent work on the high lane is written at once.
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdRenderAlign(lcd_t *const lcd)
+{
+    TickType_t period;
+    bool urgent;
+    int r;
+
+    lcdLock(lcd);
+    period = lcd->period;
+    urgent = lcd->pending[LCD_LANE_HIGH] > 0;
+    for (r = 0; r < LCD_RINGS; r++)
+    {
+        if (lcd->rings[r] != NULL && lcd->rings[r]->lane == LCD_LANE_HIGH &&
+            lcd->rings[r]->tail != lcd->rings[r]->head)
+        {
+            urgent = true;
+        }
+    }
+    lcdUnlock(lcd);
+
+    if (period == 0 || urgent)
+    {
+        return;
+    }
+    vTaskDelay(period - xTaskGetTickCount() % period);
+
+    lcdLock(lcd);
+    lcd->stats.wakeups++;
+    lcdUnlock(lcd);
+}
+
+/**
+ * @brief Render task, writes queued cells by lane
+ *
+ * @param arg   pointer to LCD object
+ * @return None
+ */
+static void lcdRenderTask(void *arg)
+{
+    lcd_t *const lcd = (lcd_t *)arg;
+    int written, pending;
+
+#if LCD_USE_DEDIC_GPIO
+    /* Move the bundle to this core before the first update */
+    lcdLock(lcd);
+    if (lcd->bus == &lcd_bus_dedic)
+    {
+        lcdDedicFollow(lcd);
+    }
+    lcdUnlock(lcd);
+#endif
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        lcdRenderAlign(lcd);
+        written = 0;
+        do
+        {
+            /* Own the bus one chunk at a time, posts may arrive meanwhile */
+            lcdLock(lcd);
+            lcdRingDrain(lcd);
+            written += lcdRenderStep(lcd);
+            pending = lcd->pending[LCD_LANE_LOW] + lcd->pending[LCD_LANE_HIGH];
+            if (pending == 0 && written > 0)
+            {
+                lcd->stats.bursts++;
+                if (lcdProbeDue(lcd) && !lcdInSync(lcd))
+                {
+                    lcdRecover(lcd);
+                }
+            }
+            lcdUnlock(lcd);
+        } while (pending > 0);
+    }
+}
+
+/**
+ * @brief Write changed cells and verify the LCD is still in sync
+ *
+ * With the render task running the cells are queued on the lane
+ * instead. @see lcdRenderStart
+ * @param lcd   pointer to LCD object
+ * @param lane  update lane @see LCD_LANE_HIGH
+ * @note  Deferred to lcdCommit inside a transaction.
+ * @return None
+ */
+static void lcdFlushLane(lcd_t *const lcd, int lane)
+{
+    /* Updates keep the backlight on */
+    if (lcd->backlight != NULL)
+    {
+        lcdBacklightWake(lcd);
+    }
+    if (lcd->render != NULL)
+    {
+        /* Render task waits for the lock, transactions stay atomic */
+        lcdQueue(lcd, lane);
+        xTaskNotifyGive(lcd->render);
+        return;
+    }
+    if (lcd->depth > 0)
+    {
+        return;
+    }
+    if (lcdFlushFrame(lcd) > 0 && lcdProbeDue(lcd) && !lcdInSync(lcd))
+    {
+        lcdRecover(lcd);
+    }
+}
+
+/**
+ * @brief Write changed cells on the low lane
+ *
+ * @param lcd   pointer to LCD object
+ * @return None
+ */
+static void lcdFlush(lcd_t *const lcd)
+{
+    lcdFlushLane(lcd, LCD_LANE_LOW);
+}
+
+/**
+ * @brief Initialize LCD object
+ *
+ * @param lcd   pointer to LCD object
+ * @note  Must constructor LCD object. @see lcd_ctor() and @see lcd_default()
+ * @return None
+ */
+void lcdInit(lcd_t *const lcd)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    /* 100 ms delay */
+    vTaskDelay(100 / portTICK_PERIOD_MS);
+
+    /* Initialize LCD */
+    lcdReset(lcd);
+
+    /* Calibrated timing of this display, checked when the bus can read */
+    lcd_timing_t timing;
+    if (lcdCalLoad(lcd, &timing))
+    {
+        lcd->timing = timing;
+        if (lcd->readable && !lcdCalVerify(lcd))
+        {
+            ESP_LOGW(lcd_tag, "LCD calibration does not fit, using default timing\n");
+            lcdCalDefault(lcd);
+        }
+    }
+    lcdUnlock(lcd);
+}
+
+/**
+ * @brief LCD default constructor
+ * @param lcd    pointer to LCD object
+ * @note  This function call will use hardcode pins. If you want
+ *        to use custom pins @see lcd_ctor
+ *
+ * @return None
+ */
+void lcdDefault(lcd_t *const lcd)
+{
+
+    /* Default pins */
+    gpio_num_t data[LCD_DATA_LINE] = {DATA_0_PIN, DATA_1_PIN, DATA_2_PIN, DATA_3_PIN}; /* Data pins */
+    gpio_num_t en = ENABLE_PIN;                                                        /* Enable pin */
+    gpio_num_t regSel = REGISTER_SELECT_PIN;                                           /* Register Select pin */
+
+    /* Instantiate lcd object with default pins */
+    lcdCtor(lcd, data, en, regSel);
+}
+
+/**
+ * @brief LCD constructor
+ *
+ * Detailed description starts here
+ * @param lcd       pointer to LCD object
+ * @param data      lcd data array
+ * @param en        lcd en
+ * @param regSel    register select
+ * @note  R/W must be tied to GND. @see lcdCtorRW
+ * @return          None
+ */
+void lcdCtor(lcd_t *lcd, gpio_num_t data[LCD_DATA_LINE], gpio_num_t en, gpio_num_t regSel)
+{
+    lcdCtorRW(lcd, data, en, regSel, GPIO_NUM_NC);
+}
+
+/**
+ * @brief LCD constructor with R/W pin
+ *
+ * The R/W pin enables reading back DDRAM and CGRAM. @see lcdScrub
+ * @param lcd       pointer to LCD object
+ * @param data      lcd data array
+ * @param en        lcd en
+ * @param regSel    register select
+ * @param rw        read/write, GPIO_NUM_NC when tied to GND
+ * @note  The LCD drives the data lines on reads, run it from 3.3V or
+ *        level shift the data lines.
+ * @return          None
+ */
+void lcdCtorRW(lcd_t *lcd, gpio_num_t data[LCD_DATA_LINE], gpio_num_t en, gpio_num_t regSel, gpio_num_t rw)
+{
+    /* Reset LCD object on the GPIO bus */
+    lcdCtorBus(lcd, &lcd_bus_gpio, NULL, rw != GPIO_NUM_NC);
+
+    /* Map each data pin to LCD object */
+    int i;
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+        lcd->data[i] = data[i];
+    }
+
+    /* Map enable, register select and read/write pin */
+    lcd->en = en;
+    lcd->regSel = regSel;
+    lcd->rw = rw;
+    lcd->calKey = LCD_CAL_KEY_GPIO | (en & 0x3F) | (regSel & 0x3F) << 6 | (data[0] & 0x3F) << 12 | (rw & 0x3F) << 18;
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    /* Select en and register select pin */
+    esp_rom_gpio_pad_select_gpio(lcd->en);
+    esp_rom_gpio_pad_select_gpio(lcd->regSel);
+#else
+    /* Select en and register select pin */
+    gpio_pad_select_gpio(lcd->en);
+    gpio_pad_select_gpio(lcd->regSel);
+#endif
+
+    /* Set en and register select pin as output */
+    gpio_set_direction(lcd->en, GPIO_MODE_OUTPUT);
+    gpio_set_direction(lcd->regSel, GPIO_MODE_OUTPUT);
+
+    /* Set en and register select pin as low */
+    gpio_set_level(lcd->en, GPIO_STATE_LOW);
+    gpio_set_level(lcd->regSel, GPIO_STATE_LOW);
+
+    /* Set read/write pin as output, write */
+    if (lcd->rw != GPIO_NUM_NC)
+    {
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+        esp_rom_gpio_pad_select_gpio(lcd->rw);
+#else
+        gpio_pad_select_gpio(lcd->rw);
+#endif
+        gpio_set_direction(lcd->rw, GPIO_MODE_OUTPUT);
+        gpio_set_level(lcd->rw, GPIO_STATE_LOW);
+    }
+
+    /* Select all data pins */
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+        esp_rom_gpio_pad_select_gpio(lcd->data[i]);
+#else
+        gpio_pad_select_gpio(lcd->data[i]);
+#endif
+    }
+    /* Set all data pins as output */
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+        gpio_set_direction(lcd->data[i], GPIO_MODE_OUTPUT);
+    }
+    /* Set all data pins output as low */
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+        gpio_set_level(lcd->data[i], GPIO_STATE_LOW);
+    }
+
+    /* Dedicated GPIO bus when available */
+#if LCD_USE_DEDIC_GPIO
+    if (lcdDedicInit(lcd))
+    {
+        lcd->bus = &lcd_bus_dedic;
+    }
+#endif
+}
+
+/**
+ * @brief LCD constructor for a bus backend
+ *
+ * Resets the LCD object and attaches the bus. Backend constructors
+ * call this once their bus is ready. @see lcdCtorDMA
+ * @param lcd       pointer to LCD object
+ * @param bus       bus backend @see lcd_bus_t
+ * @param handle    bus backend context, released by bus->release
+ * @param readable  true if the bus can read the LCD
+ * @return          None
+ */
+void lcdCtorBus(lcd_t *lcd, const lcd_bus_t *bus, void *handle, bool readable)
+{
+    /* Reset LCD object */
+    memset(lcd, 0, sizeof(lcd_t));
+    memset(lcd->frame, LCD_BLANK, sizeof(lcd->frame));
+    memset(lcd->ddram, LCD_BLANK, sizeof(lcd->ddram));
+    memset(lcd->owner, -1, sizeof(lcd->owner));
+
+    /* No pins until the backend maps them */
+    int i;
+    for (i = 0; i < LCD_DATA_LINE; i++)
+    {
+        lcd->data[i] = GPIO_NUM_NC;
+    }
+    lcd->en = GPIO_NUM_NC;
+    lcd->regSel = GPIO_NUM_NC;
+    lcd->rw = GPIO_NUM_NC;
+
+    /* Default timing, CPU clock for nanosecond delays */
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)
+    lcd->cpuMhz = esp_rom_get_cpu_ticks_per_us();
+#else
+    /* No ROM query yet, measure it */
+    uint32_t start = lcdCycles();
+    esp_rom_delay_us(100);
+    lcd->cpuMhz = (lcdCycles() - start + 50) / 100;
+#endif
+    lcd->timing.pulseNs = LCD_PULSE_NS;
+    lcd->timing.cmdUs = LCD_CMD_US;
+    lcd->timing.clearUs = LCD_CLEAR_US;
+
+    /* Bus ownership */
+    lcd->lock = xSemaphoreCreateRecursiveMutexStatic(&lcd->lockBuffer);
+
+    /* No render task, lanes empty, bus usable from any core */
+    lcd->busCore = tskNO_AFFINITY;
+    for (i = 0; i < LCD_LANES; i++)
+    {
+        lcd->since[i] = -1;
+    }
+
+    /* Attach bus */
+    lcd->bus = bus;
+    lcd->busHandle = handle;
+    lcd->readable = readable;
+
+    lcd->state = (lcd_state_t)LCD_ACTIVE;
+}
+
+/**
+ * @brief Begin transaction
+ *
+ * Takes bus ownership until the matching lcdCommit, other tasks block
+ * instead of interleaving. Text, region, clear, glyph and play calls
+ * only update the shadow screen and CGRAM mirror until then.
+ * Transactions nest.
+ * @param lcd   pointer to LCD object
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdBegin(lcd_t *const lcd)
+{
+    lcd_record_t *rec;
+
+    /* Own the bus until lcdCommit */
+    lcdLock(lcd);
+
+    if (lcd->state != LCD_ACTIVE)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    lcd->depth++;
+    if ((rec = lcdRecordOp(lcd, LCD_RECORD_BEGIN)) != NULL)
+    {
+        lcdRecordDone(rec);
+    }
+
+    return LCD_OK;
+}
+
+/**
+ * @brief Commit transaction
+ *
+ * The outermost commit writes everything queued since lcdBegin in one
+ * burst. Dirty cells are written in address order, adjacent cells share
+ * one set address command, and a deferred clear is only sent when it
+ * is cheaper than overwriting the old cells.
+ * @param lcd   pointer to LCD object
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdCommit(lcd_t *const lcd)
+{
+    int i, dirty = 0, text = 0;
+    lcd_record_t *rec;
+
+    /* Blocks while another task has a transaction open */
+    lcdLock(lcd);
+
+    if (lcd->depth == 0)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    if ((rec = lcdRecordOp(lcd, LCD_RECORD_COMMIT)) != NULL)
+    {
+        lcdRecordDone(rec);
+    }
+    if (--lcd->depth == 0)
+    {
+        /* Glyphs first, the cells written next may show them */
+        for (i = 0; i < LCD_GLYPHS; i++)
+        {
+            if (lcd->glyphDirty & (1 << i))
+            {
+                lcdWriteGlyph(lcd, i);
+            }
+        }
+        if (lcd->clearPending)
+        {
+            /* Clear costs clearUs, a cell costs two cmdUs writes at most */
+            for (i = 0; i < LCD_DDRAM_SIZE; i++)
+            {
+                dirty += lcd->frame[i] != lcd->ddram[i];
+                text += lcd->frame[i] != LCD_BLANK;
+            }
+            if (text + lcd->timing.clearUs / (lcd->timing.cmdUs ? lcd->timing.cmdUs : 1) < dirty)
+            {
+                lcdWriteCmd(lcd, 0x01, LCD_CMD);
+                memset(lcd->ddram, LCD_BLANK, sizeof(lcd->ddram));
+                lcd->ac = 0;
+            }
+            lcd->clearPending = false;
+        }
+        lcdFlush(lcd);
+    }
+
+    /* Give back ownership taken here and by lcdBegin */
+    lcdUnlock(lcd);
+    lcdUnlock(lcd);
+    return lcd->state == LCD_ACTIVE ? LCD_OK : LCD_FAIL;
+}
+
+/**
+ * @brief Set text
+ *
+ * Detailed description starts here
+ * @param lcd   pointer to LCD object
+ * @param text  string text
+ * @param x     location at x-axis
+ * @param y     location at y-axis
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdSetText(lcd_t *const lcd, const char *text, int x, int y)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    /* Check if lcd is active */
+    if (lcd->state == LCD_ACTIVE)
+    {
+        lcdRecordText(lcd, LCD_RECORD_TEXT, text, NULL, x, y);
+        lcdPutText(lcd, text, NULL, x, y);
+        /* Write changed cells */
+        lcdFlush(lcd);
+    }
+    lcdUnlock(lcd);
+    /* return lcd status */
+    return lcd->state == LCD_ACTIVE ? LCD_OK : LCD_FAIL;
+}
+
+/**
+ * @brief Write text of explicit length
+ *
+ * Writes straight from caller memory, buf needs no NUL terminator and
+ * may be a slice of a larger buffer. NUL bytes are written as glyph 0.
+ * @param lcd   pointer to LCD object
+ * @param buf   text
+ * @param len   text length in bytes
+ * @param x     location at x-axis
+ * @param y     location at y-axis
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdWrite(lcd_t *const lcd, const char *buf, size_t len, int x, int y)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    /* Check if lcd is active */
+    if (lcd->state == LCD_ACTIVE)
+    {
+        lcdRecordText(lcd, LCD_RECORD_TEXT, buf, buf + len, x, y);
+        lcdPutText(lcd, buf, buf + len, x, y);
+        /* Write changed cells */
+        lcdFlush(lcd);
+    }
+    lcdUnlock(lcd);
+    /* return lcd status */
+    return lcd->state == LCD_ACTIVE ? LCD_OK : LCD_FAIL;
+}
+
+/**
+ * @brief Write batch of text spans
+ *
+ * All spans are placed on the shadow screen before a single write of
+ * the changed cells.
+ * @param lcd   pointer to LCD object
+ * @param spans text spans @see lcd_span_t
+ * @param count number of spans
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdWriteSpans(lcd_t *const lcd, const lcd_span_t *spans, size_t count)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    /* Check if lcd is active */
+    if (lcd->state == LCD_ACTIVE)
+    {
+        lcd_record_t *rec = lcdRecordOp(lcd, LCD_RECORD_SPANS);
+        size_t i;
+        if (rec != NULL)
+        {
+            lcdRecordVarint(rec, count);
+            for (i = 0; i < count; i++)
+            {
+                lcdRecordInt(rec, spans[i].x);
+                lcdRecordInt(rec, spans[i].y);
+                lcdRecordVarint(rec, spans[i].len);
+                lcdRecordBytes(rec, spans[i].buf, spans[i].len);
+            }
+            lcdRecordDone(rec);
+        }
+        for (i = 0; i < count; i++)
+        {
+            lcdPutText(lcd, spans[i].buf, spans[i].buf + spans[i].len, spans[i].x, spans[i].y);
+        }
+        /* Write changed cells */
+        lcdFlush(lcd);
+    }
+    lcdUnlock(lcd);
+    /* return lcd status */
+    return lcd->state == LCD_ACTIVE ? LCD_OK : LCD_FAIL;
+}
+
+/**
+ * @brief Check a precompiled screen before playing it
+ *
+ * @param stream    screen records @see lcdPlay
+ * @param size      stream size in bytes
+ * @return          true if every record is well formed
+ */
+static bool lcdPlayCheck(const uint8_t *stream, size_t size)
+{
+    size_t i = 0;
+    while (i < size)
+    {
+        uint8_t cmd = stream[i];
+        if (i + 2 > size || i + 2 + stream[i + 1] > size)
+        {
+            return false;
+        }
+        if (cmd & 0x80)
+        {
+            /* DDRAM address must exist */
+            if ((cmd & 0x3F) >= LCD_DDRAM_LINE)
+            {
+                return false;
+            }
+        }
+        else if (cmd & 0x40)
+        {
+            /* CGRAM write must stay within the glyphs */
+            if ((cmd & 0x3F) + stream[i + 1] > LCD_GLYPHS * LCD_GLYPH_ROWS)
+            {
+                return false;
+            }
+        }
+        else if (cmd != LCD_PLAY_CLEAR || stream[i + 1] != 0)
+        {
+            return false;
+        }
+        i += 2 + stream[i + 1];
+    }
+    return true;
+}
+
+/**
+ * @brief Apply a precompiled screen record to the shadow state
+ *
+ * Inside a transaction, lcdCommit writes what changed.
+ * @param lcd   pointer to LCD object
+ * @param cmd   record command @see lcdPlay
+ * @param data  record data
+ * @param len   record data length
+ * @return None
+ */
+static void lcdPlayDefer(lcd_t *const lcd, uint8_t cmd, const uint8_t *data, size_t len)
+{
+    size_t n;
+    int i, slot;
+
+    if (cmd == LCD_PLAY_CLEAR)
+    {
+        /* Same as lcdClear */
+        lcd->clearPending = true;
+        lcdClearFrame(lcd);
+    }
+    else if (cmd & 0x80)
+    {
+        /* Text run */
+        i = lcdAddrIndex(cmd & 0x7F);
+        for (n = 0; n < len; n++)
+        {
+            lcd->frame[i] = data[n];
+            i = (i + 1) % LCD_DDRAM_SIZE;
+        }
+        lcd->cursor = i;
+    }
+    else
+    {
+        /* Glyph rows */
+        for (n = 0; n < len; n++)
+        {
+            slot = ((cmd & 0x3F) + n) / LCD_GLYPH_ROWS;
+            lcd->cgram[slot][((cmd & 0x3F) + n) % LCD_GLYPH_ROWS] = data[n];
+            lcd->glyphs |= 1 << slot;
+            lcd->glyphCode[slot] = 0;
+            lcd->glyphDirty |= 1 << slot;
+        }
+    }
+}
+
+/**
+ * @brief Play precompiled screen
+ *
+ * The stream is a list of records, each a command byte, a length byte
+ * and length data bytes. Commands are LCD_PLAY_CLEAR, LCD_PLAY_AT or
+ * LCD_PLAY_GLYPH, data is written as is. Keep static screens in flash
+ * and generate them with tools/lcd_screen.py.
+ * @param lcd       pointer to LCD object
+ * @param stream    screen records
+ * @param size      stream size in bytes
+ * @note  LCD_PLAY_CLEAR keeps region cells like lcdClear.
+ * @note  Inside a transaction the records go to the shadow screen and
+ *        CGRAM mirror, lcdCommit writes them.
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdPlay(lcd_t *const lcd, const uint8_t *stream, size_t size)
+{
+    size_t i = 0, n;
+    int slot, row;
+    bool cleared = false;
+    lcd_record_t *rec;
+
+    /* Own the bus */
+    lcdLock(lcd);
+
+    /* Check if lcd is active and stream is well formed */
+    if (lcd->state != LCD_ACTIVE || !lcdPlayCheck(stream, size))
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    if ((rec = lcdRecordOp(lcd, LCD_RECORD_PLAY)) != NULL)
+    {
+        lcdRecordVarint(rec, size);
+        lcdRecordBytes(rec, stream, size);
+        lcdRecordDone(rec);
+    }
+    if (lcd->backlight != NULL)
+    {
+        lcdBacklightWake(lcd);
+    }
+
+    while (i < size)
+    {
+        uint8_t cmd = stream[i];
+        uint8_t len = stream[i + 1];
+        const uint8_t *data = stream + i + 2;
+        i += 2 + len;
+
+        if (lcd->depth > 0)
+        {
+            lcdPlayDefer(lcd, cmd, data, len);
+            continue;
+        }
+        lcdWriteCmd(lcd, cmd, LCD_CMD);
+        if (cmd == LCD_PLAY_CLEAR)
+        {
+            /* Same as lcdClear, region cells are written back below */
+            memset(lcd->ddram, LCD_BLANK, sizeof(lcd->ddram));
+            lcd->ac = 0;
+            lcdClearFrame(lcd);
+            cleared = true;
+        }
+        else if (cmd & 0x80)
+        {
+            /* Text run, shadow screen follows the LCD */
+            lcd->ac = lcdAddrIndex(cmd & 0x7F);
+            for (n = 0; n < len; n++)
+            {
+                lcdWriteCmd(lcd, data[n], LCD_DATA);
+                lcd->frame[lcd->ac] = data[n];
+                lcd->ddram[lcd->ac] = data[n];
+                lcd->ac = (lcd->ac + 1) % LCD_DDRAM_SIZE;
+            }
+            lcd->cursor = lcd->ac;
+        }
+        else
+        {
+            /* Glyph rows, CGRAM mirror follows the LCD */
+            for (n = 0; n < len; n++)
+            {
+                slot = ((cmd & 0x3F) + n) / LCD_GLYPH_ROWS;
+                row = ((cmd & 0x3F) + n) % LCD_GLYPH_ROWS;
+                lcdWriteCmd(lcd, data[n], LCD_DATA);
+                lcd->cgram[slot][row] = data[n];
+                lcd->glyphs |= 1 << slot;
+                lcd->glyphCode[slot] = 0;
+            }
+            /* Back to DDRAM */
+            lcdWriteCmd(lcd, 0x80 | lcdIndexAddr(lcd->ac), LCD_CMD);
+        }
+    }
+    if (lcd->depth > 0 || cleared)
+    {
+        lcdFlush(lcd);
+    }
+    else
+    {
+        lcdBusFlush(lcd);
+    }
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Set integer
+ *
+ * Detailed description starts here
+ * @param lcd   pointer to LCD object
+ * @param val   integer value to be displayed
+ * @param x     location at x-axis
+ * @param y     location at y-axis
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdSetInt(lcd_t *const lcd, int val, int x, int y)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    /* Check if lcd is active */
+    if (lcd->state == LCD_ACTIVE)
+    {
+        /* Store integer to buffer */
+        char buffer[16];
+        lcd_record_t *rec = lcdRecordOp(lcd, LCD_RECORD_INT);
+        if (rec != NULL)
+        {
+            lcdRecordInt(rec, x);
+            lcdRecordInt(rec, y);
+            lcdRecordInt(rec, val);
+            lcdRecordDone(rec);
+        }
+        sprintf(buffer, "%d", val);
+        /* Set integer, recorded once */
+        lcdPutText(lcd, buffer, NULL, x, y);
+        lcdFlush(lcd);
+    }
+    lcdUnlock(lcd);
+    /* return lcd status */
+    return lcd->state == LCD_ACTIVE ? LCD_OK : LCD_FAIL;
+}
+
+/**
+ * @brief Clear LCD screen
+ * Detailed description starts here
+ * @param lcd   pointer to LCD object
+ * @note  Open regions keep their contents and stay on screen, clear
+ *        them with lcdRegionClear.
+ * @return      lcd error status @see lcd_err_t 
+ */
+lcd_err_t lcdClear(lcd_t *const lcd)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    /* Check if lcd is active */
+    if (lcd->state == LCD_ACTIVE)
+    {
+        lcd_record_t *rec = lcdRecordOp(lcd, LCD_RECORD_CLEAR);
+        if (rec != NULL)
+        {
+            lcdRecordDone(rec);
+        }
+
+        if (lcd->backlight != NULL)
+        {
+            lcdBacklightWake(lcd);
+        }
+
+        /* Clear LCD screen, inside a transaction lcdCommit decides */
+        if (lcd->depth > 0)
+        {
+            lcd->clearPending = true;
+        }
+        else
+        {
+            lcdWriteCmd(lcd, 0x01, LCD_CMD);
+            lcdBusFlush(lcd);
+            memset(lcd->ddram, LCD_BLANK, sizeof(lcd->ddram));
+            lcd->ac = 0;
+        }
+
+        /* Clear shadow screen, write region cells back */
+        lcdClearFrame(lcd);
+        lcdFlush(lcd);
+    }
+
+    lcdUnlock(lcd);
+    /* return lcd status */
+    return lcd->state == LCD_ACTIVE ? LCD_OK : LCD_FAIL;
+}
+
+/**
+ * @brief Set custom glyph
+ *
+ * The glyph is displayed by writing its slot as a character code,
+ * use 8 - 15 for slot 0 - 7 inside strings.
+ * @param lcd       pointer to LCD object
+ * @param slot      glyph slot, 0 - 7
+ * @param bitmap    glyph rows, top to bottom, 5 lsb per row
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdSetGlyph(lcd_t *const lcd, int slot, const uint8_t bitmap[LCD_GLYPH_ROWS])
+{
+    lcd_record_t *rec;
+
+    /* Own the bus */
+    lcdLock(lcd);
+
+    /* Check if lcd is active */
+    if (lcd->state != LCD_ACTIVE || slot < 0 || slot >= LCD_GLYPHS)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+
+    if ((rec = lcdRecordOp(lcd, LCD_RECORD_GLYPH)) != NULL)
+    {
+        lcdRecordByte(rec, slot);
+        lcdRecordBytes(rec, bitmap, LCD_GLYPH_ROWS);
+        lcdRecordDone(rec);
+    }
+
+    /* Store and write glyph */
+    memcpy(lcd->cgram[slot], bitmap, LCD_GLYPH_ROWS);
+    lcd->glyphs |= 1 << slot;
+    lcd->glyphCode[slot] = 0;
+    lcdWriteGlyph(lcd, slot);
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Set text encoding
+ *
+ * With A00 or A02 text is decoded as UTF-8 and mapped to the character
+ * ROM fitted to the LCD. Characters missing from the ROM are drawn with
+ * fallback glyphs loaded into free CGRAM slots, or '?'.
+ * @param lcd       pointer to LCD object
+ * @param charset   text encoding @see lcd_charset_t
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdSetCharset(lcd_t *const lcd, lcd_charset_t charset)
+{
+    lcd_record_t *rec;
+
+    /* Own the bus */
+    lcdLock(lcd);
+
+    if ((rec = lcdRecordOp(lcd, LCD_RECORD_CHARSET)) != NULL)
+    {
+        lcdRecordByte(rec, charset);
+        lcdRecordDone(rec);
+    }
+    lcd->charset = charset;
+    lcdUnlock(lcd);
+    /* return lcd status */
+    return lcd->state == LCD_ACTIVE ? LCD_OK : LCD_FAIL;
+}
+
+/**
+ * @brief Scrub LCD memory
+ *
+ * Reads back the next slice of visible DDRAM cells and loaded CGRAM
+ * rows, compares them against what was written and rewrites only the
+ * mismatches. Call periodically with a small slice to keep the screen
+ * intact without full refreshes.
+ * @param lcd       pointer to LCD object
+ * @param cells     number of cells to scrub
+ * @param repaired  number of rewritten cells, may be NULL
+ * @note  Requires the R/W pin. @see lcdCtorRW
+ * @return          lcd error status, LCD_FAIL too when a read failed,
+ *                  the rest of the slice is left for the next call
+ */
+lcd_err_t lcdScrub(lcd_t *const lcd, int cells, int *repaired)
+{
+    int fixed = 0, val = 0;
+    int next = -1; /* address counter, DDRAM index or 0x100 | CGRAM address */
+
+    /* Own the bus */
+    lcdLock(lcd);
+
+    /* Check if lcd is active and readable */
+    if (lcd->state != LCD_ACTIVE || !lcd->readable)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+
+    /* Reads are garbage while out of sync, repaint instead */
+    if (!lcdInSync(lcd))
+    {
+        lcdRecover(lcd);
+        cells = 0;
+    }
+    lcd->stats.scrubbed += cells > 0 ? cells : 0;
+
+    while (cells-- > 0)
+    {
+        int pos = lcd->scrub;
+        lcd->scrub = (lcd->scrub + 1) % LCD_SCRUB_SIZE;
+
+        if (pos < LCD_SCRUB_CELLS)
+        {
+            /* Visible DDRAM cell */
+            int index = (pos / LCD_COLS) * LCD_DDRAM_LINE + pos % LCD_COLS;
+            if (next != index)
+            {
+                lcdWriteCmd(lcd, 0x80 | lcdIndexAddr(index), LCD_CMD);
+            }
+            next = index + 1;
+            if ((val = lcdRead(lcd, LCD_DATA)) < 0)
+            {
+                /* Bus error, check this cell again next time */
+                lcd->scrub = pos;
+                break;
+            }
+            if (val != lcd->ddram[index])
+            {
+                lcdWriteCmd(lcd, 0x80 | lcdIndexAddr(index), LCD_CMD);
+                lcdWriteCmd(lcd, lcd->ddram[index], LCD_DATA);
+                fixed++;
+            }
+        }
+        else
+        {
+            /* CGRAM row of a loaded glyph */
+            int addr = pos - LCD_SCRUB_CELLS;
+            int slot = addr / LCD_GLYPH_ROWS;
+            if (!(lcd->glyphs & (1 << slot)))
+            {
+                /* Skip unloaded glyph */
+                lcd->scrub = (lcd->scrub + LCD_GLYPH_ROWS - 1 - addr % LCD_GLYPH_ROWS) % LCD_SCRUB_SIZE;
+                continue;
+            }
+            if (next != (0x100 | addr))
+            {
+                lcdWriteCmd(lcd, 0x40 | addr, LCD_CMD);
+            }
+            next = 0x100 | (addr + 1);
+            if ((val = lcdRead(lcd, LCD_DATA)) < 0)
+            {
+                /* Bus error, check this cell again next time */
+                lcd->scrub = pos;
+                break;
+            }
+            if ((val & 0x1F) != (lcd->cgram[slot][addr % LCD_GLYPH_ROWS] & 0x1F))
+            {
+                lcdWriteCmd(lcd, 0x40 | addr, LCD_CMD);
+                lcdWriteCmd(lcd, lcd->cgram[slot][addr % LCD_GLYPH_ROWS], LCD_DATA);
+                fixed++;
+            }
+        }
+    }
+
+    /* Restore address counter, unknown after a failed read */
+    if (next >= 0 && (next != lcd->ac || val < 0))
+    {
+        lcdWriteCmd(lcd, 0x80 | lcdIndexAddr(lcd->ac), LCD_CMD);
+    }
+    lcdBusFlush(lcd);
+
+    lcd->stats.repaired += fixed;
+    if (repaired != NULL)
+    {
+        *repaired = fixed;
+    }
+    if (val < 0)
+    {
+        /* Cells from here on are not checked */
+        lcd->stats.readErrors++;
+    }
+    lcdUnlock(lcd);
+    return val < 0 ? LCD_FAIL : LCD_OK;
+}
+
+/**
+ * @brief Check LCD synchronization and recover if needed
+ *
+ * A dropped enable strobe in 4-bit mode swaps every following nibble.
+ * With the R/W pin the address counter is read back and a desync is
+ * repaired by resetting the bus and repainting from the shadow screen.
+ * Writes are checked automatically, at most every LCD_PROBE_MS on buses
+ * with costly reads, call this to probe an idle LCD.
+ * @param lcd   pointer to LCD object
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdCheck(lcd_t *const lcd)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    /* Check if lcd is active */
+    if (lcd->state == LCD_ACTIVE && !lcdInSync(lcd))
+    {
+        lcdRecover(lcd);
+    }
+    lcdUnlock(lcd);
+    /* return lcd status */
+    return lcd->state == LCD_ACTIVE ? LCD_OK : LCD_FAIL;
+}
+
+/**
+ * @brief Resynchronize LCD and repaint it
+ *
+ * Without the R/W pin a desync cannot be detected, call this
+ * periodically to bound how long a glitch stays on screen.
+ * @param lcd   pointer to LCD object
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdResync(lcd_t *const lcd)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    /* Check if lcd is active */
+    if (lcd->state == LCD_ACTIVE)
+    {
+        lcdReset(lcd);
+        lcd->stats.recoveries++;
+    }
+    lcdUnlock(lcd);
+    /* return lcd status */
+    return lcd->state == LCD_ACTIVE ? LCD_OK : LCD_FAIL;
+}
+
+/**
+ * @brief Calibrate bus timing for the attached LCD
+ *
+ * Searches the shortest enable pulse that reads back correctly, then
+ * measures data, instruction and clear execution times with the busy
+ * flag. Margin is added to each and the result is applied and stored
+ * in NVS under the display's wiring, so lcdInit loads it on every boot.
+ * @param lcd       pointer to LCD object
+ * @param timing    calibrated timing, may be NULL
+ * @note  Requires a readable bus and nvs_flash_init. The screen is
+ *        briefly cleared and redrawn. Fails with default timing
+ *        restored when the LCD does not read back or the busy flag
+ *        never clears. A failed NVS write only logs a warning.
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdCalibrate(lcd_t *const lcd, lcd_timing_t *timing)
+{
+    uint32_t pulse = 0, cmd = 0, clear = 0, p, us;
+    int t;
+
+    /* Own the bus */
+    lcdLock(lcd);
+
+    if (lcd->state != LCD_ACTIVE || !lcd->readable || lcd->depth > 0)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    lcdCalDefault(lcd);
+
+    /* Some clones need a longer pulse than the datasheet */
+    for (p = LCD_PULSE_NS; p <= LCD_CAL_PULSE_MAX; p += LCD_CAL_PULSE_STEP)
+    {
+        lcd->timing.pulseNs = p;
+        if (lcdCalVerify(lcd))
+        {
+            pulse = p;
+            break;
+        }
+        /* Back in sync at a pulse every clone accepts */
+        lcd->timing.pulseNs = LCD_CAL_PULSE_MAX;
+        lcdReset(lcd);
+    }
+    /* Others are much faster, shorten until it breaks */
+    if (pulse == LCD_PULSE_NS)
+    {
+        for (p = pulse - LCD_CAL_PULSE_STEP; p >= LCD_CAL_PULSE_MIN; p -= LCD_CAL_PULSE_STEP)
+        {
+            lcd->timing.pulseNs = p;
+            if (!lcdCalVerify(lcd))
+            {
+                lcd->timing.pulseNs = pulse;
+                lcdReset(lcd);
+                break;
+            }
+            pulse = p;
+        }
+    }
+    if (pulse == 0)
+    {
+        lcdCalDefault(lcd);
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    lcd->timing.pulseNs = pulse;
+
+    /* Slowest of several set address, data and clear executions */
+    for (t = 0; t < LCD_CAL_TRIES; t++)
+    {
+        us = lcdCalBusy(lcd, 0x80 | lcdIndexAddr(LCD_CAL_CELL + t), LCD_CMD);
+        cmd = us > cmd ? us : cmd;
+        us = lcdCalBusy(lcd, lcd->ddram[LCD_CAL_CELL + t], LCD_DATA);
+        cmd = us > cmd ? us : cmd;
+        us = lcdCalBusy(lcd, 0x01, LCD_CMD);
+        clear = us > clear ? us : clear;
+    }
+    memset(lcd->ddram, LCD_BLANK, sizeof(lcd->ddram));
+    lcd->ac = 0;
+    if (cmd >= LCD_CAL_TIMEOUT_US || clear >= LCD_CAL_TIMEOUT_US)
+    {
+        lcdCalDefault(lcd);
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+
+    /* Apply with margin, check once more at full speed */
+    lcd->timing.pulseNs = pulse * (100 + LCD_CAL_MARGIN) / 100;
+    lcd->timing.cmdUs = cmd * (100 + LCD_CAL_MARGIN) / 100 + 1;
+    lcd->timing.clearUs = clear * (100 + LCD_CAL_MARGIN) / 100 + 1;
+    lcdFlushFrame(lcd);
+    if (!lcdCalVerify(lcd))
+    {
+        lcdCalDefault(lcd);
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    if (!lcdCalSave(lcd))
+    {
+        ESP_LOGW(lcd_tag, "LCD calibration not stored in NVS\n");
+    }
+    if (timing != NULL)
+    {
+        *timing = lcd->timing;
+    }
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Get LCD statistics
+ *
+ * @param lcd   pointer to LCD object
+ * @param stats statistics copy
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdGetStats(lcd_t *const lcd, lcd_stats_t *stats)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    *stats = lcd->stats;
+    lcdUnlock(lcd);
+    /* return lcd status */
+    return lcd->state == LCD_ACTIVE ? LCD_OK : LCD_FAIL;
+}
+
+/**
+ * @brief Copy what the LCD shows
+ *
+ * Taken from the DDRAM and CGRAM mirrors, the bus is not touched.
+ * Cells a transaction or the render task has not written yet are
+ * reported as they are on the LCD and counted in pending.
+ * @param lcd   pointer to LCD object
+ * @param snap  snapshot @see lcd_snapshot_t
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdSnapshot(lcd_t *const lcd, lcd_snapshot_t *snap)
+{
+    int row, col, i;
+
+    /* Own the bus, nothing is half written */
+    lcdLock(lcd);
+
+    snap->pending = 0;
+    for (row = 0; row < LCD_ROWS; row++)
+    {
+        for (col = 0; col < LCD_COLS; col++)
+        {
+            i = row * LCD_DDRAM_LINE + col;
+            snap->text[row][col] = lcd->ddram[i];
+            snap->pending += lcd->frame[i] != lcd->ddram[i];
+        }
+    }
+    memcpy(snap->cgram, lcd->cgram, sizeof(snap->cgram));
+    snap->glyphs = lcd->glyphs;
+    snap->cursorX = lcd->cursor % LCD_DDRAM_LINE;
+    snap->cursorY = lcd->cursor / LCD_DDRAM_LINE;
+    /* Display is set up with the cursor off */
+    snap->cursorOn = false;
+    snap->cursorBlink = false;
+    snap->charset = lcd->charset;
+
+    lcdUnlock(lcd);
+    /* return lcd status */
+    return lcd->state == LCD_ACTIVE ? LCD_OK : LCD_FAIL;
+}
+
+/**
+ * @brief Reset LCD statistics
+ *
+ * @param lcd   pointer to LCD object
+ * @return      None
+ */
+void lcdResetStats(lcd_t *const lcd)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    memset(&lcd->stats, 0, sizeof(lcd->stats));
+    lcdUnlock(lcd);
+}
+
+/**
+ * @brief Open region
+ *
+ * The region is clipped to the screen and starts blank. Regions with
+ * a higher z are drawn on top, e.g. popups over status fields.
+ * @param lcd       pointer to LCD object
+ * @param x         left column
+ * @param y         top row
+ * @param width     width in cells
+ * @param height    height in cells
+ * @param z         z-order, -128 - 127, higher is on top
+ * @param region    region handle
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRegionOpen(lcd_t *const lcd, int x, int y, int width, int height, int z, lcd_region_t *region)
+{
+    int r;
+
+    /* Own the bus */
+    lcdLock(lcd);
+
+    /* Check if lcd is active, z fits the region */
+    if (lcd->state != LCD_ACTIVE || z < INT8_MIN || z > INT8_MAX)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+
+    /* Clip to screen */
+    if (x < 0)
+    {
+        width += x;
+        x = 0;
+    }
+    if (y < 0)
+    {
+        height += y;
+        y = 0;
+    }
+    if (x + width > LCD_COLS)
+    {
+        width = LCD_COLS - x;
+    }
+    if (y + height > LCD_ROWS)
+    {
+        height = LCD_ROWS - y;
+    }
+    if (width <= 0 || height <= 0)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+
+    /* Find free region slot */
+    for (r = 0; r < LCD_MAX_REGIONS; r++)
+    {
+        if (!lcd->regions[r].used)
+        {
+            break;
+        }
+    }
+    if (r == LCD_MAX_REGIONS)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+
+    lcd_region_obj_t *reg = &lcd->regions[r];
+    reg->x = x;
+    reg->y = y;
+    reg->width = width;
+    reg->height = height;
+    reg->z = z;
+    reg->used = 1;
+    reg->visible = 1;
+    reg->lane = LCD_LANE_LOW;
+    memset(reg->cells, LCD_BLANK, sizeof(reg->cells));
+    *region = r;
+
+    lcd_record_t *rec = lcdRecordOp(lcd, LCD_RECORD_REGION_OPEN);
+    if (rec != NULL)
+    {
+        lcdRecordInt(rec, x);
+        lcdRecordInt(rec, y);
+        lcdRecordInt(rec, width);
+        lcdRecordInt(rec, height);
+        lcdRecordInt(rec, z);
+        lcdRecordVarint(rec, r);
+        lcdRecordDone(rec);
+    }
+
+    /* Claim region cells */
+    lcdRegionCompose(lcd);
+    lcdFlush(lcd);
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Set region text
+ *
+ * Text is clipped to the region, it never spills into other regions.
+ * @param lcd       pointer to LCD object
+ * @param region    region handle
+ * @param text      string text
+ * @param x         location at x-axis, relative to region
+ * @param y         location at y-axis, relative to region
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRegionSetText(lcd_t *const lcd, lcd_region_t region, const char *text, int x, int y)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    lcd_region_obj_t *reg = lcdRegionGet(lcd, region);
+    if (reg == NULL)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+
+    lcd_record_t *rec = lcdRecordOp(lcd, LCD_RECORD_REGION_TEXT);
+    if (rec != NULL)
+    {
+        size_t len = strlen(text);
+        lcdRecordVarint(rec, region);
+        lcdRecordInt(rec, x);
+        lcdRecordInt(rec, y);
+        lcdRecordVarint(rec, len);
+        lcdRecordBytes(rec, text, len);
+        lcdRecordDone(rec);
+    }
+
+    /* Write clipped text to region */
+    if (y >= 0 && y < reg->height)
+    {
+        for (; *text != '\0' && x < reg->width; x++)
+        {
+            uint8_t ch = lcdNextChar(lcd, &text, NULL);
+            if (x >= 0)
+            {
+                reg->cells[y * reg->width + x] = ch;
+            }
+        }
+    }
+
+    /* Write changed cells */
+    lcdRegionCompose(lcd);
+    lcdFlushLane(lcd, reg->lane);
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Set region integer
+ *
+ * @param lcd       pointer to LCD object
+ * @param region    region handle
+ * @param val       integer value to be displayed
+ * @param x         location at x-axis, relative to region
+ * @param y         location at y-axis, relative to region
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRegionSetInt(lcd_t *const lcd, lcd_region_t region, int val, int x, int y)
+{
+    /* Store integer to buffer */
+    char buffer[16];
+    sprintf(buffer, "%d", val);
+    /* Set integer */
+    return lcdRegionSetText(lcd, region, buffer, x, y);
+}
+
+/**
+ * @brief Clear region
+ *
+ * @param lcd       pointer to LCD object
+ * @param region    region handle
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRegionClear(lcd_t *const lcd, lcd_region_t region)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    lcd_region_obj_t *reg = lcdRegionGet(lcd, region);
+    if (reg == NULL)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+
+    lcdRecordRegion(lcd, LCD_RECORD_REGION_CLEAR, region, -1);
+
+    /* Blank region cells */
+    memset(reg->cells, LCD_BLANK, sizeof(reg->cells));
+
+    /* Write changed cells */
+    lcdRegionCompose(lcd);
+    lcdFlushLane(lcd, reg->lane);
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Show or hide region
+ *
+ * Hiding a popup uncovers the regions below it without them having
+ * to redraw.
+ * @param lcd       pointer to LCD object
+ * @param region    region handle
+ * @param visible   true: show, false: hide
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRegionShow(lcd_t *const lcd, lcd_region_t region, bool visible)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    lcd_region_obj_t *reg = lcdRegionGet(lcd, region);
+    if (reg == NULL)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+
+    lcdRecordRegion(lcd, LCD_RECORD_REGION_SHOW, region, visible);
+    reg->visible = visible;
+
+    /* Write changed cells */
+    lcdRegionCompose(lcd);
+    lcdFlushLane(lcd, reg->lane);
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Close region
+ *
+ * @param lcd       pointer to LCD object
+ * @param region    region handle
+ * @note  Cells no longer owned by any region are blanked.
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRegionClose(lcd_t *const lcd, lcd_region_t region)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    lcd_region_obj_t *reg = lcdRegionGet(lcd, region);
+    if (reg == NULL)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+
+    lcdRecordRegion(lcd, LCD_RECORD_REGION_CLOSE, region, -1);
+    reg->used = 0;
+
+    /* Write changed cells */
+    lcdRegionCompose(lcd);
+    lcdFlushLane(lcd, reg->lane);
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Set region update lane
+ *
+ * With the render task running, updates on the high lane are written
+ * before pending low lane work. @see lcdRenderStart
+ * @param lcd       pointer to LCD object
+ * @param region    region handle
+ * @param lane      LCD_LANE_LOW or LCD_LANE_HIGH
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRegionSetLane(lcd_t *const lcd, lcd_region_t region, int lane)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    lcd_region_obj_t *reg = lcdRegionGet(lcd, region);
+    if (reg == NULL || lane < 0 || lane >= LCD_LANES)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    lcdRecordRegion(lcd, LCD_RECORD_REGION_LANE, region, lane);
+    reg->lane = lane;
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Start render task
+ *
+ * Updates return once they are on the shadow screen, the render task
+ * writes them in the background. Urgent updates preempt a long low
+ * lane redraw between chunks and take over the cells they overlap.
+ * Per lane latency is kept in the statistics. @see lcdGetStats
+ * @param lcd       pointer to LCD object
+ * @param priority  render task priority
+ * @note  Run the render task below the tasks posting updates, so they
+ *        get the bus between chunks.
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRenderStart(lcd_t *const lcd, UBaseType_t priority)
+{
+    return lcdRenderStartPinned(lcd, priority, tskNO_AFFINITY);
+}
+
+/**
+ * @brief Start render task on a CPU core
+ *
+ * Keeps bus timing and the dedicated GPIO bundle on one core, producers
+ * on the other core hand updates over with lcdRingPost.
+ * @param lcd       pointer to LCD object
+ * @param priority  render task priority
+ * @param core      CPU core, tskNO_AFFINITY for any
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRenderStartPinned(lcd_t *const lcd, UBaseType_t priority, BaseType_t core)
+{
+    int lane;
+
+    /* Own the bus */
+    lcdLock(lcd);
+
+    if (lcd->state != LCD_ACTIVE || lcd->render != NULL)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+
+    /* Nothing queued yet */
+    memcpy(lcd->queued, lcd->frame, sizeof(lcd->queued));
+    memset(lcd->mark, 0, sizeof(lcd->mark));
+    for (lane = 0; lane < LCD_LANES; lane++)
+    {
+        lcd->pending[lane] = 0;
+        lcd->since[lane] = -1;
+    }
+
+    if (xTaskCreatePinnedToCore(lcdRenderTask, "LCD render", LCD_RENDER_STACK, lcd, priority, &lcd->render, core) != pdPASS)
+    {
+        lcd->render = NULL;
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Stop render task
+ *
+ * Pending cells are written before returning, later updates are
+ * written synchronously again.
+ * @param lcd   pointer to LCD object
+ * @note  Fails while producer rings are open. @see lcdRingClose
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRenderStop(lcd_t *const lcd)
+{
+    int r;
+
+    /* Own the bus, the render task is between chunks */
+    lcdLock(lcd);
+
+    for (r = 0; r < LCD_RINGS && lcd->render != NULL; r++)
+    {
+        if (lcd->rings[r] != NULL)
+        {
+            lcdUnlock(lcd);
+            return LCD_FAIL;
+        }
+    }
+    if (lcd->render == NULL)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    vTaskDelete(lcd->render);
+    lcd->render = NULL;
+
+    /* Write what is left */
+    memset(lcd->mark, 0, sizeof(lcd->mark));
+    memset(lcd->pending, 0, sizeof(lcd->pending));
+    lcdFlush(lcd);
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Set render burst period
+ *
+ * Updates queued within a period are written in one burst on the next
+ * multiple of the period, the CPU can stay in light sleep in between.
+ * High lane updates are still written at once. @see lcdGetStats
+ * @param lcd       pointer to LCD object
+ * @param periodMs  burst period in milliseconds, 0 writes at once
+ * @note  Rounded up to whole ticks.
+ * @return          lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRenderSetPeriod(lcd_t *const lcd, uint32_t periodMs)
+{
+    /* Own the bus */
+    lcdLock(lcd);
+
+    if (lcd->state != LCD_ACTIVE)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    lcd->period = (periodMs + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Start bus trace
+ *
+ * Every pin transition of the GPIO and dedicated GPIO buses is kept
+ * with its cycle count, the ring holds the newest LCD_TRACE_SIZE.
+ * Queued buses (DMA, I2C, SPI) build their waveform ahead of time and
+ * are not traced. @see lcdTraceVcd
+ * @param lcd   pointer to LCD object
+ * @param trace trace storage, owned by the caller until lcdTraceStop
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdTraceStart(lcd_t *const lcd, lcd_trace_t *trace)
+{
+    /* Own the bus, no write in progress */
+    lcdLock(lcd);
+
+    if (lcd->state != LCD_ACTIVE)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    memset(trace, 0, sizeof(lcd_trace_t));
+    trace->cpuMhz = lcd->cpuMhz;
+    trace->start = lcdCycles();
+    lcd->trace = trace;
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Stop bus trace
+ *
+ * @param lcd   pointer to LCD object
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdTraceStop(lcd_t *const lcd)
+{
+    /* Own the bus, no write in progress */
+    lcdLock(lcd);
+
+    if (lcd->trace == NULL)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    lcd->trace = NULL;
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Start API call record
+ *
+ * Text, clear, glyph, charset, play and transaction calls are appended
+ * to a compact binary log with their timing, so a production workload
+ * can be replayed on the host against new driver versions, see
+ * tools/lcd_replay.py. Region calls are recorded too, ring posts when
+ * the render task applies them.
+ * @param lcd   pointer to LCD object
+ * @param rec   call record, owned by the caller until lcdRecordStop
+ * @param buf   log storage, the log is buf[0] - buf[rec->len - 1]
+ * @param size  storage size in bytes
+ * @note  Recording stops when the storage is full. @see lcd_record_op_t
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRecordStart(lcd_t *const lcd, lcd_record_t *rec, uint8_t *buf, size_t size)
+{
+    /* Own the bus, no call in progress */
+    lcdLock(lcd);
+
+    if (lcd->state != LCD_ACTIVE)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    memset(rec, 0, sizeof(lcd_record_t));
+    rec->buf = buf;
+    rec->size = size;
+    rec->last = esp_timer_get_time();
+
+    /* Header: magic, version, bus timing and charset at start */
+    lcdRecordBytes(rec, LCD_RECORD_MAGIC, 4);
+    lcdRecordByte(rec, LCD_RECORD_VERSION);
+    lcdRecordVarint(rec, lcd->timing.pulseNs);
+    lcdRecordVarint(rec, lcd->timing.cmdUs);
+    lcdRecordVarint(rec, lcd->timing.clearUs);
+    lcdRecordByte(rec, lcd->charset);
+    if (rec->len > rec->size)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    lcd->record = rec;
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Stop API call record
+ *
+ * @param lcd   pointer to LCD object
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRecordStop(lcd_t *const lcd)
+{
+    /* Own the bus, no call in progress */
+    lcdLock(lcd);
+
+    if (lcd->record == NULL)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    lcd->record = NULL;
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Open producer ring
+ *
+ * A ring has one producer task. Its posts skip the lock and are applied
+ * by the render task, so a producer on the other core never waits for
+ * the bus or bounces the lock between cores.
+ * @param lcd   pointer to LCD object
+ * @param ring  ring storage, owned by the caller until lcdRingClose
+ * @param lane  update lane @see LCD_LANE_HIGH
+ * @note  Needs the render task. @see lcdRenderStartPinned
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRingOpen(lcd_t *const lcd, lcd_ring_t *ring, int lane)
+{
+    int r;
+
+    /* Own the bus */
+    lcdLock(lcd);
+
+    if (lcd->state != LCD_ACTIVE || lcd->render == NULL || lane < 0 || lane >= LCD_LANES)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    for (r = 0; r < LCD_RINGS; r++)
+    {
+        if (lcd->rings[r] == NULL)
+        {
+            memset(ring, 0, sizeof(lcd_ring_t));
+            ring->lcd = lcd;
+            ring->lane = lane;
+            lcd->rings[r] = ring;
+            lcdUnlock(lcd);
+            return LCD_OK;
+        }
+    }
+
+    /* No free ring slot */
+    lcdUnlock(lcd);
+    return LCD_FAIL;
+}
+
+/**
+ * @brief Post text through a producer ring
+ *
+ * Lock free, copies the text into the ring and wakes the render task.
+ * Only the task that owns the ring may post.
+ * @param ring  producer ring
+ * @param text  string text, at most LCD_RING_TEXT bytes
+ * @param x     location at x-axis, 0 - 127, from LCD_COLS on at the cursor
+ *              like lcdSetText
+ * @param y     location at y-axis, 0 - 3
+ * @return      lcd error status, LCD_FAIL when the ring is full
+ */
+lcd_err_t lcdRingPost(lcd_ring_t *ring, const char *text, int x, int y)
+{
+    /* Attached while open, lcdFree and lcdRenderStop refuse meanwhile */
+    lcd_t *const lcd = __atomic_load_n(&ring->lcd, __ATOMIC_ACQUIRE);
+    uint32_t head = ring->head;
+    size_t len = strnlen(text, LCD_RING_TEXT + 1);
+    lcd_post_t *post;
+
+    /* Posts keep the location in int8_t */
+    if (lcd == NULL || len > LCD_RING_TEXT || x < 0 || x > INT8_MAX || y < 0 || y > 3)
+    {
+        return LCD_FAIL;
+    }
+    /* Slots up to tail are free */
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= LCD_RING_SIZE)
+    {
+        ring->dropped++;
+        return LCD_FAIL;
+    }
+
+    post = &ring->posts[head % LCD_RING_SIZE];
+    post->x = x;
+    post->y = y;
+    post->len = len;
+    memcpy(post->text, text, len);
+    /* Publish the post */
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    xTaskNotifyGive(lcd->render);
+    return LCD_OK;
+}
+
+/**
+ * @brief Close producer ring
+ *
+ * Posts still in the ring are applied first. Called by the producer.
+ * @param ring  producer ring
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdRingClose(lcd_ring_t *ring)
+{
+    lcd_t *const lcd = ring->lcd;
+    int r;
+
+    if (lcd == NULL)
+    {
+        return LCD_FAIL;
+    }
+
+    /* Own the bus */
+    lcdLock(lcd);
+
+    lcdRingDrain(lcd);
+    xTaskNotifyGive(lcd->render);
+    for (r = 0; r < LCD_RINGS; r++)
+    {
+        if (lcd->rings[r] == ring)
+        {
+            lcd->rings[r] = NULL;
+        }
+    }
+    __atomic_store_n(&ring->lcd, NULL, __ATOMIC_RELEASE);
+
+    lcdUnlock(lcd);
+    return LCD_OK;
+}
+
+/**
+ * @brief Reset pins to default configuration. Freeing GPIO pins.
+ * @param lcd   pointer to LCD object
+ * @note        This function will set GPIO pins to reset configuration,
+ *              disabling the LCD. @see gpio_reset_pin()
+ * @note        Fails while producer rings are open, their producers
+ *              post without the lock. @see lcdRingClose
+ * @note        Fails inside a transaction. Call it once no other task
+ *              uses the object or waits for it, the lock is deleted.
+ *              Render task, animations and backlight are stopped here,
+ *              close a log mirror first. @see lcdLogClose
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdFree(lcd_t *const lcd)
+{
+    int r;
+
+    /* Wait for other tasks to finish with the bus */
+    lcdLock(lcd);
+
+    if (lcd->depth > 0)
+    {
+        lcdUnlock(lcd);
+        return LCD_FAIL;
+    }
+    for (r = 0; r < LCD_RINGS; r++)
+    {
+        if (lcd->rings[r] != NULL)
+        {
+            lcdUnlock(lcd);
+            return LCD_FAIL;
+        }
+    }
+
+    /* Stop trace, call record and animations, switch off backlight */
+    lcd->trace = NULL;
+    lcd->record = NULL;
+    if (lcd->anim != NULL)
+    {
+        lcdAnimClose(lcd);
+    }
+    if (lcd->backlight != NULL)
+    {
+        lcdBacklightClose(lcd);
+    }
+
+    /* Stop render task */
+    if (lcd->render != NULL)
+    {
+        vTaskDelete(lcd->render);
+        lcd->render = NULL;
+    }
+
+    /* Release bus, reset pins to default configuration */
+    if (lcd->bus != NULL && lcd->bus->release != NULL)
+    {
+        lcd->bus->release(lcd);
+    }
+    lcd->bus = NULL;
+
+    /* Update gpio pins to no connection */
+    for (int i = 0; i < LCD_DATA_LINE; i++)
+    {
+        lcd->data[i] = GPIO_NUM_NC; /* Set to no connection */
+    }
+
+    lcd->en = GPIO_NUM_NC;     /* Set to no connection */
+    lcd->regSel = GPIO_NUM_NC; /* Set to no connection */
+    lcd->rw = GPIO_NUM_NC;     /* Set to no connection */
+
+    lcd->state = (lcd_state_t)LCD_INACTIVE;
+
+    /* Delete lock, later calls fail on state */
+    if (lcd->lock != NULL)
+    {
+        /* Every level, e.g. when called from a callback under the lock */
+        while (xSemaphoreGetMutexHolder(lcd->lock) == xTaskGetCurrentTaskHandle())
+        {
+            lcdUnlock(lcd);
+        }
+        vSemaphoreDelete(lcd->lock);
+        lcd->lock = NULL;
+    }
+    return LCD_OK;
+}
+
+/**
+ * @brief Take LCD object from the static pool
+ *
+ * The pool holds LCD_POOL_SIZE objects in static memory, set it with
+ * a compile definition of the component. Construct the object as
+ * usual, e.g. lcdCtor.
+ * @note  Boards with many displays need neither the heap nor a global
+ *        per display. @see LCD_INSTANCE_BUDGET
+ * @return      LCD object, NULL when the pool is empty
+ */
+lcd_t *lcdPoolTake(void)
+{
+    lcd_t *lcd = NULL;
+#if LCD_POOL_SIZE > 0
+    int i;
+
+    portENTER_CRITICAL(&lcd_pool_mux);
+    for (i = 0; i < LCD_POOL_SIZE; i++)
+    {
+        if (!(lcd_pool_used & (1UL << i)))
+        {
+            lcd_pool_used |= 1UL << i;
+            lcd = &lcd_pool[i];
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lcd_pool_mux);
+#endif
+    return lcd;
+}
+
+/**
+ * @brief Free LCD object and give it back to the static pool
+ *
+ * @param lcd   LCD object from lcdPoolTake
+ * @note  Kept when lcdFree fails. @see lcdFree
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdPoolGive(lcd_t *const lcd)
+{
+#if LCD_POOL_SIZE > 0
+    int i;
+
+    /* Equality only, pointers from elsewhere are not ordered against the pool */
+    for (i = 0; i < LCD_POOL_SIZE && lcd != &lcd_pool[i]; i++)
+    {
+    }
+    if (i == LCD_POOL_SIZE || !(lcd_pool_used & (1UL << i)))
+    {
+        return LCD_FAIL;
+    }
+    if (lcd->bus != NULL && lcdFree(lcd) != LCD_OK)
+    {
+        return LCD_FAIL;
+    }
+    portENTER_CRITICAL(&lcd_pool_mux);
+    lcd_pool_used &= ~(1UL << i);
+    portEXIT_CRITICAL(&lcd_pool_mux);
+    return LCD_OK;
+#else
+    return LCD_FAIL;
+#endif
+}
+
+void assert_lcd(lcd_err_t lcd_error){
+    if (lcd_error == LCD_FAIL)
+    {
+      ESP_LOGE(lcd_tag, "LCD has failed!!!\n"); /* Display error message */
+    }
+    else
+    {
+      ESP_LOGI(lcd_tag, "LCD write was sucessfull...\n");
+    }
+}
\ No newline at end of file
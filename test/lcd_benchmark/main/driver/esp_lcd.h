@@ -0,0 +1,828 @@
+/**
+ * @file esp_lcd.h
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display header file
+ * @version 0.1
+ * @date 2022-08-15
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef _ESP_LCD_H_
+#define _ESP_LCD_H_
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* LCD Error */
+typedef int lcd_err_t;      /*!< LCD error type */
+
+#define LCD_FAIL            -1  /*!< LCD fail error */
+#define LCD_OK               0  /*!< LCD success    */
+
+
+#define LCD_DATA_LINE 4 /*!< 4-Bit data line */
+
+/* LCD geometry */
+#define LCD_COLS        16                      /*!< Visible columns */
+#define LCD_ROWS        2                       /*!< Visible rows */
+#define LCD_DDRAM_LINE  40                      /*!< DDRAM bytes per display line */
+#define LCD_DDRAM_SIZE  (2 * LCD_DDRAM_LINE)    /*!< DDRAM size in bytes */
+
+#define LCD_MAX_REGIONS 4 /*!< Maximum regions per LCD object */
+
+#define LCD_GLYPHS      8   /*!< CGRAM glyphs, character codes 0 - 7 */
+#define LCD_GLYPH_ROWS  8   /*!< Rows per 5x8 glyph */
+
+typedef int lcd_region_t;   /*!< LCD region handle */
+
+#define LCD_UTF8_INVALID 0xFFFD /*!< Replacement for malformed UTF-8 */
+
+/* LCD bus lines, bit positions of a bus state */
+#define LCD_LINE_D4     (1 << 0)    /*!< Data 4 */
+#define LCD_LINE_D5     (1 << 1)    /*!< Data 5 */
+#define LCD_LINE_D6     (1 << 2)    /*!< Data 6 */
+#define LCD_LINE_D7     (1 << 3)    /*!< Data 7 */
+#define LCD_LINE_RS     (1 << 4)    /*!< Register select, 0: command, 1: data */
+#define LCD_LINE_RW     (1 << 5)    /*!< Read/write, 0: write, 1: read */
+#define LCD_LINE_EN     (1 << 6)    /*!< Enable */
+#define LCD_LINE_BL     (1 << 7)    /*!< Backlight */
+#define LCD_LINE_DATA   0x0F        /*!< Data 4 - 7 */
+
+/* Precompiled screen records @see lcdPlay */
+#define LCD_PLAY_CLEAR          0x01                                    /*!< Clear LCD, no data */
+#define LCD_PLAY_AT(x, y)       (0x80 | (((y) & 1 ? 0x40 : 0x00) + (x)))  /*!< Text at x, y */
+#define LCD_PLAY_GLYPH(slot)    (0x40 | ((slot) << 3))                  /*!< Glyph rows from slot */
+
+typedef struct lcd lcd_t;   /*!< LCD object */
+
+/******************************************************************
+ * \struct lcd_bus_t esp_lcd.h
+ * \brief LCD bus backend
+ *
+ * The driver talks to the LCD one nibble at a time through the bus
+ * backend selected by the constructor. Batching backends may queue
+ * writes until flush, as long as every wait is honoured.
+ *******************************************************************/
+typedef struct
+{
+    void (*write)(lcd_t *const lcd, uint8_t lines, uint32_t us);    /*!< Latch D4 - D7 and RS from lines, then wait us */
+    int (*read)(lcd_t *const lcd, uint8_t lines);                    /*!< Read byte with RS from lines */
+    void (*flush)(lcd_t *const lcd);                                 /*!< Complete queued writes, may be NULL */
+    void (*release)(lcd_t *const lcd);                               /*!< Release bus resources, may be NULL */
+} lcd_bus_t;
+
+/******************************************************************
+ * \struct lcd_wave_t esp_lcd.h
+ * \brief LCD bus waveform shape
+ *
+ * Describes how bus lines map to the output bits of a parallel, I2C
+ * or SPI sample and how many samples each phase of a write lasts.
+ * @see lcdWaveEncode
+ *******************************************************************/
+typedef struct
+{
+    uint8_t map[8];     /*!< Output bit of each bus line, 8 or more when not wired */
+    uint8_t idle;       /*!< Output bits not driven by bus lines */
+    uint16_t setup;     /*!< Samples with EN low before the pulse */
+    uint16_t pulse;     /*!< Samples with EN high */
+    uint16_t hold;      /*!< Samples with EN low after the pulse */
+} lcd_wave_t;
+
+/******************************************************************
+ * \struct lcd_dma_config_t esp_lcd.h
+ * \brief LCD DMA parallel bus configuration
+ *
+ * Bus lines are wired to the I80 data lines in bus line order,
+ * WR and DC are required by the peripheral but left unconnected.
+ *******************************************************************/
+typedef struct
+{
+    gpio_num_t data[LCD_DATA_LINE]; /*!< Data 4 - 7 */
+    gpio_num_t regSel;              /*!< Register select */
+    gpio_num_t rw;                  /*!< Read/write, driven low */
+    gpio_num_t en;                  /*!< Enable */
+    gpio_num_t bl;                  /*!< Backlight, driven high */
+    gpio_num_t wr;                  /*!< Peripheral write clock, unconnected */
+    gpio_num_t dc;                  /*!< Peripheral data/command, unconnected */
+    uint32_t clockHz;               /*!< Sample clock */
+    size_t bufSize;                 /*!< Waveform buffer in bytes */
+} lcd_dma_config_t;
+
+#define LCD_DMA_CLOCK_HZ    1000000 /*!< Default DMA sample clock */
+#define LCD_DMA_BUF_SIZE    4096    /*!< Default DMA waveform buffer */
+
+/******************************************************************
+ * \struct lcd_i2c_config_t esp_lcd.h
+ * \brief LCD I2C expander bus configuration
+ *
+ * map gives the expander pin of each bus line. @see LCD_LINE_RS
+ *******************************************************************/
+typedef struct
+{
+    int port;           /*!< I2C port number */
+    gpio_num_t sda;     /*!< I2C data */
+    gpio_num_t scl;     /*!< I2C clock */
+    uint8_t addr;       /*!< 7-bit expander address */
+    uint32_t clockHz;   /*!< I2C clock */
+    uint8_t map[8];     /*!< Expander pin of each bus line, 8 when not wired */
+} lcd_i2c_config_t;
+
+#define LCD_I2C_PCF8574_MAP {4, 5, 6, 7, 0, 1, 2, 3}   /*!< Common PCF8574 backpack wiring */
+#define LCD_I2C_ADDR        0x27                        /*!< PCF8574 address, 0x3F for PCF8574A */
+#define LCD_I2C_CLOCK_HZ    100000                      /*!< Default I2C clock */
+
+/******************************************************************
+ * \struct lcd_spi_config_t esp_lcd.h
+ * \brief LCD SPI shift register bus configuration
+ *
+ * map gives the register output of each bus line. @see LCD_LINE_RS
+ *******************************************************************/
+typedef struct
+{
+    int host;           /*!< SPI host, SPI2_HOST or SPI3_HOST */
+    gpio_num_t mosi;    /*!< Register serial input */
+    gpio_num_t sclk;    /*!< Register shift clock */
+    gpio_num_t latch;   /*!< Register latch clock, driven as CS */
+    uint32_t clockHz;   /*!< SPI clock */
+    uint8_t map[8];     /*!< Register output of each bus line, 8 when not wired */
+} lcd_spi_config_t;
+
+#define LCD_SPI_595_MAP     {0, 1, 2, 3, 4, 8, 6, 7}   /*!< QA - QD data, QE RS, QG EN, QH backlight */
+#define LCD_SPI_CLOCK_HZ    1000000                     /*!< Default SPI clock */
+
+/******************************************************************
+ * \struct lcd_timing_t esp_lcd.h
+ * \brief LCD bus timing
+ *******************************************************************/
+typedef struct
+{
+    uint16_t pulseNs;   /*!< Enable pulse width and recovery */
+    uint16_t cmdUs;     /*!< Instruction execution time */
+    uint16_t clearUs;   /*!< Clear and home execution time */
+} lcd_timing_t;
+
+/* Calibration keys, identify a display by its wiring @see lcdCalibrate */
+#define LCD_CAL_KEY_GPIO    0x01000000  /*!< GPIO bus, en, regSel, D4 and R/W pins in 6 bits each */
+#define LCD_CAL_KEY_I2C     0x02000000  /*!< I2C bus, port and expander address */
+
+/******************************************************************
+ * \enum lcd_charset_t esp_lcd.h
+ * \brief LCD text encoding
+ *******************************************************************/
+typedef enum {
+    LCD_CHARSET_RAW = 0,    /*!< Bytes are written as is */
+    LCD_CHARSET_A00 = 1,    /*!< UTF-8 mapped to the A00 (Japanese) ROM */
+    LCD_CHARSET_A02 = 2,    /*!< UTF-8 mapped to the A02 (European) ROM */
+}lcd_charset_t;
+
+/******************************************************************
+ * \enum lcd_state esp_lcd.h 
+ * \brief LCD state enumeration
+ *******************************************************************/
+typedef enum {
+    LCD_INACTIVE = 0,   /*!< LCD inactive */
+    LCD_ACTIVE = 1,     /*!< LCD active   */
+}lcd_state_t;
+
+/******************************************************************
+ * \struct lcd_span_t esp_lcd.h
+ * \brief Text span, a slice of caller memory placed on screen
+ *******************************************************************/
+typedef struct
+{
+    const char *buf;    /*!< Text, not NUL terminated */
+    size_t len;         /*!< Text length in bytes */
+    int x;              /*!< Location at x-axis */
+    int y;              /*!< Location at y-axis */
+} lcd_span_t;
+
+/* Terminal @see lcdTermOpen */
+#define LCD_TERM_PATH   16  /*!< VFS path size, with terminator */
+#define LCD_TERM_PARAMS 2   /*!< Escape sequence parameters kept */
+#define LCD_TERM_TAB    4   /*!< Tab stop width */
+
+/******************************************************************
+ * \struct lcd_term_t esp_lcd.h
+ * \brief Terminal model, the visible screen as code points plus the
+ *        cursor and escape sequence parser state
+ *******************************************************************/
+typedef struct
+{
+    lcd_t *lcd;                             /*!< LCD object */
+    uint32_t cells[LCD_ROWS][LCD_COLS];     /*!< Screen contents */
+    uint8_t col;                            /*!< Cursor column, LCD_COLS when a wrap is due */
+    uint8_t row;                            /*!< Cursor row */
+    uint8_t state;                          /*!< Escape sequence parser state */
+    uint8_t params[LCD_TERM_PARAMS];        /*!< Escape sequence parameters */
+    uint8_t nparams;                        /*!< Escape sequence parameters seen */
+    uint8_t utf8[4];                        /*!< Partial UTF-8 sequence */
+    uint8_t utf8Len;                        /*!< Partial UTF-8 sequence length */
+    char path[LCD_TERM_PATH];               /*!< VFS path, empty when not registered */
+} lcd_term_t;
+
+/* Bus trace @see lcdTraceStart */
+#define LCD_TRACE_SIZE  512 /*!< Trace samples kept, power of two */
+
+/******************************************************************
+ * \struct lcd_trace_sample_t esp_lcd.h
+ * \brief Bus lines after a pin transition
+ *******************************************************************/
+typedef struct
+{
+    uint32_t cycles;    /*!< CPU cycles since trace start */
+    uint8_t lines;      /*!< Bus lines @see LCD_LINE_RS */
+} lcd_trace_sample_t;
+
+/******************************************************************
+ * \struct lcd_trace_t esp_lcd.h
+ * \brief Bus trace, a ring of the newest pin transitions
+ *******************************************************************/
+typedef struct
+{
+    lcd_trace_sample_t samples[LCD_TRACE_SIZE]; /*!< Newest transitions */
+    uint32_t count;                             /*!< Transitions taken, ring position */
+    uint32_t start;                             /*!< Cycle counter at trace start */
+    uint16_t cpuMhz;                            /*!< CPU clock of the cycle counts */
+    uint8_t lines;                              /*!< Current bus lines */
+} lcd_trace_t;
+
+/* API call record @see lcdRecordStart */
+#define LCD_RECORD_MAGIC    "LCDR"  /*!< Record log magic */
+#define LCD_RECORD_VERSION  2       /*!< Record log format version */
+
+/******************************************************************
+ * \enum lcd_record_op_t esp_lcd.h
+ * \brief Recorded call, one record each
+ *
+ * A record is the op byte, the time since the previous record in
+ * microseconds as a varint, then the arguments. Integers are LEB128
+ * varints, signed ones zigzag encoded.
+ *******************************************************************/
+typedef enum {
+    LCD_RECORD_TEXT = 1,    /*!< lcdSetText, lcdWrite: x, y, len, bytes */
+    LCD_RECORD_INT = 2,     /*!< lcdSetInt: x, y, value */
+    LCD_RECORD_SPANS = 3,   /*!< lcdWriteSpans: count, then x, y, len, bytes each */
+    LCD_RECORD_PLAY = 4,    /*!< lcdPlay: size, stream */
+    LCD_RECORD_CLEAR = 5,   /*!< lcdClear */
+    LCD_RECORD_GLYPH = 6,   /*!< lcdSetGlyph: slot, 8 rows */
+    LCD_RECORD_CHARSET = 7, /*!< lcdSetCharset: charset */
+    LCD_RECORD_BEGIN = 8,   /*!< lcdBegin */
+    LCD_RECORD_COMMIT = 9,  /*!< lcdCommit */
+    LCD_RECORD_REGION_OPEN = 10,    /*!< lcdRegionOpen: x, y, width, height, z, region */
+    LCD_RECORD_REGION_TEXT = 11,    /*!< lcdRegionSetText, lcdRegionSetInt: region, x, y, len, bytes */
+    LCD_RECORD_REGION_CLEAR = 12,   /*!< lcdRegionClear: region */
+    LCD_RECORD_REGION_SHOW = 13,    /*!< lcdRegionShow: region, visible */
+    LCD_RECORD_REGION_CLOSE = 14,   /*!< lcdRegionClose: region */
+    LCD_RECORD_REGION_LANE = 15,    /*!< lcdRegionSetLane: region, lane */
+    LCD_RECORD_RING = 16,   /*!< lcdRingPost, once applied: x, y, len, bytes */
+}lcd_record_op_t;
+
+/******************************************************************
+ * \struct lcd_record_t esp_lcd.h
+ * \brief API call record, a binary log in caller memory
+ *******************************************************************/
+typedef struct
+{
+    uint8_t *buf;       /*!< Log storage */
+    size_t size;        /*!< Storage size in bytes */
+    size_t len;         /*!< Log length in bytes */
+    size_t start;       /*!< Start of the record being written */
+    int64_t last;       /*!< Time of the previous record in microseconds */
+    uint32_t calls;     /*!< Calls recorded */
+    uint8_t overflow;   /*!< Storage ran out, later calls were not recorded */
+} lcd_record_t;
+
+/******************************************************************
+ * \struct lcd_snapshot_t esp_lcd.h
+ * \brief Copy of what the LCD shows, taken from the driver's cache
+ *******************************************************************/
+typedef struct
+{
+    uint8_t text[LCD_ROWS][LCD_COLS];           /*!< Visible cells as character codes, 0 - 7 are glyphs */
+    uint8_t cgram[LCD_GLYPHS][LCD_GLYPH_ROWS];  /*!< Glyph bitmaps */
+    uint8_t glyphs;                             /*!< Bitmask of loaded glyphs */
+    uint8_t cursorX;                            /*!< Cursor column, 0 - 39 */
+    uint8_t cursorY;                            /*!< Cursor row */
+    bool cursorOn;                              /*!< Cursor underline shown */
+    bool cursorBlink;                           /*!< Cursor block blinking */
+    lcd_charset_t charset;                      /*!< Text encoding */
+    uint16_t pending;                           /*!< Visible cells queued but not yet written */
+} lcd_snapshot_t;
+
+/******************************************************************
+ * \struct lcd_log_config_t esp_lcd.h
+ * \brief Log sink configuration
+ *******************************************************************/
+typedef struct
+{
+    esp_log_level_t level;  /*!< Most verbose level shown */
+    const char *tag;        /*!< Only lines of this tag, NULL for all, kept by reference */
+    uint8_t row;            /*!< First LCD row used */
+    uint8_t rows;           /*!< Rows used, the newest line at the bottom */
+    uint32_t intervalMs;    /*!< Minimum time between LCD updates */
+} lcd_log_config_t;
+
+#define LCD_LOG_INTERVAL_MS 500 /*!< Default log update interval */
+
+/* Backlight @see lcdBacklightOpen */
+#define LCD_BL_FREQ_HZ  5000    /*!< Default PWM frequency */
+#define LCD_BL_FADE_MS  300     /*!< Default fade time */
+#define LCD_BL_DUTY_MAX 1023    /*!< Full duty, 10-bit PWM */
+#define LCD_BL_CHECKS   4       /*!< Idle checks per idle timeout */
+
+typedef struct lcd_backlight lcd_backlight_t;   /*!< LCD backlight */
+
+/******************************************************************
+ * \struct lcd_backlight_config_t esp_lcd.h
+ * \brief Backlight configuration
+ *******************************************************************/
+typedef struct
+{
+    gpio_num_t pin;     /*!< PWM output, e.g. to the backlight transistor */
+    int timer;          /*!< LEDC timer, 0 - 3 */
+    int channel;        /*!< LEDC channel */
+    uint32_t freqHz;    /*!< PWM frequency */
+    uint8_t on;         /*!< Brightness while active, 0 - 255 */
+    uint8_t dim;        /*!< Brightness once idle, 0 - 255 */
+    uint32_t idleMs;    /*!< Time without updates before dimming, 0 never dims */
+    uint32_t fadeMs;    /*!< Fade time, 0 switches at once */
+} lcd_backlight_config_t;
+
+/******************************************************************
+ * \struct lcd_pwm_t esp_lcd.h
+ * \brief Backlight PWM backend
+ *
+ * LEDC drives the backlight on the device. A host build can stand in
+ * its own backend to check the duty sequence. @see lcdBacklightOpenPwm
+ *******************************************************************/
+typedef struct
+{
+    bool (*init)(lcd_backlight_t *bl);                              /*!< Set up the output, duty 0 */
+    void (*fade)(lcd_backlight_t *bl, uint32_t duty, uint32_t ms);  /*!< Fade to duty, 0 - LCD_BL_DUTY_MAX, without waiting */
+    void (*release)(lcd_backlight_t *bl);                           /*!< Output off, may be NULL */
+} lcd_pwm_t;
+
+/******************************************************************
+ * \struct lcd_backlight esp_lcd.h
+ * \brief Backlight state, owned by the caller while open
+ *******************************************************************/
+struct lcd_backlight
+{
+    lcd_t *lcd;                     /*!< LCD object */
+    lcd_backlight_config_t config;  /*!< Levels and timing */
+    const lcd_pwm_t *pwm;           /*!< PWM backend */
+    esp_timer_handle_t idle;        /*!< Periodic idle check, stopped while dimmed */
+    int64_t last;                   /*!< Last update in microseconds */
+    uint32_t duty;                  /*!< Duty faded to */
+    uint8_t dimmed;                 /*!< Dimmed after the idle timeout */
+};
+
+/* Glyph animation @see lcdAnimOpen */
+#define LCD_ANIM_TICK_MS    20  /*!< Default animation tick */
+
+typedef struct lcd_anim lcd_anim_t;    /*!< LCD glyph animations */
+
+/******************************************************************
+ * \struct lcd_sprite_t esp_lcd.h
+ * \brief Animated glyph slot
+ *******************************************************************/
+typedef struct
+{
+    const uint8_t (*frames)[LCD_GLYPH_ROWS];    /*!< Frame bitmaps, kept by reference */
+    int64_t due;                                /*!< Next frame in microseconds */
+    uint32_t frameUs;                           /*!< Time per frame */
+    uint8_t count;                              /*!< Number of frames */
+    uint8_t frame;                              /*!< Frame shown */
+} lcd_sprite_t;
+
+/******************************************************************
+ * \struct lcd_anim esp_lcd.h
+ * \brief Glyph animations, owned by the caller while open
+ *******************************************************************/
+struct lcd_anim
+{
+    lcd_t *lcd;                             /*!< LCD object */
+    esp_timer_handle_t tick;                /*!< Periodic tick, stopped while nothing animates */
+    lcd_sprite_t sprites[LCD_GLYPHS];       /*!< Animation of each glyph slot */
+    uint32_t tickUs;                        /*!< Tick period */
+    uint32_t budgetUs;                      /*!< Bus time per tick, 0 unlimited */
+    uint32_t costUs;                        /*!< Bus time of the last glyph write */
+    uint32_t frames;                        /*!< Glyph frames written */
+    uint32_t deferred;                      /*!< Frames moved to a later tick by the budget */
+    uint8_t active;                         /*!< Bitmask of animated slots */
+};
+
+/* Widgets @see lcdUiInit */
+#define LCD_UI_CURSOR       '>'     /*!< Selected list item */
+#define LCD_UI_MORE_UP      '^'     /*!< List continues above */
+#define LCD_UI_MORE_DOWN    'v'     /*!< List continues below */
+#define LCD_UI_OVERFLOW     '*'     /*!< Number wider than its field */
+
+/******************************************************************
+ * \enum lcd_ui_kind_t esp_lcd.h
+ * \brief Widget kind
+ *******************************************************************/
+typedef enum {
+    LCD_UI_LABEL = 0,   /*!< Text */
+    LCD_UI_NUMBER = 1,  /*!< Integer with optional unit, up and down step it within range */
+    LCD_UI_LIST = 2,    /*!< Items with a selection cursor and scroll indicators */
+}lcd_ui_kind_t;
+
+/******************************************************************
+ * \enum lcd_ui_key_t esp_lcd.h
+ * \brief Input event, from buttons or an encoder
+ *******************************************************************/
+typedef enum {
+    LCD_UI_KEY_UP = 0,      /*!< Up button, encoder step back */
+    LCD_UI_KEY_DOWN = 1,    /*!< Down button, encoder step forward */
+    LCD_UI_KEY_OK = 2,      /*!< Select, encoder push */
+    LCD_UI_KEY_BACK = 3,    /*!< Back, cancel */
+}lcd_ui_key_t;
+
+typedef struct lcd_widget lcd_widget_t;   /*!< LCD widget */
+
+typedef void (*lcd_ui_hook_t)(lcd_widget_t *widget, lcd_ui_key_t key, void *arg);  /*!< Key hook of a focused widget */
+
+/******************************************************************
+ * \struct lcd_widget esp_lcd.h
+ * \brief Widget, one row of cells or a list of rows, owned by the caller
+ *******************************************************************/
+struct lcd_widget
+{
+    lcd_widget_t *next;         /*!< Next widget on the screen */
+    const char *text;           /*!< Label text or number unit, kept by reference */
+    const char *const *items;   /*!< List items, kept by reference */
+    lcd_ui_hook_t hook;         /*!< Called after the widget handled a key, NULL none */
+    void *arg;                  /*!< Hook argument */
+    int32_t value;              /*!< Number value, selected list item */
+    int32_t min;                /*!< Lowest number */
+    int32_t max;                /*!< Highest number */
+    int32_t step;               /*!< Number change per key */
+    uint8_t kind;               /*!< Widget kind @see lcd_ui_kind_t */
+    uint8_t x;                  /*!< Left column */
+    uint8_t y;                  /*!< Top row */
+    uint8_t width;              /*!< Width in cells */
+    uint8_t rows;               /*!< List rows shown */
+    uint8_t count;              /*!< List items */
+    uint8_t top;                /*!< First list item shown */
+    uint8_t dirty;              /*!< Changed since the last render */
+};
+
+/******************************************************************
+ * \struct lcd_ui_t esp_lcd.h
+ * \brief Screen of widgets, used by one task
+ *******************************************************************/
+typedef struct
+{
+    lcd_t *lcd;                 /*!< LCD object */
+    lcd_widget_t *first;        /*!< Widgets, in order of adding */
+    lcd_widget_t *focus;        /*!< Widget receiving keys, NULL none */
+} lcd_ui_t;
+
+/* Update priority lanes @see lcdRenderStart */
+#define LCD_LANE_LOW    0   /*!< Bulk updates, menus and redraws */
+#define LCD_LANE_HIGH   1   /*!< Urgent updates, alerts */
+#define LCD_LANES       2   /*!< Number of lanes */
+
+/* Producer rings @see lcdRingOpen */
+#define LCD_RINGS       4   /*!< Producer rings per LCD object */
+#define LCD_RING_SIZE   16  /*!< Posts per ring, power of two */
+#define LCD_RING_TEXT   16  /*!< Text bytes per post */
+
+/******************************************************************
+ * \struct lcd_post_t esp_lcd.h
+ * \brief Text update posted to a producer ring
+ *******************************************************************/
+typedef struct
+{
+    int8_t x;                   /*!< Location at x-axis */
+    int8_t y;                   /*!< Location at y-axis */
+    uint8_t len;                /*!< Text length in bytes */
+    char text[LCD_RING_TEXT];   /*!< Text, not NUL terminated */
+} lcd_post_t;
+
+/******************************************************************
+ * \struct lcd_ring_t esp_lcd.h
+ * \brief Single producer, single consumer update ring. One producer
+ *        task posts, the render task drains, neither takes the lock.
+ *******************************************************************/
+typedef struct
+{
+    lcd_t *lcd;                         /*!< LCD object */
+    uint8_t lane;                       /*!< Update lane @see LCD_LANE_HIGH */
+    volatile uint32_t head;             /*!< Next post, written by the producer */
+    volatile uint32_t tail;             /*!< Next drain, written by the render task */
+    uint32_t dropped;                   /*!< Posts refused on a full ring */
+    lcd_post_t posts[LCD_RING_SIZE];    /*!< Posted updates */
+} lcd_ring_t;
+
+/******************************************************************
+ * \struct lcd_lane_stats_t esp_lcd.h
+ * \brief LCD update lane statistics
+ *******************************************************************/
+typedef struct
+{
+    uint32_t updates;           /*!< Times the lane was drained */
+    uint32_t cells;             /*!< Cells written */
+    uint32_t cancelled;         /*!< Pending cells taken over by a higher lane */
+    uint32_t latencyMaxUs;      /*!< Worst queue to drained time */
+    uint64_t latencyTotalUs;    /*!< Sum of queue to drained times */
+} lcd_lane_stats_t;
+
+/******************************************************************
+ * \struct lcd_stats_t esp_lcd.h
+ * \brief LCD statistics
+ *******************************************************************/
+typedef struct
+{
+    uint32_t probes;        /*!< Address counter read-backs */
+    uint32_t readErrors;    /*!< Reads the bus failed, inconclusive */
+    uint32_t desyncs;       /*!< Detected nibble desyncs */
+    uint32_t recoveries;    /*!< Bus resets and repaints */
+    uint32_t scrubbed;      /*!< Scrubbed cells */
+    uint32_t repaired;      /*!< Scrubbed cells rewritten */
+    uint32_t wakeups;       /*!< Timer wakeups, bus sleeps and aligned bursts */
+    uint32_t bursts;        /*!< Render task bursts */
+    uint32_t fallbacks;     /*!< Dedicated GPIO bus given up for the GPIO bus, no channels */
+    lcd_lane_stats_t lanes[LCD_LANES]; /*!< Render task lanes */
+} lcd_stats_t;
+
+/******************************************************************
+ * \struct lcd_region_obj_t esp_lcd.h
+ * \brief LCD region, a clipped rectangle of the screen with its own
+ *        cell buffer. Visible regions are composed into the shadow
+ *        screen by z-order, the highest z owns the cell.
+ *******************************************************************/
+typedef struct
+{
+    uint8_t x;                              /*!< Left column on screen */
+    uint8_t y;                              /*!< Top row on screen */
+    uint8_t width;                          /*!< Width in cells */
+    uint8_t height;                         /*!< Height in cells */
+    int8_t z;                               /*!< Z-order, higher is on top */
+    uint8_t used;                           /*!< Region slot in use */
+    uint8_t visible;                        /*!< Region is composed */
+    uint8_t lane;                           /*!< Update lane @see LCD_LANE_HIGH */
+    uint8_t cells[LCD_ROWS * LCD_COLS];     /*!< Region contents, row major */
+} lcd_region_obj_t;
+
+typedef int8_t lcd_pin_t;    /*!< GPIO pin, GPIO_NUM_NC when not connected */
+
+#define LCD_PROBE_MS    100     /*!< Sync probe interval after writes on buses with costly reads */
+
+#define LCD_INSTANCE_BUDGET 792 /*!< lcd_t bytes on a 32-bit target, lock storage excluded */
+
+/******************************************************************
+ * \struct lcd_t esp_lcd.h 
+ * \brief LCD object
+ * 
+ * ### Example
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~.c
+ * typedef struct {
+ *      lcd_pin_t data[LCD_DATA_LINE];
+ *      lcd_pin_t en;
+ *      lcd_pin_t regSel;
+ *      uint8_t state : 1;
+ *      ...
+ * }lcd_t;
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * ### Memory budget
+ * Fields are ordered by size so the object has no padding holes.
+ * Sizes for a 32-bit target. @see LCD_INSTANCE_BUDGET
+ * | Fields                                   | Bytes |
+ * | ---------------------------------------- | ----- |
+ * | since, stats                             |   104 |
+ * | frame, ddram, queued, mark               |   320 |
+ * | regions, owner                           |   192 |
+ * | cgram                                    |    64 |
+ * | lockBuffer, depends on FreeRTOS config   |  ~ 84 |
+ * | handles, rings, ticks, busCore, calKey   |    64 |
+ * | glyphCode, pending                       |    20 |
+ * | timing, pins, counters and flags         |    24 |
+ * | total                                    | ~ 880 |
+ *******************************************************************/
+struct lcd
+{
+    int64_t since[LCD_LANES];       /*!< Oldest pending update per lane, -1 none */
+    lcd_stats_t stats;              /*!< LCD statistics */
+    uint8_t frame[LCD_DDRAM_SIZE];  /*!< Shadow screen, requested DDRAM contents */
+    uint8_t ddram[LCD_DDRAM_SIZE];  /*!< DDRAM contents written to the LCD */
+    uint8_t queued[LCD_DDRAM_SIZE]; /*!< Shadow screen as last queued */
+    uint8_t mark[LCD_DDRAM_SIZE];   /*!< Pending lane + 1 of each cell, 0 when clean */
+    lcd_region_obj_t regions[LCD_MAX_REGIONS];      /*!< LCD regions */
+    int8_t owner[LCD_ROWS * LCD_COLS];              /*!< Region owning each visible cell, -1 none */
+    uint8_t cgram[LCD_GLYPHS][LCD_GLYPH_ROWS];      /*!< CGRAM contents written to the LCD */
+    StaticSemaphore_t lockBuffer;   /*!< Lock storage */
+    SemaphoreHandle_t lock;         /*!< Bus ownership, recursive */
+    const lcd_bus_t *bus;           /*!< Bus backend */
+    void *busHandle;                /*!< Bus backend handle */
+    TaskHandle_t render;            /*!< Render task, NULL when writing synchronously */
+    lcd_ring_t *rings[LCD_RINGS];   /*!< Producer rings drained by the render task */
+    lcd_trace_t *trace;             /*!< Bus trace, NULL when off */
+    lcd_record_t *record;           /*!< API call record, NULL when off */
+    lcd_backlight_t *backlight;     /*!< Backlight, NULL when not driven */
+    lcd_anim_t *anim;               /*!< Glyph animations, NULL when closed */
+    TickType_t period;              /*!< Render burst period in ticks, 0 writes at once */
+    TickType_t probed;              /*!< Last sync probe after a write, with lazyProbe */
+    BaseType_t busCore;             /*!< CPU core owning a per core bus, tskNO_AFFINITY else */
+    uint32_t calKey;                /*!< Calibration key, 0 when the bus has none @see LCD_CAL_KEY_GPIO */
+    uint16_t glyphCode[LCD_GLYPHS]; /*!< Code point of fallback glyphs, 0 for custom glyphs */
+    uint16_t pending[LCD_LANES];    /*!< Pending cells per lane */
+    lcd_timing_t timing;            /*!< Bus timing */
+    uint16_t cpuMhz;                /*!< CPU clock for nanosecond delays */
+    lcd_pin_t data[LCD_DATA_LINE];  /*!< LCD data line  */
+    lcd_pin_t en;                   /*!< LCD enable pin */
+    lcd_pin_t regSel;               /*!< LCD register select */
+    lcd_pin_t rw;                   /*!< LCD read/write, GPIO_NUM_NC when tied to GND */
+    uint8_t cursor;                 /*!< Shadow address counter, DDRAM index */
+    uint8_t ac;                     /*!< LCD address counter, DDRAM index */
+    uint8_t glyphs;                 /*!< Bitmask of loaded CGRAM glyphs */
+    uint8_t glyphNext;              /*!< Next fallback glyph to evict */
+    uint8_t glyphDirty;             /*!< Bitmask of glyphs deferred to lcdCommit */
+    uint8_t scrub;                  /*!< Scrubber position */
+    uint8_t depth;                  /*!< Open transactions @see lcdBegin */
+    uint8_t state : 1;              /*!< LCD state @see lcd_state_t */
+    uint8_t readable : 1;           /*!< Bus can read back the LCD */
+    uint8_t clearPending : 1;       /*!< Clear deferred to lcdCommit */
+    uint8_t charset : 2;            /*!< Text encoding @see lcd_charset_t */
+    uint8_t lazyProbe : 1;          /*!< Reads are costly, writes probe sync at most every LCD_PROBE_MS */
+};
+
+void lcdDefault(lcd_t *const lcd);
+
+void lcdInit(lcd_t *const lcd);
+
+void lcdCtor(lcd_t *lcd, gpio_num_t data[LCD_DATA_LINE], gpio_num_t en, gpio_num_t regSel);
+
+void lcdCtorRW(lcd_t *lcd, gpio_num_t data[LCD_DATA_LINE], gpio_num_t en, gpio_num_t regSel, gpio_num_t rw);
+
+void lcdCtorBus(lcd_t *lcd, const lcd_bus_t *bus, void *handle, bool readable);
+
+lcd_err_t lcdCtorDMA(lcd_t *lcd, const lcd_dma_config_t *config);
+
+lcd_err_t lcdCtorI2C(lcd_t *lcd, const lcd_i2c_config_t *config);
+
+lcd_err_t lcdCtorSPI(lcd_t *lcd, const lcd_spi_config_t *config);
+
+lcd_err_t lcdBegin(lcd_t *const lcd);
+
+lcd_err_t lcdCommit(lcd_t *const lcd);
+
+lcd_err_t lcdSetText(lcd_t *const lcd, const char *text, int x, int y);
+
+lcd_err_t lcdWrite(lcd_t *const lcd, const char *buf, size_t len, int x, int y);
+
+lcd_err_t lcdWriteSpans(lcd_t *const lcd, const lcd_span_t *spans, size_t count);
+
+lcd_err_t lcdPlay(lcd_t *const lcd, const uint8_t *stream, size_t size);
+
+lcd_err_t lcdSetInt(lcd_t *const lcd, int val, int x, int y);
+
+lcd_err_t lcdClear(lcd_t *const lcd);
+
+lcd_err_t lcdSetGlyph(lcd_t *const lcd, int slot, const uint8_t bitmap[LCD_GLYPH_ROWS]);
+
+lcd_err_t lcdSetCharset(lcd_t *const lcd, lcd_charset_t charset);
+
+lcd_err_t lcdScrub(lcd_t *const lcd, int cells, int *repaired);
+
+lcd_err_t lcdCheck(lcd_t *const lcd);
+
+lcd_err_t lcdResync(lcd_t *const lcd);
+
+lcd_err_t lcdCalibrate(lcd_t *const lcd, lcd_timing_t *timing);
+
+lcd_err_t lcdGetStats(lcd_t *const lcd, lcd_stats_t *stats);
+
+lcd_err_t lcdSnapshot(lcd_t *const lcd, lcd_snapshot_t *snap);
+
+void lcdResetStats(lcd_t *const lcd);
+
+lcd_err_t lcdRegionOpen(lcd_t *const lcd, int x, int y, int width, int height, int z, lcd_region_t *region);
+
+lcd_err_t lcdRegionSetText(lcd_t *const lcd, lcd_region_t region, const char *text, int x, int y);
+
+lcd_err_t lcdRegionSetInt(lcd_t *const lcd, lcd_region_t region, int val, int x, int y);
+
+lcd_err_t lcdRegionClear(lcd_t *const lcd, lcd_region_t region);
+
+lcd_err_t lcdRegionShow(lcd_t *const lcd, lcd_region_t region, bool visible);
+
+lcd_err_t lcdRegionSetLane(lcd_t *const lcd, lcd_region_t region, int lane);
+
+lcd_err_t lcdRegionClose(lcd_t *const lcd, lcd_region_t region);
+
+lcd_err_t lcdRenderStart(lcd_t *const lcd, UBaseType_t priority);
+
+lcd_err_t lcdRenderStartPinned(lcd_t *const lcd, UBaseType_t priority, BaseType_t core);
+
+lcd_err_t lcdRenderStop(lcd_t *const lcd);
+
+lcd_err_t lcdRenderSetPeriod(lcd_t *const lcd, uint32_t periodMs);
+
+lcd_err_t lcdRingOpen(lcd_t *const lcd, lcd_ring_t *ring, int lane);
+
+lcd_err_t lcdRingPost(lcd_ring_t *ring, const char *text, int x, int y);
+
+lcd_err_t lcdRingClose(lcd_ring_t *ring);
+
+lcd_err_t lcdTermOpen(lcd_t *const lcd, lcd_term_t *term, const char *path);
+
+lcd_err_t lcdTermWrite(lcd_term_t *term, const char *buf, size_t len);
+
+lcd_err_t lcdTermClose(lcd_term_t *term);
+
+lcd_err_t lcdAnimOpen(lcd_t *const lcd, lcd_anim_t *anim, uint32_t tickMs, uint32_t budgetUs);
+
+lcd_err_t lcdAnimStart(lcd_t *const lcd, int slot, const uint8_t (*frames)[LCD_GLYPH_ROWS], int count, uint32_t frameMs);
+
+lcd_err_t lcdAnimStop(lcd_t *const lcd, int slot);
+
+lcd_err_t lcdAnimClose(lcd_t *const lcd);
+
+lcd_err_t lcdUiInit(lcd_ui_t *ui, lcd_t *const lcd);
+
+lcd_err_t lcdUiLabel(lcd_ui_t *ui, lcd_widget_t *widget, int x, int y, int width, const char *text);
+
+lcd_err_t lcdUiNumber(lcd_ui_t *ui, lcd_widget_t *widget, int x, int y, int width, int32_t min, int32_t max, const char *unit);
+
+lcd_err_t lcdUiList(lcd_ui_t *ui, lcd_widget_t *widget, int x, int y, int width, int rows, const char *const *items, int count);
+
+lcd_err_t lcdUiSetText(lcd_ui_t *ui, lcd_widget_t *widget, const char *text);
+
+lcd_err_t lcdUiSetValue(lcd_ui_t *ui, lcd_widget_t *widget, int32_t value);
+
+lcd_err_t lcdUiSetHook(lcd_ui_t *ui, lcd_widget_t *widget, lcd_ui_hook_t hook, void *arg);
+
+lcd_err_t lcdUiFocus(lcd_ui_t *ui, lcd_widget_t *widget);
+
+lcd_err_t lcdUiInput(lcd_ui_t *ui, lcd_ui_key_t key);
+
+lcd_err_t lcdUiRotate(lcd_ui_t *ui, int steps);
+
+lcd_err_t lcdUiRender(lcd_ui_t *ui);
+
+lcd_err_t lcdUiShow(lcd_ui_t *ui);
+
+lcd_err_t lcdLogOpen(lcd_t *const lcd, const lcd_log_config_t *config);
+
+lcd_err_t lcdLogClose(lcd_t *const lcd);
+
+lcd_err_t lcdTraceStart(lcd_t *const lcd, lcd_trace_t *trace);
+
+lcd_err_t lcdTraceStop(lcd_t *const lcd);
+
+lcd_err_t lcdTraceVcd(const lcd_trace_t *trace, FILE *out);
+
+lcd_err_t lcdRecordStart(lcd_t *const lcd, lcd_record_t *rec, uint8_t *buf, size_t size);
+
+lcd_err_t lcdRecordStop(lcd_t *const lcd);
+
+lcd_err_t lcdBacklightOpen(lcd_t *const lcd, lcd_backlight_t *bl, const lcd_backlight_config_t *config);
+
+lcd_err_t lcdBacklightOpenPwm(lcd_t *const lcd, lcd_backlight_t *bl, const lcd_backlight_config_t *config, const lcd_pwm_t *pwm);
+
+lcd_err_t lcdBacklightSet(lcd_t *const lcd, uint8_t level);
+
+lcd_err_t lcdBacklightWake(lcd_t *const lcd);
+
+lcd_err_t lcdBacklightClose(lcd_t *const lcd);
+
+lcd_err_t lcdFree(lcd_t * const lcd);
+
+lcd_t *lcdPoolTake(void);
+
+lcd_err_t lcdPoolGive(lcd_t *const lcd);
+
+void assert_lcd(lcd_err_t lcd_error);
+
+void lcdBusWait(lcd_t *const lcd, uint32_t us);
+
+uint32_t lcdUtf8Decode(const char **text, const char *end);
+
+uint8_t lcdCharsetMap(lcd_charset_t charset, uint32_t code);
+
+const uint8_t *lcdCharsetGlyph(uint32_t code);
+
+uint8_t lcdWaveMap(const lcd_wave_t *wave, uint8_t lines);
+
+size_t lcdWaveEncode(const lcd_wave_t *wave, uint8_t lines, uint32_t wait, uint8_t *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,494 @@
+/**
+ * @file esp_lcd_term.c
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Liquid Crystal Display terminal source file
+ * @version 0.1
+ * @date 2022-08-15
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <string.h>
+#include <sys/stat.h>
+#include "esp_lcd.h"
+#include "esp_vfs.h"
+
+/* Escape sequence parser states */
+#define LCD_TERM_TEXT   0   /*!< Plain text */
+#define LCD_TERM_ESC    1   /*!< After ESC */
+#define LCD_TERM_CSI    2   /*!< After ESC [ */
+
+#define LCD_TERM_BLANK  ' ' /*!< Erased cell */
+
+/**
+ * @brief Blank cells of a row
+ *
+ * @param term  terminal
+ * @param row   row
+ * @param from  first column
+ * @param to    last column, exclusive
+ * @return None
+ */
+static void lcdTermErase(lcd_term_t *term, int row, int from, int to)
+{
+    int col;
+    for (col = from; col < to; col++)
+    {
+        term->cells[row][col] = LCD_TERM_BLANK;
+    }
+}
+
+/**
+ * @brief Move to the start of the next line, scrolling at the bottom
+ *
+ * @param term  terminal
+ * @return None
+ */
+static void lcdTermNewline(lcd_term_t *term)
+{
+    term->col = 0;
+    if (term->row + 1 < LCD_ROWS)
+    {
+        term->row++;
+        return;
+    }
+    memmove(term->cells[0], term->cells[1], sizeof(term->cells) - sizeof(term->cells[0]));
+    lcdTermErase(term, LCD_ROWS - 1, 0, LCD_COLS);
+}
+
+/**
+ * @brief Place character at the cursor
+ *
+ * Wrapping is deferred until the next character, a line of exactly
+ * LCD_COLS characters followed by a newline does not leave a blank line.
+ * @param term  terminal
+ * @param code  code point, byte in LCD_CHARSET_RAW
+ * @return None
+ */
+static void lcdTermPut(lcd_term_t *term, uint32_t code)
+{
+    if (term->col >= LCD_COLS)
+    {
+        lcdTermNewline(term);
+    }
+    term->cells[term->row][term->col++] = code;
+}
+
+/**
+ * @brief Clamp value to a range
+ *
+ * @param val   value
+ * @param max   largest value
+ * @return      value in 0 - max
+ */
+static inline int lcdTermClamp(int val, int max)
+{
+    return val < 0 ? 0 : (val > max ? max : val);
+}
+
+/**
+ * @brief Run control sequence
+ *
+ * Cursor movement (A B C D H f), erase in display (J) and erase in
+ * line (K). Anything else, e.g. colours, is ignored.
+ * @param term  terminal
+ * @param final final byte
+ * @return None
+ */
+static void lcdTermCsi(lcd_term_t *term, uint8_t final)
+{
+    int p0 = term->nparams > 0 ? term->params[0] : 0;
+    int p1 = term->nparams > 1 ? term->params[1] : 0;
+    int n = p0 > 0 ? p0 : 1;
+    int col = term->col < LCD_COLS ? term->col : LCD_COLS - 1;
+    int row;
+
+    switch (final)
+    {
+    case 'A':
+        term->row = lcdTermClamp(term->row - n, LCD_ROWS - 1);
+        term->col = col;
+        break;
+    case 'B':
+        term->row = lcdTermClamp(term->row + n, LCD_ROWS - 1);
+        term->col = col;
+        break;
+    case 'C':
+        term->col = lcdTermClamp(col + n, LCD_COLS - 1);
+        break;
+    case 'D':
+        term->col = lcdTermClamp(col - n, LCD_COLS - 1);
+        break;
+    case 'H':
+    case 'f':
+        /* Parameters are 1 based, 0 or missing means 1 */
+        term->row = lcdTermClamp(p0 - 1, LCD_ROWS - 1);
+        term->col = lcdTermClamp(p1 - 1, LCD_COLS - 1);
+        break;
+    case 'J':
+        for (row = 0; row < LCD_ROWS; row++)
+        {
+            if ((p0 == 0 && row > term->row) || (p0 == 1 && row < term->row) || p0 == 2)
+            {
+                lcdTermErase(term, row, 0, LCD_COLS);
+            }
+        }
+        /* Cursor row as in erase in line */
+        if (p0 == 2)
+        {
+            break;
+        }
+        /* fall through */
+    case 'K':
+        if (p0 == 0)
+        {
+            lcdTermErase(term, term->row, col, LCD_COLS);
+        }
+        else if (p0 == 1)
+        {
+            lcdTermErase(term, term->row, 0, col + 1);
+        }
+        else if (p0 == 2)
+        {
+            lcdTermErase(term, term->row, 0, LCD_COLS);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Feed byte of an escape sequence
+ *
+ * @param term  terminal
+ * @param ch    byte
+ * @return None
+ */
+static void lcdTermEscape(lcd_term_t *term, uint8_t ch)
+{
+    if (term->state == LCD_TERM_ESC)
+    {
+        term->state = LCD_TERM_TEXT;
+        if (ch == '[')
+        {
+            memset(term->params, 0, sizeof(term->params));
+            term->nparams = 0;
+            term->state = LCD_TERM_CSI;
+        }
+        else if (ch == 'c')
+        {
+            /* Reset, blank screen and home */
+            for (int row = 0; row < LCD_ROWS; row++)
+            {
+                lcdTermErase(term, row, 0, LCD_COLS);
+            }
+            term->row = 0;
+            term->col = 0;
+        }
+        return;
+    }
+
+    /* Control sequence parameters, values saturate at 255 */
+    if (ch >= '0' && ch <= '9')
+    {
+        if (term->nparams == 0)
+        {
+            term->nparams = 1;
+        }
+        if (term->nparams <= LCD_TERM_PARAMS)
+        {
+            int val = term->params[term->nparams - 1] * 10 + (ch - '0');
+            term->params[term->nparams - 1] = val > 255 ? 255 : val;
+        }
+    }
+    else if (ch == ';')
+    {
+        term->nparams = (term->nparams == 0 ? 1 : term->nparams) + 1;
+    }
+    else if (ch >= 0x40 && ch <= 0x7E)
+    {
+        lcdTermCsi(term, ch);
+        term->state = LCD_TERM_TEXT;
+    }
+}
+
+/**
+ * @brief Feed byte of text
+ *
+ * Control characters move the cursor, other bytes are decoded as in
+ * the LCD text encoding. UTF-8 sequences may span writes.
+ * @param term  terminal
+ * @param ch    byte
+ * @return None
+ */
+static void lcdTermText(lcd_term_t *term, uint8_t ch)
+{
+    const char *p;
+    uint8_t need;
+
+    /* Partial UTF-8 sequence */
+    if (term->utf8Len > 0)
+    {
+        if ((ch & 0xC0) == 0x80)
+        {
+            term->utf8[term->utf8Len++] = ch;
+            need = term->utf8[0] >= 0xF0 ? 4 : (term->utf8[0] >= 0xE0 ? 3 : 2);
+            if (term->utf8Len == need)
+            {
+                p = (const char *)term->utf8;
+                lcdTermPut(term, lcdUtf8Decode(&p, p + need));
+                term->utf8Len = 0;
+            }
+            return;
+        }
+        /* Cut short */
+        lcdTermPut(term, LCD_UTF8_INVALID);
+        term->utf8Len = 0;
+    }
+
+    switch (ch)
+    {
+    case '\n':
+        lcdTermNewline(term);
+        break;
+    case '\r':
+        term->col = 0;
+        break;
+    case '\b':
+        term->col = term->col > 0 ? lcdTermClamp(term->col - 1, LCD_COLS - 1) : 0;
+        break;
+    case '\t':
+        term->col = lcdTermClamp((term->col / LCD_TERM_TAB + 1) * LCD_TERM_TAB, LCD_COLS - 1);
+        break;
+    case 0x1B:
+        term->state = LCD_TERM_ESC;
+        break;
+    default:
+        if (ch < 0x20 || ch == 0x7F)
+        {
+            /* Other control characters */
+        }
+        else if (ch < 0x80 || term->lcd->charset == LCD_CHARSET_RAW)
+        {
+            lcdTermPut(term, ch);
+        }
+        else if (ch >= 0xC0 && ch < 0xF8)
+        {
+            term->utf8[0] = ch;
+            term->utf8Len = 1;
+        }
+        else
+        {
+            lcdTermPut(term, LCD_UTF8_INVALID);
+        }
+        break;
+    }
+}
+
+/**
+ * @brief Encode cell for the LCD text encoding
+ *
+ * @param code      code point, byte in LCD_CHARSET_RAW
+ * @param raw       LCD_CHARSET_RAW
+ * @param out       at least 4 bytes
+ * @return          bytes written
+ */
+static size_t lcdTermEncode(uint32_t code, bool raw, char *out)
+{
+    if (raw || code < 0x80)
+    {
+        out[0] = code;
+        return 1;
+    }
+    if (code < 0x800)
+    {
+        out[0] = 0xC0 | (code >> 6);
+        out[1] = 0x80 | (code & 0x3F);
+        return 2;
+    }
+    if (code < 0x10000)
+    {
+        out[0] = 0xE0 | (code >> 12);
+        out[1] = 0x80 | ((code >> 6) & 0x3F);
+        out[2] = 0x80 | (code & 0x3F);
+        return 3;
+    }
+    out[0] = 0xF0 | (code >> 18);
+    out[1] = 0x80 | ((code >> 12) & 0x3F);
+    out[2] = 0x80 | ((code >> 6) & 0x3F);
+    out[3] = 0x80 | (code & 0x3F);
+    return 4;
+}
+
+/**
+ * @brief Place terminal model on the shadow screen
+ *
+ * Both rows go out as one batch of spans, the driver only writes the
+ * cells that changed.
+ * @param term  terminal
+ * @return      lcd error status @see lcd_err_t
+ */
+static lcd_err_t lcdTermRender(lcd_term_t *term)
+{
+    char text[LCD_ROWS][LCD_COLS * 4];
+    lcd_span_t spans[LCD_ROWS];
+    bool raw = term->lcd->charset == LCD_CHARSET_RAW;
+    int row, col;
+
+    for (row = 0; row < LCD_ROWS; row++)
+    {
+        spans[row].buf = text[row];
+        spans[row].len = 0;
+        spans[row].x = 0;
+        spans[row].y = row;
+        for (col = 0; col < LCD_COLS; col++)
+        {
+            spans[row].len += lcdTermEncode(term->cells[row][col], raw, text[row] + spans[row].len);
+        }
+    }
+    return lcdWriteSpans(term->lcd, spans, LCD_ROWS);
+}
+
+/**
+ * @brief Write to terminal
+ *
+ * Understands newline, carriage return, backspace, tab and the ANSI
+ * sequences for cursor position (ESC [ row ; col H), cursor movement,
+ * erase in display (ESC [ J) and erase in line (ESC [ K). The bottom
+ * line scrolls up on newline.
+ * @param term  terminal
+ * @param buf   text
+ * @param len   text length in bytes
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdTermWrite(lcd_term_t *term, const char *buf, size_t len)
+{
+    lcd_t *const lcd = term->lcd;
+    size_t i;
+
+    /* Serialize writers, one burst per write */
+    if (lcd == NULL || lcdBegin(lcd) != LCD_OK)
+    {
+        return LCD_FAIL;
+    }
+    for (i = 0; i < len; i++)
+    {
+        if (term->state == LCD_TERM_TEXT)
+        {
+            lcdTermText(term, (uint8_t)buf[i]);
+        }
+        else
+        {
+            lcdTermEscape(term, (uint8_t)buf[i]);
+        }
+    }
+    lcdTermRender(term);
+    return lcdCommit(lcd);
+}
+
+/**
+ * @brief VFS open, every open shares the terminal
+ */
+static int lcdTermVfsOpen(void *ctx, const char *path, int flags, int mode)
+{
+    return 0;
+}
+
+/**
+ * @brief VFS write
+ */
+static ssize_t lcdTermVfsWrite(void *ctx, int fd, const void *data, size_t size)
+{
+    return lcdTermWrite((lcd_term_t *)ctx, (const char *)data, size) == LCD_OK ? (ssize_t)size : -1;
+}
+
+/**
+ * @brief VFS close
+ */
+static int lcdTermVfsClose(void *ctx, int fd)
+{
+    return 0;
+}
+
+/**
+ * @brief VFS stat, a character device so stdio line buffers it
+ */
+static int lcdTermVfsFstat(void *ctx, int fd, struct stat *st)
+{
+    memset(st, 0, sizeof(struct stat));
+    st->st_mode = S_IFCHR;
+    return 0;
+}
+
+/**
+ * @brief Open terminal
+ *
+ * Starts blank with the cursor home. With a path the terminal is also
+ * a VFS device, e.g. freopen("/dev/lcd", "w", stdout) sends console
+ * output to the LCD.
+ * @param lcd   pointer to LCD object
+ * @param term  terminal storage, owned by the caller until lcdTermClose
+ * @param path  VFS path, e.g. "/dev/lcd", NULL for lcdTermWrite only
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdTermOpen(lcd_t *const lcd, lcd_term_t *term, const char *path)
+{
+    int row;
+
+    memset(term, 0, sizeof(lcd_term_t));
+    term->lcd = lcd;
+    for (row = 0; row < LCD_ROWS; row++)
+    {
+        lcdTermErase(term, row, 0, LCD_COLS);
+    }
+
+    if (path != NULL)
+    {
+        esp_vfs_t vfs = {
+            .flags = ESP_VFS_FLAG_CONTEXT_PTR,
+            .open_p = lcdTermVfsOpen,
+            .write_p = lcdTermVfsWrite,
+            .close_p = lcdTermVfsClose,
+            .fstat_p = lcdTermVfsFstat,
+        };
+        if (strlen(path) >= sizeof(term->path) || esp_vfs_register(path, &vfs, term) != ESP_OK)
+        {
+            term->lcd = NULL;
+            return LCD_FAIL;
+        }
+        strcpy(term->path, path);
+    }
+
+    /* Blank screen, no clear command */
+    if (lcdBegin(lcd) != LCD_OK)
+    {
+        lcdTermClose(term);
+        return LCD_FAIL;
+    }
+    lcdTermRender(term);
+    return lcdCommit(lcd);
+}
+
+/**
+ * @brief Close terminal
+ *
+ * Unregisters the VFS device, the screen keeps its contents.
+ * @param term  terminal
+ * @return      lcd error status @see lcd_err_t
+ */
+lcd_err_t lcdTermClose(lcd_term_t *term)
+{
+    if (term->lcd == NULL)
+    {
+        return LCD_FAIL;
+    }
+    if (term->path[0] != '\0')
+    {
+        esp_vfs_unregister(term->path);
+        term->path[0] = '\0';
+    }
+    term->lcd = NULL;
+    return LCD_OK;
+}
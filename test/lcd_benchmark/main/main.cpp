@@ -0,0 +1,104 @@
+/**
+ * @file main.cpp
+ * @author Jesus Minjares (https://github.com/jminjares4)
+ * @brief Benchmark C driver against the C++ template driver
+ * @version 0.1
+ * @date 2022-10-10
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include "driver/esp_lcd.h"
+#include "driver/esp_lcd.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+/* LCD tag */
+static const char *lcd_tag = "LCD tag";
+
+/* Frames per run */
+#define FRAMES 100
+
+/* Default pinout, specialized at compile time */
+typedef hd44780::GpioBus<19, 18, 17, 16, 23, 22> lcd_bus;
+
+/* Every cell differs between the two frames */
+static const char *frame[2] = {"0123456789ABCDEF", "FEDCBA9876543210"};
+
+/**
+ * @brief Write FRAMES full screens through the C driver
+ *
+ * @param lcd   pointer to LCD object
+ * @return      CPU cycles
+ */
+static uint32_t benchC(lcd_t *lcd)
+{
+  uint32_t start = hd44780::cycles();
+  for (int i = 0; i < FRAMES; i++)
+  {
+    lcdWrite(lcd, frame[i & 1], LCD_COLS, 0, 0);
+    lcdWrite(lcd, frame[~i & 1], LCD_COLS, 0, 1);
+  }
+  return hd44780::cycles() - start;
+}
+
+/**
+ * @brief Write FRAMES full screens through the C++ template driver
+ *
+ * @param lcd   template LCD
+ * @return      CPU cycles
+ */
+template <class Lcd>
+static uint32_t benchCpp(Lcd &lcd)
+{
+  uint32_t start = hd44780::cycles();
+  for (int i = 0; i < FRAMES; i++)
+  {
+    lcd.write(frame[i & 1], LCD_COLS, 0, 0);
+    lcd.write(frame[~i & 1], LCD_COLS, 0, 1);
+  }
+  return hd44780::cycles() - start;
+}
+
+void lcd_task(void *pvParameters)
+{
+  /* C driver, GPIO bus */
+  lcd_t lcd;
+  lcdDefault(&lcd);
+  lcdInit(&lcd);
+
+  /* Datasheet timing, the LCD wait dominates */
+  uint32_t c = benchC(&lcd);
+
+  /* No command wait, bus overhead only. The LCD may drop characters */
+  lcd.timing.cmdUs = 0;
+  uint32_t cBus = benchC(&lcd);
+  lcdFree(&lcd);
+
+  /* C++ template driver, same pins and timing */
+  hd44780::Lcd<lcd_bus> lcdpp;
+  lcdpp.init();
+  uint32_t cpp = benchCpp(lcdpp);
+
+  hd44780::Lcd<lcd_bus, hd44780::Geometry<>, hd44780::Timing<500, 0>> lcdBus;
+  uint32_t cppBus = benchCpp(lcdBus);
+
+  ESP_LOGI(lcd_tag, "C:   %lu cycles/frame, bus only %lu", (unsigned long)(c / FRAMES), (unsigned long)(cBus / FRAMES));
+  ESP_LOGI(lcd_tag, "C++: %lu cycles/frame, bus only %lu", (unsigned long)(cpp / FRAMES), (unsigned long)(cppBus / FRAMES));
+
+  /* Show result */
+  lcdpp.init();
+  lcdpp.setText("C bus   C++ bus", 0, 0);
+  lcdpp.setInt(cBus / FRAMES, 0, 1);
+  lcdpp.setInt(cppBus / FRAMES, 8, 1);
+
+  vTaskDelete(NULL);
+}
+
+extern "C" void app_main(void)
+{
+  /* Create LCD task */
+  xTaskCreate(lcd_task, "LCD task", 4096, NULL, 4, NULL);
+}
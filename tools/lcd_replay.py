@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""Replay an API call record and report the LCD bus cost.
+
+The record is written on the device by lcdRecordStart(), copy rec.buf
+up to rec.len into a file, e.g. from a console hex dump or a partition.
+The calls are replayed through the driver itself, built for the host
+from test/host against a bus backend that counts the bytes written and
+their bus time. Region calls and ring posts are replayed too.
+
+Usage:
+
+    python tools/lcd_replay.py workload.lcdr [-v]
+    python tools/lcd_replay.py before.lcdr after.lcdr
+
+Timing comes from the record header, so the report matches the bus
+timing of the device. The host build needs cmake and a C compiler, it
+is kept in build/lcd_replay unless --build-dir says otherwise. Compare
+driver versions by replaying the same record on each checkout.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HOST_DIR = os.path.join(ROOT, 'test', 'host')
+
+
+def build(build_dir):
+    """Configure once, then bring lcd_replay up to date with the driver."""
+    if not os.path.exists(os.path.join(build_dir, 'CMakeCache.txt')):
+        subprocess.run(['cmake', '-S', HOST_DIR, '-B', build_dir],
+                       check=True, stdout=subprocess.DEVNULL)
+    subprocess.run(['cmake', '--build', build_dir, '--target', 'lcd_replay'],
+                   check=True, stdout=subprocess.DEVNULL)
+    return os.path.join(build_dir, 'lcd_replay')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('records', nargs='+', help='call records written by lcdRecordStart')
+    parser.add_argument('-v', '--verbose', action='store_true', help='print every call')
+    parser.add_argument('--build-dir', default=os.path.join(ROOT, 'build', 'lcd_replay'),
+                        help='host build of the driver')
+    args = parser.parse_args()
+
+    try:
+        replay = build(os.path.abspath(args.build_dir))
+    except (OSError, subprocess.CalledProcessError) as err:
+        sys.exit('host build failed: %s' % err)
+    cmd = [replay] + args.records + (['-v'] if args.verbose else [])
+    sys.exit(subprocess.run(cmd).returncode)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+"""Compile a static LCD screen into a command stream for lcdPlay().
+
+Screen description, one statement per line, '#' starts a comment:
+
+    clear                       clear LCD
+    text X Y "string"           text at column X, row Y, C escapes allowed
+    glyph SLOT R0 R1 ... R7     custom glyph, rows as 0x.. or 0b.. or decimal
+
+Usage:
+
+    python tools/lcd_screen.py splash.screen -o main/splash.h [-n splash] [-c a02]
+
+The header holds one `static const uint8_t` array placed in flash.
+
+Text characters are mapped to the character ROM like lcdSetCharset
+does, from the tables in driver/esp_lcd_charset.c. A character the ROM
+lacks is an error, e.g. '~' on A00. Escapes such as \\xDF or \\1 give
+character codes as is, for ROM only glyphs and custom glyph slots.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+LCD_DDRAM_LINE = 40
+LCD_GLYPHS = 8
+LCD_GLYPH_ROWS = 8
+LCD_PLAY_CLEAR = 0x01
+
+CHARSET_SOURCE = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))),
+                              'driver', 'esp_lcd_charset.c')
+CHARSETS = ('a00', 'a02', 'raw')
+
+ESCAPES = {'a': 0x07, 'b': 0x08, 'f': 0x0C, 'n': 0x0A, 'r': 0x0D, 't': 0x09, 'v': 0x0B,
+           '\\': 0x5C, '"': 0x22, "'": 0x27, '?': 0x3F}
+
+
+class ScreenError(Exception):
+    """Bad screen description."""
+
+
+def lcd_play_at(x, y):
+    """LCD_PLAY_AT in esp_lcd.h"""
+    return 0x80 | ((0x40 if y & 1 else 0x00) + x)
+
+
+def lcd_play_glyph(slot):
+    """LCD_PLAY_GLYPH in esp_lcd.h"""
+    return 0x40 | (slot << 3)
+
+
+def c_value(token):
+    """Value of a C integer or plain character constant."""
+    char = re.match(r"'(.)'$", token)
+    return ord(char.group(1)) if char else int(token, 0)
+
+
+def initializer(body):
+    """Entries of a C array initializer, designators and runs after them."""
+    entries, index = {}, 0
+    for item in body.split(','):
+        item = item.strip()
+        if not item:
+            continue
+        designator = re.match(r'\[(\w+)\]\s*=\s*(.+)', item, re.S)
+        if designator:
+            index, item = int(designator.group(1), 0), designator.group(2)
+        entries[index] = item.strip()
+        index += 1
+    return entries
+
+
+def load_charset(charset, source=CHARSET_SOURCE):
+    """Code point to ROM code map of lcdCharsetMap, from the driver tables."""
+    if charset == 'raw':
+        return None
+    with open(source, encoding='utf-8') as f:
+        code = re.sub(r'/\*.*?\*/', '', f.read(), flags=re.S)
+    arrays = dict(re.findall(r'static const uint8_t \*?\s*(?:const )?(lcd_%s_\w+)\[256\] = \{(.*?)\};' % charset,
+                             code, re.S))
+    index = arrays.get('lcd_%s_pages' % charset)
+    if index is None:
+        raise ScreenError('%s: no %s tables' % (source, charset.upper()))
+    table = {}
+    for high, page in initializer(index).items():
+        for low, rom in initializer(arrays[page]).items():
+            if c_value(rom):
+                table[high << 8 | low] = c_value(rom)
+    return table
+
+
+def rom_code(ch, charset, table):
+    """lcdCharsetMap in esp_lcd_charset.c, None when the ROM has no glyph."""
+    code = ord(ch)
+    if code < 0x80:
+        return None if charset == 'a00' and ch in '\\~' else code
+    if table is None:
+        # Raw bytes, one ROM per display, spell them as escapes
+        return None
+    return table.get(code)
+
+
+def parse_string(line, pos):
+    """Parse a quoted string starting after its opening quote.
+
+    Returns the items, characters as str and escapes as int codes, and
+    the position after the closing quote.
+    """
+    items = []
+    while pos < len(line):
+        ch = line[pos]
+        pos += 1
+        if ch == '"':
+            return items, pos
+        if ch != '\\':
+            items.append(ch)
+            continue
+        if pos >= len(line):
+            break
+        ch = line[pos]
+        if ch == 'x':
+            digits = re.match(r'[0-9A-Fa-f]{1,2}', line[pos + 1:])
+            if digits is None:
+                raise ScreenError('\\x without hex digits')
+            items.append(int(digits.group(0), 16))
+            pos += 1 + len(digits.group(0))
+        elif ch in '01234567':
+            digits = re.match(r'[0-7]{1,3}', line[pos:]).group(0)
+            if int(digits, 8) > 0xFF:
+                raise ScreenError('escape \\%s out of range' % digits)
+            items.append(int(digits, 8))
+            pos += len(digits)
+        elif ch in ESCAPES:
+            items.append(ESCAPES[ch])
+            pos += 1
+        else:
+            raise ScreenError('unknown escape \\%s' % ch)
+    raise ScreenError('unterminated string')
+
+
+def split_line(line):
+    """Split a statement into words, quoted strings as item lists."""
+    words, pos = [], 0
+    while pos < len(line):
+        ch = line[pos]
+        if ch.isspace():
+            pos += 1
+        elif ch == '#':
+            break
+        elif ch == '"':
+            items, pos = parse_string(line, pos + 1)
+            words.append(items)
+        else:
+            end = pos
+            while end < len(line) and not line[end].isspace() and line[end] not in '"#':
+                end += 1
+            words.append(line[pos:end])
+            pos = end
+    return words
+
+
+def parse_text(items, charset, table):
+    """Character codes of a parsed string."""
+    codes = []
+    for item in items:
+        if isinstance(item, int):
+            codes.append(item)
+            continue
+        code = rom_code(item, charset, table)
+        if code is None:
+            raise ScreenError('%r (U+%04X) has no glyph on the %s ROM, use a glyph slot or a \\x escape'
+                              % (item, ord(item), charset.upper()))
+        codes.append(code)
+    return codes
+
+
+def compile_screen(lines, name, charset='a00'):
+    """Return the stream records of a screen description."""
+    table = load_charset(charset)
+    stream = []
+    for number, line in enumerate(lines, 1):
+        where = '%s:%d' % (name, number)
+        try:
+            words = split_line(line)
+            if not words:
+                continue
+            op, args = words[0], words[1:]
+            if op == 'clear' and not args:
+                stream.append([LCD_PLAY_CLEAR, 0])
+            elif op == 'text' and len(args) == 3 and isinstance(args[2], list):
+                x, y = int(args[0], 0), int(args[1], 0)
+                text = parse_text(args[2], charset, table)
+                if not 0 <= x < LCD_DDRAM_LINE or not 0 <= y < 2 or len(text) > 255:
+                    raise ScreenError('text out of range')
+                stream.append([lcd_play_at(x, y), len(text)] + text)
+            elif op == 'glyph' and len(args) == 1 + LCD_GLYPH_ROWS and all(isinstance(a, str) for a in args):
+                slot = int(args[0], 0)
+                rows = [int(row, 0) & 0x1F for row in args[1:]]
+                if not 0 <= slot < LCD_GLYPHS:
+                    raise ScreenError('glyph slot out of range')
+                stream.append([lcd_play_glyph(slot), LCD_GLYPH_ROWS] + rows)
+            else:
+                raise ScreenError('bad statement "%s"' % line.strip())
+        except (ScreenError, ValueError) as err:
+            sys.exit('%s: %s' % (where, err))
+    return stream
+
+
+def emit(stream, name, source):
+    """Format the stream as a C header."""
+    out = ['/* Generated by tools/lcd_screen.py from %s, do not edit */' % source,
+           '#include <stdint.h>',
+           '',
+           'static const uint8_t %s[] = {' % name]
+    for record in stream:
+        out.append('    ' + ', '.join('0x%02X' % b for b in record) + ',')
+    out.append('};')
+    return '\n'.join(out) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('screen', help='screen description')
+    parser.add_argument('-o', '--output', required=True, help='generated C header')
+    parser.add_argument('-n', '--name', help='array name, defaults to the screen file name')
+    parser.add_argument('-c', '--charset', choices=CHARSETS, default='a00',
+                        help='character ROM of the display, raw takes ASCII and escapes only')
+    args = parser.parse_args()
+
+    source = os.path.basename(args.screen)
+    name = args.name or os.path.splitext(source)[0]
+    with open(args.screen, encoding='utf-8') as f:
+        stream = compile_screen(f.readlines(), source, args.charset)
+    with open(args.output, 'w') as f:
+        f.write(emit(stream, name, source))
+
+
+if __name__ == '__main__':
+    main()